@@ -0,0 +1,79 @@
+// Allocator policies under the same random alloc/free workload: throughput
+// plus fragmentation of the heap left behind.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Logger.hpp"
+#include "../include/MemoryManager.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Live {
+    void* ptr;
+    size_t size;
+};
+
+// Mostly small objects, some medium, a few large ones
+static size_t pickSize(std::mt19937_64& rng) {
+    int kind = rng() % 100;
+    if (kind < 70) return 16 + rng() % 241;
+    if (kind < 95) return 256 + rng() % 3841;
+    return 4096 + rng() % 61441;
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    const size_t capacity = 32 << 20;
+    const size_t liveTarget = 4000;
+    const size_t operations = 100000;
+    const AllocPolicy policies[] = {AllocPolicy::FirstFit, AllocPolicy::Segregated, AllocPolicy::Buddy};
+
+    std::printf("%-12s %-10s %-8s %-10s %-10s %s\n", "policy", "ns/op", "failed", "internal",
+                "external", "blocks");
+    for (AllocPolicy policy : policies) {
+        MemoryManager mm(policy, capacity);
+        std::mt19937_64 rng(11);
+        std::vector<Live> live;
+        size_t failed = 0;
+
+        auto allocOne = [&]() {
+            size_t size = pickSize(rng);
+            void* ptr = mm.allocate(size);
+            if (ptr == nullptr) {
+                failed++;
+            } else {
+                live.push_back({ptr, size});
+            }
+        };
+        while (live.size() < liveTarget) {
+            allocOne();
+        }
+
+        // Steady state: free a random live block, allocate a new one
+        auto start = Clock::now();
+        for (size_t i = 0; i < operations; ++i) {
+            size_t victim = rng() % live.size();
+            mm.deallocate(live[victim].ptr);
+            live[victim] = live.back();
+            live.pop_back();
+            allocOne();
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+                    (2 * operations);
+
+        size_t requested = 0;
+        for (const Live& l : live) {
+            requested += l.size;
+        }
+        MemoryStats stats = mm.getStats();
+        // Internal: rounding waste inside used blocks. External: free space
+        // that cannot be handed out as one block.
+        double internal = stats.usedBytes ? 1.0 - double(requested) / stats.usedBytes : 0.0;
+        double external = stats.freeBytes ? 1.0 - double(stats.largestFree) / stats.freeBytes : 0.0;
+        std::printf("%-12s %-10.1f %-8zu %-10.3f %-10.3f %zu\n", MemoryManager::policyName(policy),
+                    ns, failed, internal, external, stats.usedBlocks + stats.freeBlocks);
+    }
+    return 0;
+}
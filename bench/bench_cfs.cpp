@@ -0,0 +1,138 @@
+// The fair scheduling class against strict priority.
+//
+// Scaling: pick the next thread and put it back after a slice, as yield()
+// does, with 16 to 1M ready threads. The priority class is O(1) via its
+// bitmap; the fair class is O(log n) in its red-black tree.
+//
+// Fairness: CPU-bound threads at two priorities and a spread of nice values,
+// plus an interactive thread that wakes every few ticks for one tick of work,
+// stepped one tick at a time as in Kernel::runCpu. Strict priority gives the
+// HIGH threads everything; the fair class shares the CPU by weight and runs
+// the interactive thread soon after it wakes.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../include/Logger.hpp"
+#include "../include/Scheduler.hpp"
+
+static double measurePick(SchedPolicy policy, int threadCount, int iterations) {
+    Scheduler scheduler(DEFAULT_PRIORITY_LEVELS);
+    scheduler.setPolicy(policy);
+    std::vector<std::unique_ptr<Thread>> threads;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> prio(0, DEFAULT_PRIORITY_LEVELS - 1);
+    std::uniform_int_distribution<int> nice(-20, 19);
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(new Thread(i + 1, 1, "bench", prio(rng)));
+        threads.back()->setNice(nice(rng));
+        scheduler.addThread(threads.back().get());
+    }
+
+    const uint64_t slice = Scheduler::VRUNTIME_TICK * Scheduler::NICE_0_WEIGHT * DEFAULT_QUANTUM;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        Thread* next = scheduler.pickNext();
+        next->setVruntime(next->getVruntime() + slice / Scheduler::niceWeight(next->getNice()));
+        scheduler.addThread(next);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+struct Spec {
+    int priority;
+    int nice;
+};
+
+const Spec CPU_BOUND[] = {{0, 0}, {0, 5}, {1, -5}, {1, 0}, {1, 0}, {1, 5}, {1, 10}, {1, 19}};
+const int INTERACTIVE_PERIOD = 20;  // Ticks it sleeps between bursts
+
+static void measureFairness(SchedPolicy policy, uint64_t ticks) {
+    Scheduler scheduler(DEFAULT_PRIORITY_LEVELS);
+    scheduler.setPolicy(policy);
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (const Spec& spec : CPU_BOUND) {
+        threads.emplace_back(new Thread(static_cast<int>(threads.size()) + 1, 1, "cpu", spec.priority));
+        threads.back()->setNice(spec.nice);
+        scheduler.addThread(threads.back().get());
+    }
+    Thread* interactive = new Thread(static_cast<int>(threads.size()) + 1, 2, "interactive", 1);
+    threads.emplace_back(interactive);
+    scheduler.addThread(interactive);
+
+    uint64_t wakeAt = 0;  // Tick it last woke
+    bool waiting = false;  // Woken and not run since
+    WaitHistogram latency;
+    for (uint64_t tick = 1; tick <= ticks; ++tick) {
+        if (interactive->getState() == ThreadState::SLEEPING && tick >= interactive->getWakeTick()) {
+            scheduler.wakeup(interactive);
+            wakeAt = tick;
+            waiting = true;
+        }
+        scheduler.schedule();
+        Thread* current = scheduler.getCurrentThread();
+        if (current == nullptr) {
+            continue;
+        }
+        current->addRunTick();
+        if (current == interactive) {
+            if (waiting) {
+                latency.record(tick - wakeAt);
+                waiting = false;
+            }
+            interactive->setState(ThreadState::SLEEPING);
+            interactive->setWakeTick(tick + INTERACTIVE_PERIOD);
+        }
+    }
+
+    // Shares of the CPU-bound threads, against their weights
+    uint64_t run = 0;
+    double weights = 0, sum = 0, sumSquares = 0;
+    for (size_t i = 0; i + 1 < threads.size(); ++i) {
+        run += threads[i]->getRunTicks();
+        weights += Scheduler::niceWeight(threads[i]->getNice());
+    }
+    std::printf("%s:\n", Scheduler::policyName(policy));
+    std::printf("  %-5s %-9s %-6s %-10s %s\n", "TID", "priority", "nice", "share %", "expected %");
+    for (size_t i = 0; i + 1 < threads.size(); ++i) {
+        const Thread* t = threads[i].get();
+        double weight = Scheduler::niceWeight(t->getNice());
+        double x = t->getRunTicks() / weight;
+        sum += x;
+        sumSquares += x * x;
+        std::printf("  %-5d %-9s %-6d %-10.2f %.2f\n", t->getId(), priorityLabel(t->getPriority()).c_str(),
+                    t->getNice(), 100.0 * t->getRunTicks() / run, 100.0 * weight / weights);
+    }
+    int n = static_cast<int>(threads.size()) - 1;
+    const WaitHistogram& waits = scheduler.getWaits();
+    std::printf("  Jain fairness index (run/weight): %.3f\n", sum * sum / (n * sumSquares));
+    std::printf("  Ready waits: p50 %llu, p99 %llu, max %llu ticks\n", (unsigned long long)waits.percentile(50),
+                (unsigned long long)waits.percentile(99), (unsigned long long)waits.max());
+    if (latency.count() == 0) {
+        std::printf("  Interactive: never ran\n\n");
+    } else {
+        std::printf("  Interactive: %llu bursts, wake-to-run p50 %llu, p99 %llu, max %llu ticks\n\n",
+                    (unsigned long long)latency.count(), (unsigned long long)latency.percentile(50),
+                    (unsigned long long)latency.percentile(99), (unsigned long long)latency.max());
+    }
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    const int threadCounts[] = {16, 1000, 100000, 1000000};
+    const int iterations = 2000000;
+    std::printf("%-10s %-12s %s\n", "threads", "priority", "cfs (ns/pick+requeue)");
+    for (int threadCount : threadCounts) {
+        std::printf("%-10d %-12.1f %.1f\n", threadCount, measurePick(SchedPolicy::Priority, threadCount, iterations),
+                    measurePick(SchedPolicy::Fair, threadCount, iterations));
+    }
+    std::printf("\n");
+
+    measureFairness(SchedPolicy::Priority, 1000000);
+    measureFairness(SchedPolicy::Fair, 1000000);
+    return 0;
+}
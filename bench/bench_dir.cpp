@@ -0,0 +1,83 @@
+// Path lookup in a directory tree of 1M files (100 x 100 x 100 by default):
+// opening random paths right after mount, when each component costs one
+// directory bucket read and an inode table block, and again with the dentry
+// cache warm. Either way the cost follows the depth, not the file count.
+//
+// Usage: bench_dir [fanout]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/FileSystem.hpp"
+#include "../include/Logger.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double nanosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static std::string pathOf(size_t i, size_t j, size_t k) {
+    return "/d" + std::to_string(i) + "/d" + std::to_string(j) + "/f" + std::to_string(k);
+}
+
+int main(int argc, char* argv[]) {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    const char* diskPath = "/tmp/myos_bench_dir.bin";
+    const size_t fanout = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+    const size_t files = fanout * fanout * fanout;
+    const size_t dirs = fanout + fanout * fanout;
+    const size_t inodes = files + dirs + 1;
+    const size_t imageBytes = size_t(1) << 30;
+    const int lookups = 20000;
+    std::remove(diskPath);
+
+    auto start = Clock::now();
+    {
+        FileSystem fs(diskPath, imageBytes, inodes, true);
+        for (size_t i = 0; i < fanout; ++i) {
+            std::string top = "/d" + std::to_string(i);
+            fs.my_mkdir(top);
+            for (size_t j = 0; j < fanout; ++j) {
+                fs.my_mkdir(top + "/d" + std::to_string(j));
+                for (size_t k = 0; k < fanout; ++k) {
+                    fs.my_close(fs.my_open(pathOf(i, j, k)));
+                }
+            }
+        }
+    }
+    double buildSeconds = nanosSince(start) / 1e9;
+    std::printf("%zu files in %zu directories (fanout %zu, depth 3)\n", files, dirs, fanout);
+    std::printf("built and unmounted in %.1f s (%.0f creates/s)\n\n", buildSeconds, (files + dirs) / buildSeconds);
+
+    std::mt19937 rng(42);
+    std::vector<std::string> paths;
+    for (int n = 0; n < lookups; ++n) {
+        paths.push_back(pathOf(rng() % fanout, rng() % fanout, rng() % fanout));
+    }
+
+    start = Clock::now();
+    FileSystem fs(diskPath, imageBytes, inodes);
+    std::printf("mount: %.0f us\n", nanosSince(start) / 1000);
+    std::printf("%-26s %-12s %s\n", "open + close", "ns/open", "block reads/open");
+    for (bool warm : {false, true}) {
+        uint64_t misses = fs.getCacheStats().misses;
+        int failed = 0;
+        start = Clock::now();
+        for (const std::string& path : paths) {
+            int fd = fs.my_open(path);
+            failed += fd < 0;
+            fs.my_close(fd);
+        }
+        double ns = nanosSince(start) / lookups;
+        double reads = static_cast<double>(fs.getCacheStats().misses - misses) / lookups;
+        std::printf("%-26s %-12.0f %.2f%s\n", warm ? "warm (dentry cache)" : "cold (after mount)", ns, reads,
+                    failed ? " (missing paths!)" : "");
+    }
+
+    std::remove(diskPath);
+    return 0;
+}
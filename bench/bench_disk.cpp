@@ -0,0 +1,105 @@
+// Small-write throughput to the disk image: reopening it per call (the old
+// my_write path) vs. the write-back buffer cache, with and without a sync,
+// on an unjournaled and a journaled image. Then mount time of a large image
+// after a clean and an unclean shutdown.
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include "../include/FileSystem.hpp"
+#include "../include/Logger.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double nanosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    const char* diskPath = "/tmp/myos_bench_disk.bin";
+    const size_t writeSize = 16;
+    const size_t fileBytes = 4096;
+    const size_t writesPerFile = fileBytes / writeSize;
+    const int rounds = 200;
+    char data[writeSize] = "0123456789abcde";
+    std::remove(diskPath);
+
+    std::printf("%d rounds of %zu x %zu-byte writes\n", rounds, writesPerFile, writeSize);
+    std::printf("%-24s %s\n", "path", "ns/write");
+
+    // An fstream opened, seeked and closed around every write
+    {
+        std::ofstream(diskPath, std::ios::binary).write(std::string(fileBytes, '\0').data(), fileBytes);
+        auto start = Clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < writesPerFile; ++i) {
+                std::fstream disk(diskPath, std::ios::in | std::ios::out | std::ios::binary);
+                disk.seekp(i * writeSize);
+                disk.write(data, writeSize);
+                disk.close();
+            }
+        }
+        std::printf("%-24s %.1f\n", "reopen per write", nanosSince(start) / (rounds * writesPerFile));
+    }
+
+    // my_write through the cache, on a freshly formatted image each round;
+    // with the journal, the sync also commits the round's metadata
+    for (bool journaled : {false, true}) {
+        for (int syncEvery : {0, 1}) {
+            double ns = 0;
+            for (int r = 0; r < rounds; ++r) {
+                FileSystem fs(diskPath, FileSystem::DEFAULT_DISK_SIZE, FileSystem::DEFAULT_INODES, true, journaled);
+                int fd = fs.my_open("bench.dat");
+                auto start = Clock::now();
+                for (size_t i = 0; i < writesPerFile; ++i) {
+                    fs.my_write(fd, data, writeSize);
+                }
+                if (syncEvery) {
+                    fs.sync();
+                }
+                ns += nanosSince(start);
+            }
+            const char* name = journaled ? (syncEvery ? "journaled + sync" : "journaled")
+                                         : (syncEvery ? "buffer cache + sync" : "buffer cache");
+            std::printf("%-24s %.1f\n", name, ns / (rounds * writesPerFile));
+        }
+    }
+
+    // A 4 GB image with 64K inodes, 10000 of them in use
+    const size_t imageBytes = size_t(4) << 30;
+    const int files = 10000;
+    std::remove(diskPath);
+    {
+        FileSystem fs(diskPath, imageBytes, 1 << 16, true);
+        for (int i = 0; i < files; ++i) {
+            int fd = fs.my_open("file" + std::to_string(i));
+            fs.my_write(fd, data, writeSize);
+            fs.my_close(fd);
+        }
+    }
+    std::printf("\n%s image, %d files\n", "4 GB", files);
+    std::printf("%-24s %-12s %s\n", "mount", "mount us", "first lookup us");
+    for (bool crash : {false, true}) {
+        if (crash) {
+            // What an unmount that never happened leaves behind
+            SuperBlock super;
+            std::fstream image(diskPath, std::ios::in | std::ios::out | std::ios::binary);
+            image.read(reinterpret_cast<char*>(&super), sizeof(super));
+            super.clean = 0;
+            image.seekp(0);
+            image.write(reinterpret_cast<const char*>(&super), sizeof(super));
+        }
+        auto start = Clock::now();
+        FileSystem fs(diskPath, imageBytes, 1 << 16);
+        double mountUs = nanosSince(start) / 1000;
+        start = Clock::now();
+        bool found = fs.exists("file" + std::to_string(files - 1));
+        double lookupUs = nanosSince(start) / 1000;
+        std::printf("%-24s %-12.0f %.0f%s\n", crash ? "after crash (replay)" : "clean", mountUs, lookupUs,
+                    found ? "" : " (missing!)");
+    }
+
+    std::remove(diskPath);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// fork() cost against the parent's resident size: copy-on-write clone vs.
+// an eager copy of every resident page, plus the cost of a later COW break.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "../include/AddressSpace.hpp"
+#include "../include/FileSystem.hpp"
+#include "../include/Logger.hpp"
+#include "../include/MemoryManager.hpp"
+#include "../include/Pager.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static double microsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    const size_t virtualPages = 1 << 16;  // Same page table size at every resident size
+    const int reps = 20;
+    const char* diskPath = "/tmp/myos_bench_fork.bin";
+    MemoryManager memory(AllocPolicy::Segregated, 64 << 20);
+    FileSystem disk(diskPath);
+    Pager pager(memory, disk, PagerPolicy::Clock, 0);
+    int nextAsid = 1;
+
+    std::printf("%zu virtual pages of %zu bytes\n", virtualPages, PAGE_SIZE);
+    std::printf("%-10s %-12s %-12s %s\n", "resident", "cow us", "copy us", "cow break ns/page");
+    for (size_t resident = 0; resident <= virtualPages; resident = resident ? resident * 4 : 1024) {
+        AddressSpace parent(nextAsid++, pager, virtualPages);
+        size_t frame;
+        for (uint64_t vpn = 0; vpn < resident; ++vpn) {
+            parent.resolve(vpn, true, frame);
+        }
+
+        double cow = 0;
+        for (int r = 0; r < reps; ++r) {
+            auto start = Clock::now();
+            AddressSpace* child = parent.fork(nextAsid++);
+            cow += microsSince(start);
+            delete child;
+        }
+
+        // What fork cost before copy-on-write: a frame and a memcpy per resident page
+        double copy = 0;
+        for (int r = 0; r < reps; ++r) {
+            auto start = Clock::now();
+            AddressSpace* child = new AddressSpace(nextAsid++, pager, virtualPages);
+            size_t from, to;
+            for (uint64_t vpn = 0; vpn < resident; ++vpn) {
+                parent.resolve(vpn, false, from);
+                child->resolve(vpn, true, to);
+                std::memcpy(pager.frameData(to), pager.frameData(from), PAGE_SIZE);
+            }
+            copy += microsSince(start);
+            delete child;
+        }
+
+        // The copying COW defers: the child writes every shared page once
+        double breakNs = 0;
+        if (resident > 0) {
+            AddressSpace* child = parent.fork(nextAsid++);
+            auto start = Clock::now();
+            for (uint64_t vpn = 0; vpn < resident; ++vpn) {
+                child->resolve(vpn, true, frame);
+            }
+            breakNs = microsSince(start) * 1000.0 / resident;
+            delete child;
+        }
+
+        std::printf("%-10zu %-12.1f %-12.1f %.1f\n", resident, cow / reps, copy / reps, breakNs);
+    }
+    std::remove(diskPath);
+    return 0;
+}
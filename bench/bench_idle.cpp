@@ -0,0 +1,50 @@
+// Idle fast-forward: wall time of a long run in which one thread sleeps and
+// every CPU is idle. The run skips to the next timer deadline instead of
+// stepping each tick, so it should take milliseconds at any CPU count.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include "../include/Kernel.hpp"
+#include "../include/Logger.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+    // The kernel keeps its disk image in the working directory
+    char dir[] = "/tmp/myos_bench_idle.XXXXXX";
+    if (mkdtemp(dir) == nullptr || chdir(dir) != 0) {
+        std::printf("cannot create %s\n", dir);
+        return 1;
+    }
+
+    const int cycles = 10000000;
+    const int cpuCounts[] = {1, 2, 4, 8};
+    std::printf("%d cycles, one thread sleeping for 1M ticks\n", cycles);
+    std::printf("%-6s %-10s %s\n", "cpus", "ms", "idle ticks");
+    for (int numCpus : cpuCounts) {
+        KernelConfig config;
+        config.numCpus = numCpus;
+        config.formatDisk = true;
+        config.ioWorkers = 1;
+        Kernel kernel(config);
+        int pid = kernel.createProcess("sleeper");
+        kernel.sleepThread(kernel.spawnThread(pid, "a", 1), 1000000);
+
+        // The run's own summary goes to std::cout: keep it out of the table
+        std::ostringstream summary;
+        std::streambuf* out = std::cout.rdbuf(summary.rdbuf());
+        auto start = Clock::now();
+        kernel.runCycles(cycles);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::cout.rdbuf(out);
+        std::printf("%-6d %-10.2f %llu\n", numCpus, ms, (unsigned long long)kernel.getIdleTicks());
+    }
+
+    unlink("disk.bin");
+    rmdir(dir);
+    return 0;
+}
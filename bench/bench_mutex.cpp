@@ -0,0 +1,207 @@
+// Lock wait of a HIGH thread, with and without the mutex's priority
+// inheritance and adaptive spinning. Threads run small scripted programs
+// (compute, lock, hold, unlock) on schedulers stepped one tick at a time.
+//
+// Inversion: a LOW thread holds the lock when a HIGH thread asks for it, and
+// MEDIUM threads then keep the CPU busy. Without inheritance the HIGH thread
+// waits for all of them.
+//
+// Spinning: two CPUs stepped in lockstep, a HIGH thread on each taking turns
+// at a short critical section, with LOW filler behind them. Spinning costs
+// the ticks spent spinning but saves the block, wakeup and the two context
+// switches around them.
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "../include/Logger.hpp"
+#include "../include/Mutex.hpp"
+#include "../include/Scheduler.hpp"
+
+const int HIGH = 0;
+const int MEDIUM = 5;
+const int LOW = 10;
+
+struct Program {
+    Thread* thread;
+    int compute;   // Ticks between critical sections
+    int hold;      // Ticks in each
+    bool once;     // Exit after one critical section (or, with hold 0, after computing)
+    enum { Compute, Acquire, Critical } phase;
+    int left;
+    uint64_t askedAt;
+    bool waiting;  // Blocked in lock(): the wait ends when it runs again
+    std::vector<uint64_t> waits;
+};
+
+static void step(Program& p, Scheduler& scheduler, Mutex& mutex, uint64_t tick) {
+    if (p.waiting) {
+        p.waiting = false;
+        p.waits.push_back(tick - p.askedAt);
+    }
+    switch (p.phase) {
+        case Program::Compute:
+            if (--p.left > 0) {
+                return;
+            }
+            if (p.hold == 0) {
+                p.thread->setState(ThreadState::TERMINATED);
+                return;
+            }
+            p.phase = Program::Acquire;
+            p.askedAt = tick + 1;
+            return;
+        case Program::Acquire:
+            switch (mutex.lock(scheduler)) {
+                case LockResult::Acquired:
+                    p.waits.push_back(tick - p.askedAt);
+                    break;
+                case LockResult::Spinning:
+                    return;
+                case LockResult::Blocked:
+                    p.waiting = true;
+                    break;
+            }
+            p.phase = Program::Critical;
+            p.left = p.hold;
+            return;
+        case Program::Critical:
+            if (--p.left > 0) {
+                return;
+            }
+            mutex.unlock(scheduler);
+            if (p.once) {
+                p.thread->setState(ThreadState::TERMINATED);
+                return;
+            }
+            p.phase = Program::Compute;
+            p.left = p.compute;
+            return;
+    }
+}
+
+struct Sim {
+    std::vector<std::unique_ptr<Thread>> threads;
+    std::vector<Program> programs;  // By thread id - 1
+
+    Thread* spawn(int priority, int compute, int hold, bool once, bool lockFirst = false) {
+        int id = static_cast<int>(threads.size()) + 1;
+        threads.emplace_back(new Thread(id, 1, "bench", priority));
+        Program p = {threads.back().get(), compute, hold, once, lockFirst ? Program::Acquire : Program::Compute,
+                     std::max(compute, 1), 0, false, {}};
+        programs.push_back(p);
+        return threads.back().get();
+    }
+    Program& of(Thread* t) { return programs[t->getId() - 1]; }
+};
+
+// Ticks the HIGH thread waits for the lock
+static uint64_t inversion(bool inherit, int mediums, int mediumTicks) {
+    Sim sim;
+    Scheduler scheduler;
+    Mutex mutex(inherit, false);
+    scheduler.addThread(sim.spawn(LOW, 0, 50, true, true));
+    Thread* high = sim.spawn(HIGH, 0, 1, true, true);
+    for (uint64_t tick = 0; tick < 10000000; ++tick) {
+        if (tick == 5) {
+            scheduler.addThread(high);
+        }
+        if (tick == 6) {
+            for (int i = 0; i < mediums; ++i) {
+                scheduler.addThread(sim.spawn(MEDIUM, mediumTicks, 0, true));
+            }
+        }
+        scheduler.yield();
+        Thread* current = scheduler.getCurrentThread();
+        if (current != nullptr) {
+            step(sim.of(current), scheduler, mutex, tick);
+        }
+        if (!sim.of(high).waits.empty()) {
+            return sim.of(high).waits[0];
+        }
+    }
+    return 0;
+}
+
+struct SpinResult {
+    double meanWait;
+    uint64_t p99Wait;
+    double blocksPerAcquire;
+    double switchesPerAcquire;
+    uint64_t acquisitions;
+};
+
+static SpinResult spinning(bool adaptiveSpin, int compute, int hold, uint64_t ticks) {
+    Sim sim;
+    Scheduler cpu0(DEFAULT_PRIORITY_LEVELS, 0), cpu1(DEFAULT_PRIORITY_LEVELS, 1);
+    std::vector<Scheduler*> cpus = {&cpu0, &cpu1};
+    cpu0.setPeers(cpus);
+    cpu1.setPeers(cpus);
+    Mutex mutex(true, adaptiveSpin);
+    Thread* high = sim.spawn(HIGH, compute, hold, false);
+    cpu0.addThread(high);
+    cpu1.addThread(sim.spawn(HIGH, compute + 1, hold, false));
+    cpu0.addThread(sim.spawn(LOW, 1 << 30, 0, true));
+    cpu1.addThread(sim.spawn(LOW, 1 << 30, 0, true));
+
+    uint64_t switches = 0;
+    Thread* last = nullptr;
+    for (uint64_t tick = 0; tick < ticks; ++tick) {
+        for (Scheduler* cpu : cpus) {
+            cpu->yield();
+        }
+        switches += cpu0.getCurrentThread() != last;
+        last = cpu0.getCurrentThread();
+        for (Scheduler* cpu : cpus) {
+            if (Thread* current = cpu->getCurrentThread()) {
+                step(sim.of(current), *cpu, mutex, tick);
+            }
+        }
+    }
+
+    std::vector<uint64_t> waits = sim.of(high).waits;
+    std::sort(waits.begin(), waits.end());
+    SpinResult r = {};
+    r.acquisitions = waits.size();
+    if (!waits.empty()) {
+        uint64_t sum = 0;
+        for (uint64_t w : waits) {
+            sum += w;
+        }
+        r.meanWait = static_cast<double>(sum) / waits.size();
+        r.p99Wait = waits[waits.size() * 99 / 100];
+        MutexStats stats = mutex.getStats();
+        r.blocksPerAcquire = static_cast<double>(stats.blocks) / stats.acquisitions;
+        r.switchesPerAcquire = static_cast<double>(switches) / waits.size();
+    }
+    return r;
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    std::printf("Priority inversion: LOW holds the lock for 50 ticks, HIGH asks at tick 5\n");
+    std::printf("%-24s %-20s %s\n", "MEDIUM threads", "wait, no inheritance", "wait, inheritance");
+    const int loads[][2] = {{1, 1000}, {4, 1000}, {16, 1000}, {16, 100000}};
+    for (const auto& load : loads) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%d x %d ticks", load[0], load[1]);
+        std::printf("%-24s %-20llu %llu\n", name, (unsigned long long)inversion(false, load[0], load[1]),
+                    (unsigned long long)inversion(true, load[0], load[1]));
+    }
+
+    std::printf("\nTwo CPUs, a HIGH thread on each taking turns (HIGH on CPU0 measured)\n");
+    std::printf("%-24s %-10s %-10s %-14s %-18s %s\n", "compute/hold ticks", "spinning", "mean wait", "p99 wait",
+                "blocks/acquire", "CPU0 switches/acquire");
+    const int shapes[][2] = {{4, 2}, {8, 4}, {2, 8}};
+    for (const auto& shape : shapes) {
+        for (bool adaptive : {false, true}) {
+            SpinResult r = spinning(adaptive, shape[0], shape[1], 1000000);
+            char name[32];
+            std::snprintf(name, sizeof(name), "%d / %d", shape[0], shape[1]);
+            std::printf("%-24s %-10s %-10.2f %-14llu %-18.2f %.2f\n", name, adaptive ? "adaptive" : "off",
+                        r.meanWait, (unsigned long long)r.p99Wait, r.blocksPerAcquire, r.switchesPerAcquire);
+        }
+    }
+    return 0;
+}
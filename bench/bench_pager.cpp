@@ -0,0 +1,75 @@
+// Page replacement policies replayed over synthetic reference strings:
+// fault rate and swap I/O per policy, plus the policy's own cost per reference.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Replacement.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Workload {
+    const char* name;
+    std::vector<PageRef> trace;
+};
+
+// Cyclic scan over a working set one third larger than memory
+static std::vector<PageRef> loop(size_t frames, size_t refs) {
+    std::vector<PageRef> trace;
+    size_t span = frames + frames / 3;
+    for (size_t i = 0; i < refs; ++i) {
+        trace.push_back({pageKey(1, i % span), false});
+    }
+    return trace;
+}
+
+// 90% of references to a hot set of half the frames, the rest uniform over 8x memory
+static std::vector<PageRef> hotCold(size_t frames, size_t refs, std::mt19937_64& rng) {
+    std::vector<PageRef> trace;
+    for (size_t i = 0; i < refs; ++i) {
+        bool hot = rng() % 10 != 0;
+        uint64_t vpn = hot ? rng() % (frames / 2) : frames / 2 + rng() % (frames * 8);
+        trace.push_back({pageKey(1, vpn), rng() % 4 == 0});
+    }
+    return trace;
+}
+
+// Hot set in one process while another streams once through a large buffer
+static std::vector<PageRef> scanResistance(size_t frames, size_t refs, std::mt19937_64& rng) {
+    std::vector<PageRef> trace;
+    uint64_t stream = 0;
+    for (size_t i = 0; i < refs; ++i) {
+        if (i % 2 == 0) {
+            trace.push_back({pageKey(1, rng() % (frames * 3 / 4)), true});
+        } else {
+            trace.push_back({pageKey(2, stream++), false});
+        }
+    }
+    return trace;
+}
+
+int main() {
+    const size_t frames = 1024;
+    const size_t refs = 1000000;
+    std::mt19937_64 rng(5);
+    std::vector<Workload> workloads;
+    workloads.push_back({"loop", loop(frames, refs)});
+    workloads.push_back({"hot-cold", hotCold(frames, refs, rng)});
+    workloads.push_back({"scan", scanResistance(frames, refs, rng)});
+    const PagerPolicy policies[] = {PagerPolicy::Fifo, PagerPolicy::Clock, PagerPolicy::Lru, PagerPolicy::Arc};
+
+    std::printf("%d frames, %zu references per workload\n", static_cast<int>(frames), refs);
+    std::printf("%-10s %-7s %-10s %-10s %-10s %s\n", "workload", "policy", "fault %", "page-ins",
+                "page-outs", "ns/ref");
+    for (const Workload& w : workloads) {
+        for (PagerPolicy policy : policies) {
+            auto start = Clock::now();
+            ReplayStats stats = replayTrace(policy, w.trace, frames);
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / refs;
+            std::printf("%-10s %-7s %-10.2f %-10llu %-10llu %.1f\n", w.name, pagerPolicyName(policy),
+                        100.0 * stats.faults / stats.references, (unsigned long long)stats.pageIns,
+                        (unsigned long long)stats.pageOuts, ns);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Context switches, TLB misses and simulated throughput against the time
+// slice. Threads of several processes, all at one priority, each cycle over a
+// few data pages; every tick is one Scheduler::schedule() and one
+// translation through the CPU's TLB, as in Kernel::runCpu. A quantum of 1 is
+// the old yield-every-tick behaviour: each thread finds the TLB full of the
+// others' pages. Longer slices trade that for a longer wait between turns.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "../include/Cpu.hpp"
+#include "../include/Logger.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+const int PROCESSES = 8;
+const int THREADS_PER_PROCESS = 2;
+const int WORKING_SET = 8;  // Data pages per thread, besides the shared code page
+
+struct Result {
+    double switchesPerKTick;
+    double missRate;
+    double instrPerSecond;
+    uint64_t longestWait;  // Ticks a ready thread waited for its next turn
+};
+
+static Result measure(int quantum, uint64_t ticks) {
+    Cpu cpu(0, DEFAULT_PRIORITY_LEVELS);
+    cpu.scheduler.setQuantum(quantum);
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int p = 0; p < PROCESSES; ++p) {
+        for (int t = 0; t < THREADS_PER_PROCESS; ++t) {
+            threads.emplace_back(new Thread(static_cast<int>(threads.size()) + 1, p + 1, "bench", 1));
+            cpu.scheduler.addThread(threads.back().get());
+        }
+    }
+    std::vector<uint64_t> lastRan(threads.size() + 1, 0);
+    uint64_t longestWait = 0;
+
+    auto start = Clock::now();
+    for (cpu.tick = 1; cpu.tick <= ticks; ++cpu.tick) {
+        cpu.scheduler.schedule();
+        Thread* current = cpu.scheduler.getCurrentThread();
+        longestWait = std::max(longestWait, cpu.tick - lastRan[current->getId()] - 1);
+        lastRan[current->getId()] = cpu.tick;
+
+        // Alternate between the code page and the next page of the working set
+        uint64_t step = current->getRunTicks();
+        uint64_t vpn = (step & 1) ? 1 + (step / 2) % WORKING_SET + WORKING_SET * current->getId() : 0;
+        size_t frame;
+        if (!cpu.tlb.lookup(current->getParentPid(), vpn, 0, false, frame)) {
+            cpu.tlb.insert(current->getParentPid(), vpn, 0, vpn, false);
+        }
+        current->addRunTick();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Result r;
+    r.switchesPerKTick = 1000.0 * cpu.scheduler.getContextSwitches() / ticks;
+    r.missRate = 100.0 * cpu.tlb.misses / (cpu.tlb.hits + cpu.tlb.misses);
+    r.instrPerSecond = ticks / seconds;
+    r.longestWait = longestWait;
+    return r;
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    const int quanta[] = {1, 2, 5, 10, 20, 50, 100};
+    const uint64_t ticks = 5000000;
+    std::printf("%d threads in %d processes, %d data pages each; TLB of %d entries\n",
+                PROCESSES * THREADS_PER_PROCESS, PROCESSES, WORKING_SET, Tlb::SETS * Tlb::WAYS);
+    std::printf("%-10s %-18s %-14s %-16s %s\n", "quantum", "switches/1K ticks", "TLB miss %", "instr/s",
+                "longest wait (ticks)");
+    for (int quantum : quanta) {
+        Result r = measure(quantum, ticks);
+        std::printf("%-10d %-18.1f %-14.1f %-16.0f %llu\n", quantum, r.switchesPerKTick, r.missRate,
+                    r.instrPerSecond, (unsigned long long)r.longestWait);
+    }
+    return 0;
+}
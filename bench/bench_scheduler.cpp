@@ -0,0 +1,43 @@
+// Pick-next latency of the bitmap-indexed ready queue.
+// Each iteration dequeues the best thread and re-queues it, which is what
+// Scheduler::yield() does for a running thread on every tick.
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../include/Scheduler.hpp"
+
+static double measure(int levels, int threadCount, int iterations) {
+    Scheduler scheduler(levels);
+    std::vector<std::unique_ptr<Thread>> threads;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> prio(0, levels - 1);
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(new Thread(i + 1, 1, "bench", prio(rng)));
+        scheduler.addThread(threads.back().get());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        Thread* next = scheduler.pickNext();
+        scheduler.addThread(next);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int main() {
+    const int levelCounts[] = {2, 64, 140, 1024, MAX_PRIORITY_LEVELS};
+    const int threadCounts[] = {16, 1000, 100000};
+    const int iterations = 2000000;
+
+    std::printf("%-8s %-10s %s\n", "levels", "threads", "ns/pick+requeue");
+    for (int levels : levelCounts) {
+        for (int threadCount : threadCounts) {
+            std::printf("%-8d %-10d %.1f\n", levels, threadCount,
+                        measure(levels, threadCount, iterations));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Cross-CPU wakeups: host threads posting to one scheduler's inbox while
+// its CPU keeps scheduling, as I/O workers or timers would. The lock-free
+// inbox against the mutex-guarded vector it replaced, reproduced here.
+//
+// Each poster cycles through its own set of threads. They are already
+// runnable, so applying an entry is only the state check: what is measured
+// is the queue. A thread posted again before the CPU got to it takes one
+// inbox entry, where the vector took one per post. Posters report their
+// rate; the CPU reports how long its schedule() calls took, which with the
+// lock includes waiting for whichever poster holds it.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../include/Logger.hpp"
+#include "../include/Scheduler.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+const int POSTS_PER_PRODUCER = 1000000;
+const int TARGETS_PER_PRODUCER = 256;
+
+class LockedInbox {
+  public:
+    void post(Thread* thread) {
+        std::lock_guard<std::mutex> guard(lock);
+        inbox.emplace_back(thread, true);
+        pending.store(true, std::memory_order_release);
+    }
+    void drain(Scheduler& scheduler) {
+        if (!pending.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::vector<std::pair<Thread*, bool>> posted;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            posted.swap(inbox);
+            pending.store(false, std::memory_order_relaxed);
+        }
+        for (const auto& entry : posted) {
+            scheduler.wakeup(entry.first);
+        }
+    }
+
+  private:
+    std::mutex lock;
+    std::vector<std::pair<Thread*, bool>> inbox;
+    std::atomic<bool> pending{false};
+};
+
+struct Result {
+    double postsPerSecond;  // All posters together
+    double tickMean;        // ns per schedule() on the CPU
+    double tickP99;
+};
+
+static Result measure(bool locked, int producers) {
+    Scheduler scheduler(DEFAULT_PRIORITY_LEVELS);
+    LockedInbox lockedInbox;
+    std::unique_ptr<Thread> running(new Thread(1, 1, "cpu", 1));
+    scheduler.addThread(running.get());
+    std::vector<std::unique_ptr<Thread>> targets;
+    for (int i = 0; i < producers * TARGETS_PER_PRODUCER; ++i) {
+        targets.emplace_back(new Thread(i + 2, 2, "target", 1));
+    }
+
+    std::atomic<int> done(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> posters;
+    for (int i = 0; i < producers; ++i) {
+        posters.emplace_back([&, i] {
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            for (int n = 0; n < POSTS_PER_PRODUCER; ++n) {
+                Thread* target = targets[i * TARGETS_PER_PRODUCER + n % TARGETS_PER_PRODUCER].get();
+                if (locked) {
+                    lockedInbox.post(target);
+                } else {
+                    scheduler.postWakeup(target);
+                }
+            }
+            done.fetch_add(1, std::memory_order_release);
+        });
+    }
+
+    std::vector<uint64_t> ticks;
+    ticks.reserve(1 << 22);
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    while (done.load(std::memory_order_acquire) < producers) {
+        auto before = Clock::now();
+        if (locked) {
+            lockedInbox.drain(scheduler);
+        }
+        scheduler.schedule();
+        ticks.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - before).count());
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& t : posters) {
+        t.join();
+    }
+    lockedInbox.drain(scheduler);
+    scheduler.schedule();
+
+    Result r;
+    r.postsPerSecond = double(producers) * POSTS_PER_PRODUCER / seconds;
+    uint64_t sum = 0;
+    for (uint64_t t : ticks) {
+        sum += t;
+    }
+    r.tickMean = ticks.empty() ? 0 : double(sum) / ticks.size();
+    std::sort(ticks.begin(), ticks.end());
+    r.tickP99 = ticks.empty() ? 0 : ticks[ticks.size() * 99 / 100];
+    return r;
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+
+    const int producerCounts[] = {1, 2, 4, 8};
+    std::printf("%d posts per host thread\n", POSTS_PER_PRODUCER);
+    std::printf("%-10s %-10s %-14s %-16s %s\n", "posters", "inbox", "Mposts/s", "tick mean (ns)", "tick p99 (ns)");
+    for (int producers : producerCounts) {
+        for (bool locked : {true, false}) {
+            Result r = measure(locked, producers);
+            std::printf("%-10d %-10s %-14.1f %-16.0f %.0f\n", producers, locked ? "mutex" : "lock-free",
+                        r.postsPerSecond / 1e6, r.tickMean, r.tickP99);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Pager;
+
+const size_t PAGE_SIZE = 64;
+const int PAGE_SHIFT = 6;
+const size_t DEFAULT_PROCESS_PAGES = 16;  // 1 KB of virtual memory
+const uint64_t INSTRUCTION_SIZE = 4;      // Code sits at the bottom of every address space
+
+enum : uint32_t {
+    PTE_PRESENT = 1,
+    PTE_WRITABLE = 2,
+    PTE_ACCESSED = 4,
+    PTE_DIRTY = 8,
+    PTE_SWAPPED = 16,  // 'slot' holds a current copy of the page
+    PTE_COW = 32       // Frame shared with a forked address space; a write copies it
+};
+
+struct PageTableEntry {
+    size_t frame;    // RAM offset of the frame while PTE_PRESENT
+    uint32_t flags;
+    uint32_t slot;   // Swap slot while PTE_SWAPPED
+};
+
+enum class FaultResult {
+    Mapped,      // Already resident (TLB miss only)
+    DemandZero,  // Page fault, a zeroed frame was mapped in
+    SwapIn,      // Page fault, the page was read back from swap
+    CopyOnWrite, // Write to a shared page, which was copied
+    Segfault,    // Outside the address space
+    OutOfMemory  // No frame and nothing left to evict
+};
+
+// A process's virtual memory: a flat page table over frames handed out by
+// the Pager, populated on demand and paged out to swap under pressure.
+// fork() shares every frame and swap slot with the child copy-on-write. Callers serialize page-table changes (Kernel::vmLock);
+// CPUs cache translations in their TLB, tagged with the ASID and the
+// generation below, so bumping the generation invalidates all of them.
+class AddressSpace {
+  private:
+    int asid;
+    int family;  // ASID of the ancestor this address space was forked from
+    Pager& pager;
+    std::vector<PageTableEntry> pageTable;  // One entry per virtual page
+    size_t residentPages;
+    size_t swappedPages;
+    uint64_t faults;
+    std::atomic<uint64_t> generation;
+
+  public:
+    AddressSpace(int asid, Pager& pager, size_t pages, int family = -1);
+    ~AddressSpace();  // Returns every frame and swap slot
+
+    AddressSpace(const AddressSpace&) = delete;
+    AddressSpace& operator=(const AddressSpace&) = delete;
+
+    // Page walk, faulting the page in if needed. Sets ACCESSED (and DIRTY
+    // for writes) and returns the frame in 'frame'.
+    FaultResult resolve(uint64_t vpn, bool write, size_t& frame);
+
+    const PageTableEntry* entry(uint64_t vpn) const;
+
+    // Copy-on-write clone for a child process: no page is copied, shared
+    // writable pages become read-only in both until one of them writes
+    AddressSpace* fork(int childAsid);
+
+    // Eviction, called by the Pager once the frame's contents are safe:
+    // 'toSwap' if they were just written to 'slot'
+    void unmapPage(uint64_t vpn, bool toSwap, uint32_t slot);
+    bool testAndClearAccessed(uint64_t vpn);
+
+    // Invalidate every TLB entry for this address space
+    void invalidate() { generation.fetch_add(1, std::memory_order_release); }
+
+    int getAsid() const { return asid; }
+    int getFamily() const { return family; }
+    uint64_t getGeneration() const { return generation.load(std::memory_order_acquire); }
+    size_t getPageCount() const { return pageTable.size(); }
+    size_t getResidentPages() const { return residentPages; }
+    size_t getSwappedPages() const { return swappedPages; }
+    uint64_t getFaults() const { return faults; }
+};
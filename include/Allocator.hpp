@@ -0,0 +1,154 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "MappedRegion.hpp"
+
+struct MemoryBlock {
+    size_t offset;
+    size_t size;
+    bool isFree;
+};
+
+// Placement policy over the offsets [0, capacity) of simulated RAM. The
+// MemoryManager owns the bytes; allocators keep their metadata inside them
+// (or in a flat side table) rather than in per-block heap nodes.
+class Allocator {
+  public:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    virtual ~Allocator() {}
+
+    // Offset of at least 'size' usable bytes, NONE if nothing fits
+    virtual size_t allocate(size_t size) = 0;
+
+    // Free the allocation at 'offset'. Returns its block size, 0 if no
+    // allocation starts there.
+    virtual size_t release(size_t offset) = 0;
+
+    // Every block, free or used, in address order
+    virtual void blocks(std::vector<MemoryBlock>& out) const = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// Doubly linked free lists stored inside the free blocks themselves (next
+// and prev offsets at 'linkAt' bytes into the block), one list per size
+// class, with a bitmap of non-empty classes
+class FreeLists {
+  private:
+    static constexpr uint64_t END = UINT64_MAX;
+    char* base;
+    size_t linkAt;
+    std::vector<uint64_t> heads;
+    uint64_t nonEmpty;
+
+    uint64_t load(uint64_t at) const {
+        uint64_t v;
+        std::memcpy(&v, base + at, sizeof(v));
+        return v;
+    }
+    void store(uint64_t at, uint64_t v) { std::memcpy(base + at, &v, sizeof(v)); }
+    uint64_t nextOf(uint64_t block) const { return load(block + linkAt); }
+    uint64_t prevOf(uint64_t block) const { return load(block + linkAt + 8); }
+    void setNext(uint64_t block, uint64_t v) { store(block + linkAt, v); }
+    void setPrev(uint64_t block, uint64_t v) { store(block + linkAt + 8, v); }
+
+  public:
+    FreeLists(char* base, size_t linkAt, int classes);
+    void push(int cls, uint64_t block);
+    void remove(int cls, uint64_t block);
+    uint64_t head(int cls) const { return heads[cls]; }
+    uint64_t after(uint64_t block) const { return nextOf(block); }
+    bool isEnd(uint64_t block) const { return block == END; }
+
+    // Lowest non-empty class >= 'cls', -1 if none
+    int firstAtLeast(int cls) const;
+};
+
+// Boundary-tag heap. Every block starts with an 8-byte header holding its
+// size and FREE / PREV_FREE bits; free blocks also carry their free-list
+// links and a footer with their size, so freeing coalesces with both
+// neighbours in O(1). Used blocks cost only the header.
+//
+// With one size class this is first fit over an explicit free list; with
+// CLASSES it is segregated fits, binned by floor(log2(size)).
+class BoundaryTagAllocator : public Allocator {
+  private:
+    static constexpr uint64_t FREE = 1;
+    static constexpr uint64_t PREV_FREE = 2;
+    static constexpr uint64_t FLAGS = 15;
+    static constexpr int BIN_SCAN = 8;
+
+    char* base;
+    size_t limit;  // End of the last block
+    int classes;
+    FreeLists bins;
+
+    uint64_t load(size_t at) const {
+        uint64_t v;
+        std::memcpy(&v, base + at, sizeof(v));
+        return v;
+    }
+    void store(size_t at, uint64_t v) { std::memcpy(base + at, &v, sizeof(v)); }
+    size_t sizeOf(size_t block) const { return load(block) & ~FLAGS; }
+    int classOf(size_t size) const;
+    void setPrevFree(size_t block, bool prevFree);
+    void insertFree(size_t block, size_t size);
+    void removeFree(size_t block);
+    size_t findFit(size_t size) const;
+
+  protected:
+    BoundaryTagAllocator(char* base, size_t capacity, int classes);
+
+  public:
+    static constexpr size_t ALIGN = 16;
+    static constexpr size_t HEADER = 8;
+    static constexpr size_t MIN_BLOCK = 32;  // Header, two links, footer
+    static constexpr int CLASSES = 40;
+
+    size_t allocate(size_t size) override;
+    size_t release(size_t offset) override;
+    void blocks(std::vector<MemoryBlock>& out) const override;
+};
+
+class FirstFitAllocator : public BoundaryTagAllocator {
+  public:
+    FirstFitAllocator(char* base, size_t capacity) : BoundaryTagAllocator(base, capacity, 1) {}
+    const char* name() const override { return "first-fit"; }
+};
+
+class SegregatedAllocator : public BoundaryTagAllocator {
+  public:
+    SegregatedAllocator(char* base, size_t capacity) : BoundaryTagAllocator(base, capacity, CLASSES) {}
+    const char* name() const override { return "segregated"; }
+};
+
+// Binary buddy system over 16-byte units: power-of-two blocks, split on
+// allocate and merged with their buddy on free, O(log n) both ways. A
+// buddy's first bytes may be live payload, so each unit has a one-byte tag
+// (order and state) in a lazily committed side table; free-list links live
+// in the free blocks.
+class BuddyAllocator : public Allocator {
+  private:
+    static constexpr size_t MIN_BLOCK = 16;
+    static constexpr int MAX_ORDER = 40;
+    enum : uint8_t { INTERIOR = 0, FREE_BLOCK = 1 << 6, USED_BLOCK = 2 << 6 };
+
+    size_t units;
+    MappedRegion tags;  // Order in the low 6 bits, state in the top 2
+    FreeLists orders;
+
+    uint8_t* tag() const { return reinterpret_cast<uint8_t*>(tags.data()); }
+    int orderAt(size_t unit) const { return tag()[unit] & 63; }
+    uint8_t stateAt(size_t unit) const { return tag()[unit] & 0xC0; }
+    void setTag(size_t unit, int order, uint8_t state) { tag()[unit] = static_cast<uint8_t>(order | state); }
+
+  public:
+    BuddyAllocator(char* base, size_t capacity);
+    size_t allocate(size_t size) override;
+    size_t release(size_t offset) override;
+    void blocks(std::vector<MemoryBlock>& out) const override;
+    const char* name() const override { return "buddy"; }
+};
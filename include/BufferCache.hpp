@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const size_t BLOCK_SIZE = 512;
+
+struct BufferCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t writebacks;  // Dirty blocks written to the image
+    uint64_t syncs;
+    size_t cached;
+    size_t dirty;
+    size_t capacity;
+};
+
+// Write-back cache of disk image blocks. The image is opened once and kept
+// open; reads and writes copy through cached blocks, and a dirty block only
+// reaches the file when it is evicted (LRU) or on sync(). Thread-safe: the
+// shell and the pager's swap I/O share one cache.
+class BufferCache {
+  public:
+    static constexpr size_t DEFAULT_BLOCKS = 64;
+    // Crash testing: the process SIGKILLs itself in place of this many-th
+    // block write to any image (0 = never)
+    static uint64_t crashAfterWrites;
+
+    explicit BufferCache(const std::string& path, size_t blocks = DEFAULT_BLOCKS);
+    ~BufferCache();  // Flushes
+
+    BufferCache(const BufferCache&) = delete;
+    BufferCache& operator=(const BufferCache&) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+    size_t imageSize() const;
+    bool resize(size_t bytes);  // Cached blocks past the new end are dropped
+
+    // Bytes past the end of the image read as zeros; writing there grows it
+    bool read(size_t offset, char* buffer, size_t len);
+    bool write(size_t offset, const char* data, size_t len);
+
+    // Write every dirty block in disk order, then fdatasync. Returns the
+    // number of blocks written, -1 on an I/O error.
+    int sync();
+
+    BufferCacheStats getStats();
+
+  private:
+    struct Buffer {
+        uint64_t block;
+        size_t slot;  // Index into 'memory'
+        bool dirty;
+    };
+
+    int fd;
+    size_t capacity;
+    std::vector<char> memory;  // capacity * BLOCK_SIZE
+    std::list<Buffer> lru;     // Front = most recently used
+    std::vector<size_t> freeSlots;
+    std::unordered_map<uint64_t, std::list<Buffer>::iterator> blocks;
+    size_t dirtyCount;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t writebacks;
+    uint64_t syncs;
+    std::mutex lock;
+
+    // Cached copy of 'block', loaded unless the caller overwrites all of it
+    Buffer* get(uint64_t block, bool overwrite);
+    bool writeBack(Buffer& buffer);
+    int flush();
+    char* dataOf(const Buffer& buffer) { return &memory[buffer.slot * BLOCK_SIZE]; }
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "Scheduler.hpp"
+#include "TimerWheel.hpp"
+#include "Tlb.hpp"
+#include "WorkStealingDeque.hpp"
+
+const int MAX_CPUS = 64;
+
+// One simulated CPU: a private run queue plus a deque other CPUs can steal from.
+// During Kernel::runCycles each CPU is driven by its own host std::thread and
+// only that thread touches the scheduler; the steal queue is the only shared state.
+struct Cpu {
+    int id;
+    Scheduler scheduler;
+    WorkStealingDeque<Thread*> stealQueue;
+    TimerWheel timers;  // Threads sleeping until a tick of this CPU's clock
+    uint64_t tick;      // Local clock, advanced once per cycle
+    Tlb tlb;
+
+    // Set while this CPU has a thread to run or I/O in flight. Idle CPUs only
+    // fast-forward their clock once no CPU is busy (before that they might
+    // still steal work), and then to the earliest timer of any of them.
+    std::atomic<bool> busy;
+    std::atomic<uint64_t> idleFor;  // While idle: ticks to its next timer (TimerWheel::NEVER: none)
+
+    // Statistics
+    uint64_t instructions;
+    uint64_t steals;
+    uint64_t busyTicks;
+    uint64_t idleTicks;
+
+    Cpu(int id, int priorityLevels)
+        : id(id), scheduler(priorityLevels, id), tick(0), busy(false), idleFor(TimerWheel::NEVER),
+          instructions(0),
+          steals(0), busyTicks(0), idleTicks(0) {}
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+struct DentryCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t cached;
+    size_t capacity;
+};
+
+// Recently resolved path components: (directory inode, name) -> inode. Path
+// lookup consults it one component at a time, so a warm lookup is O(depth)
+// hash probes with no directory block reads. LRU-bounded; the file system
+// drops an entry when its name is removed.
+class DentryCache {
+  public:
+    static constexpr size_t DEFAULT_ENTRIES = 1 << 16;
+
+    explicit DentryCache(size_t capacity = DEFAULT_ENTRIES);
+
+    int lookup(uint32_t dir, const std::string& name);  // -1 if not cached
+    void insert(uint32_t dir, const std::string& name, uint32_t inode);
+    void erase(uint32_t dir, const std::string& name);
+    void clear();
+
+    DentryCacheStats getStats() const;
+
+  private:
+    struct Dentry {
+        std::string key;
+        uint32_t inode;
+    };
+
+    size_t capacity;
+    std::list<Dentry> lru;  // Front = most recently used
+    std::unordered_map<std::string, std::list<Dentry>::iterator> entries;
+    uint64_t hits;
+    uint64_t misses;
+
+    static std::string keyOf(uint32_t dir, const std::string& name);
+};
@@ -1,43 +1,232 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <fstream>
+#include "BufferCache.hpp"
+#include "DentryCache.hpp"
+#include "Journal.hpp"
 
-const int MAX_FILES = 16;
 const int MAX_OPEN_FILES = 8;
-const size_t DISK_SIZE = 4096;
+const size_t MAX_FILENAME = 55;  // Per path component
+const size_t DIRECT_EXTENTS = 6;
+const size_t INDIRECT_EXTENTS = BLOCK_SIZE / 8;  // Held by an inode's overflow block
+const uint32_t FS_MAGIC = 0x5346594d;             // "MYFS"
+const uint32_t FS_VERSION = 4;
+const uint32_t INODE_USED = 1;
+const uint32_t INODE_DIR = 2;
+const uint32_t ROOT_INODE = 0;
+const size_t PREALLOC_BLOCKS = 8;  // Minimum run taken when a file grows
+
+// A run of contiguous blocks
+struct Extent {
+    uint32_t start;
+    uint32_t length;
+};
+
+// Block 0 of the image. Then come the free-block bitmap, the inode table, the
+// metadata journal and the data blocks; the pager's swap region follows the
+// last block.
+struct SuperBlock {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t totalBlocks;
+    uint32_t inodeCount;
+    uint32_t bitmapStart;
+    uint32_t bitmapBlocks;
+    uint32_t inodeStart;
+    uint32_t inodeBlocks;
+    uint32_t dataStart;
+    uint32_t freeBlocks;
+    uint32_t clean;           // Set only by an orderly unmount
+    uint32_t inodeHighWater;  // No inode at or past this index was ever used
+    uint32_t journalStart;
+    uint32_t journalBlocks;   // 0 = unjournaled
+};
+
+// On-disk inode. Extents past the direct ones live in the 'indirect' block.
+struct DiskInode {
+    uint32_t flags;
+    uint32_t extentCount;
+    uint64_t size;
+    char name[MAX_FILENAME + 1];
+    Extent extents[DIRECT_EXTENTS];
+    uint32_t indirect;
+    uint32_t parent;  // Directory holding the entry; the root is its own parent
+};
+static_assert(sizeof(DiskInode) == 128, "inode table layout");
+
+// A directory is a linear hash table of one-block buckets, so its 'size' is
+// always a whole number of blocks. A name lives in bucket hash mod 2^(i+1),
+// or hash mod 2^i if that bucket doesn't exist yet, where 2^i <= buckets <
+// 2^(i+1). A full bucket is relieved by splitting bucket (buckets - 2^i)
+// into itself and a new last bucket, one block at a time.
+struct DirEntry {
+    uint32_t inode;
+    uint32_t hash;
+    char name[MAX_FILENAME + 1];  // Empty = free slot
+};
+static_assert(sizeof(DirEntry) == 64, "directory block layout");
+const size_t DIR_ENTRIES_PER_BLOCK = BLOCK_SIZE / sizeof(DirEntry);
 
 struct Inode {
-    std::string filename;
-    size_t offset;
-    size_t size;
-    bool inUse;
+    std::string filename;  // Name in the parent directory
+    uint64_t size;
+    std::vector<Extent> extents;  // In file order; may run past 'size' (preallocated)
+    uint32_t indirect;            // Overflow extent block, 0 if none
+    uint32_t parent;
+    bool isDir;
+
+    size_t blockCount() const;
+};
+
+struct DirListing {
+    std::string name;
+    uint32_t inode;
+    bool isDir;
+    uint64_t size;
 };
 
 struct OpenFile {
     int inodeIndex;
-    size_t readPos;
+    uint64_t offset;  // Where the next read or write starts
     bool isOpen;
 };
 
+// One buffer of a vectored read or write
+struct IoVec {
+    char* base;
+    size_t len;
+};
+
 class FileSystem {
+public:
+    static constexpr size_t DEFAULT_DISK_SIZE = 1 << 20;
+    static constexpr size_t DEFAULT_INODES = 128;
+    static constexpr size_t MAX_DISK_SIZE = static_cast<size_t>(UINT32_MAX) * BLOCK_SIZE;
+    static constexpr size_t MIN_JOURNAL_BLOCKS = 64;
+    static constexpr size_t MAX_JOURNAL_BLOCKS = 2048;
+
 private:
     std::string diskPath;
-    Inode inodeTable[MAX_FILES];
+    BufferCache cache;  // disk.bin stays open; I/O goes through cached blocks
+    Journal journal;    // Superblock, bitmap and inode writes go through it
+    SuperBlock super;
+    std::vector<uint64_t> bitmap;  // Copy of the on-disk bitmap, bit set = block in use
+    // Blocks freed by the running transaction stay unallocatable until it
+    // commits, so a crash can't leave a file pointing at another's data.
+    // Freed metadata blocks (overflow extents, directories) also wait for a
+    // checkpoint: replaying an older logged copy would overwrite whatever
+    // reused them.
+    std::vector<uint64_t> reserved;
+    std::vector<Extent> pendingFree;
+    std::vector<Extent> pendingLogged;
+    std::vector<Extent> heldLogged;
+    uint32_t reservedBlocks;
+    // Inodes are read a table block at a time, as path lookup reaches them
+    std::unordered_map<uint32_t, Inode> inodeTable;  // Loaded, in-use inodes
+    DentryCache dentries;
+    std::vector<bool> inodeBlockLoaded;
+    bool allInodesLoaded;
+    std::vector<uint32_t> freeInodes;  // Unused indexes below the high-water mark
     OpenFile openFiles[MAX_OPEN_FILES];
-    size_t nextFreeOffset;
+    uint32_t allocHint;  // Where a new file's first extent is sought
+
+    bool mount();
+    void format(size_t diskBytes, size_t inodes, bool journaled);
+    void loadInodeBlock(uint32_t block);
+    void loadAllInodes();
+    void rebuildBitmap();  // After an unclean shutdown of an unjournaled image
+    Inode* getInode(uint32_t index);  // nullptr if unused
+    int allocateInode(const std::string& name, uint32_t parent, bool isDir);
+    void releaseInode(uint32_t index);
+
+    // Path resolution from the root, one directory lookup per component
+    int lookup(uint32_t dir, const std::string& name);
+    int resolve(const std::string& path);
+    int resolveParent(const std::string& path, std::string& name);  // Parent directory of a new entry
+    int create(const std::string& path, bool isDir);
+
+    // Directory buckets
+    bool readBucket(const Inode& dir, size_t bucket, DirEntry* entries);
+    bool writeBucket(const Inode& dir, size_t bucket, const DirEntry* entries);
+    bool initDirectory(Inode& dir);
+    bool splitBucket(uint32_t dir);
+    bool makeRoom(uint32_t dir, uint32_t hash);  // Split until the name's bucket has a free slot
+    bool dirInsert(uint32_t dir, const std::string& name, uint32_t inode);
+    void dirRemove(uint32_t dir, const std::string& name);
+    bool dirEmpty(const Inode& dir);
 
-    void initDisk();
-    int findInode(const std::string& filename);
-    int allocateInode(const std::string& filename);
+    // Block allocation, preferring to extend a file's last extent in place
+    bool isFree(uint32_t block) const { return !((bitmap[block / 64] | reserved[block / 64]) >> (block % 64) & 1); }
+    uint32_t available() const { return super.freeBlocks - reservedBlocks; }
+    uint32_t findFree(uint32_t goal) const;
+    void setBits(uint32_t start, uint32_t count, bool used);
+    void freeRun(uint32_t start, uint32_t count, bool logged);
+    void release(uint32_t start, uint32_t count);
+    void writeBitmap(uint32_t start, uint32_t count);
+    bool growTo(Inode& inode, size_t blocks);
+    void shrinkTo(Inode& inode, size_t blocks);
+    bool reclaimPreallocated(const Inode& except);  // Under pressure; true if any freed
+
+    // Disk offset of byte 'pos' of a file, and how many bytes follow it contiguously
+    size_t diskOffset(const Inode& inode, uint64_t pos, size_t& contiguous) const;
+    OpenFile* fileOf(int fd);  // nullptr if not open
+    // Byte transfers at a file position; writes grow the file, zero-filling any gap
+    int readAt(const Inode& inode, uint64_t pos, char* buffer, size_t len);
+    int writeAt(int inodeIdx, uint64_t pos, const char* data, size_t len);
+    bool copyOut(const Inode& inode, uint64_t pos, char* buffer, size_t len);
+    bool copyIn(const Inode& inode, uint64_t pos, const char* data, size_t len);
+    bool writeInode(int index);
+    void writeSuperBlock();
+
+    // Commit the running transaction, optionally emptying the journal too
+    int commit(bool checkpoint);
+    void maybeCommit();
 
 public:
-    FileSystem(const std::string& path = "disk.bin");
+    // Mounts the image at 'path', or formats it with the given geometry if
+    // it holds no file system (or 'formatDisk' is set)
+    FileSystem(const std::string& path = "disk.bin", size_t diskBytes = DEFAULT_DISK_SIZE,
+               size_t inodes = DEFAULT_INODES, bool formatDisk = false, bool journaled = true);
+    ~FileSystem();  // Unmounts cleanly
 
-    int my_open(const std::string& filename);
+    // Paths are '/'-separated from the root; a leading '/' is optional
+    bool exists(const std::string& path) { return resolve(path) != -1; }
+    bool isDirectory(const std::string& path);
+    int my_open(const std::string& path);  // Creates the file if missing
+    // At the file offset, which they advance
     int my_write(int fd, const char* data, size_t len);
     int my_read(int fd, char* buffer, size_t len);
+    // At 'offset', leaving the file offset alone
+    int my_pwrite(int fd, const char* data, size_t len, uint64_t offset);
+    int my_pread(int fd, char* buffer, size_t len, uint64_t offset);
+    // Scatter-gather at the file offset: one transfer, and one size update,
+    // for all of the buffers
+    int my_writev(int fd, const IoVec* iov, int count);
+    int my_readv(int fd, const IoVec* iov, int count);
+    int64_t my_seek(int fd, int64_t offset, int whence);  // SEEK_SET/CUR/END; the new offset, or -1
     void my_close(int fd);
-    
+    int my_truncate(const std::string& path, size_t size);  // Shrink, freeing blocks
+    int my_unlink(const std::string& path);
+    int my_mkdir(const std::string& path);
+    int my_rmdir(const std::string& path);  // Only if empty
+    int my_listdir(const std::string& path, std::vector<DirListing>& entries);  // Count, or -1
+
+    // Raw I/O on the disk image, for the pager's swap region
+    bool readBlock(size_t offset, char* buffer, size_t len);
+    bool writeBlock(size_t offset, const char* data, size_t len);
+    size_t swapOffset() const { return static_cast<size_t>(super.totalBlocks) * BLOCK_SIZE; }
+
+    // Commit metadata and write dirty cached blocks back. Blocks written, or -1.
+    int sync();
+    BufferCacheStats getCacheStats() { return cache.getStats(); }
+    JournalStats getJournalStats() const { return journal.getStats(); }
+    DentryCacheStats getDentryStats() const { return dentries.getStats(); }
+
+    // Consistency check of the mounted image; false with 'problems' filled in
+    bool check(std::vector<std::string>& problems);
+
     void printInodeTable();
 };
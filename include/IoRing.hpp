@@ -0,0 +1,166 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FileSystem;
+
+enum class IoOp { Read, Write };
+
+// Submission queue entry: 'len' bytes between the file at 'path' and the
+// submitting thread's memory at 'vaddr'. A write carries its bytes, copied
+// out of the thread's memory when it is submitted.
+struct IoRequest {
+    IoOp op;
+    int tid;
+    int cpu;         // Its completion is reaped by this CPU
+    std::string path;
+    int64_t offset;  // -1 = append
+    uint64_t vaddr;
+    size_t len;
+    std::vector<char> data;
+};
+
+// Completion queue entry. A read brings its bytes back here, and they are
+// copied into the thread's memory when the completion is reaped.
+struct IoCompletion {
+    IoOp op;
+    int tid;
+    int cpu;
+    uint64_t vaddr;
+    int result;  // Bytes transferred, -1 on error
+    std::vector<char> data;
+};
+
+struct IoStats {
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t failed;
+    uint64_t bytes;
+    size_t inFlight;  // Submitted and not yet serviced
+    int workers;
+    int latencyMicros;
+};
+
+// One process's submission and completion queues, after Linux io_uring: a
+// thread posts a request and blocks, an I/O worker takes it off the SQ and
+// posts the result to the CQ, and the submitting CPU reaps it and wakes the
+// thread. Threads on several CPUs and several workers share the queues, so
+// each ring has a lock. A full ring (requests not yet reaped) turns a
+// submission away.
+class IoRing {
+  public:
+    static constexpr size_t DEFAULT_ENTRIES = 32;
+
+    explicit IoRing(size_t entries = DEFAULT_ENTRIES);
+
+    bool submit(IoRequest&& request);  // false if full
+    bool take(IoRequest& request);     // Oldest submission, for a worker
+    void complete(IoCompletion&& completion);
+    bool reap(int cpu, IoCompletion& completion);  // Oldest completion for 'cpu'
+    // Fail everything not yet taken by a worker (the process is exiting);
+    // CPUs whose completions were posted are added to 'cpus'
+    void cancel(std::vector<int>& cpus);
+
+  private:
+    size_t capacity;
+    size_t pending;  // Submitted and not yet reaped
+    std::deque<IoRequest> sq;
+    std::deque<IoCompletion> cq;
+    std::mutex lock;
+};
+
+// Host threads that service submitted requests against the file system.
+// Requests are serialized on the file system itself, but each also spends
+// 'latencyMicros' of simulated device time outside that lock, so up to one
+// request per worker is in flight at once. Meanwhile the simulated CPUs keep
+// running other threads.
+//
+// Workers only run between resume() and pause(), i.e. during Kernel::runCycles:
+// pause() returns once no request is being serviced, so the shell can use
+// the file system directly between runs.
+class IoWorkerPool {
+  public:
+    static constexpr int DEFAULT_WORKERS = 4;
+    static constexpr int MAX_WORKERS = 64;  // One host thread each
+    static constexpr int DEFAULT_LATENCY_US = 200;
+
+    IoWorkerPool(FileSystem& fs, int cpus, int workers = DEFAULT_WORKERS, int latencyMicros = DEFAULT_LATENCY_US);
+    ~IoWorkerPool();
+
+    IoWorkerPool(const IoWorkerPool&) = delete;
+    IoWorkerPool& operator=(const IoWorkerPool&) = delete;
+
+    // Queue 'request' on 'ring' for the workers; false if the ring is full
+    bool submit(const std::shared_ptr<IoRing>& ring, IoRequest&& request);
+    // Fail the requests no worker has taken yet (the process is exiting)
+    void cancel(const std::shared_ptr<IoRing>& ring);
+
+    void resume();
+    void pause();
+
+    // Reaping, by the CPU's own host thread. 'reap' calls f(completion) for
+    // each completion posted for 'cpu' since the last call.
+    bool hasCompletions(int cpu) const { return doorbells[cpu].rung.load(std::memory_order_acquire); }
+    size_t inFlight(int cpu) const { return doorbells[cpu].inFlight.load(std::memory_order_relaxed); }
+    // Wait up to 'micros' for a completion for 'cpu'
+    void waitForCompletion(int cpu, int micros);
+
+    template <typename F>
+    void reap(int cpu, F f) {
+        Doorbell& bell = doorbells[cpu];
+        std::vector<std::shared_ptr<IoRing>> rings;
+        {
+            std::lock_guard<std::mutex> guard(bell.lock);
+            rings.swap(bell.rings);
+            bell.rung.store(false, std::memory_order_relaxed);
+        }
+        IoCompletion completion;
+        for (const auto& ring : rings) {
+            while (ring->reap(cpu, completion)) {
+                bell.inFlight.fetch_sub(1, std::memory_order_relaxed);
+                f(completion);
+            }
+        }
+    }
+
+    IoStats getStats() const;
+    int getWorkerCount() const { return static_cast<int>(threads.size()); }
+
+  private:
+    // Per-CPU notice of rings holding completions for it
+    struct Doorbell {
+        std::mutex lock;
+        std::condition_variable posted;
+        std::vector<std::shared_ptr<IoRing>> rings;
+        std::atomic<bool> rung{false};
+        std::atomic<size_t> inFlight{0};
+    };
+
+    FileSystem& fs;
+    int latencyMicros;
+    std::unique_ptr<Doorbell[]> doorbells;
+    std::vector<std::thread> threads;
+
+    std::mutex lock;  // Guards the fields below
+    std::condition_variable work;  // Submissions queued, or resumed or stopping
+    std::condition_variable idle;  // A worker finished a request
+    std::deque<std::shared_ptr<IoRing>> queued;  // One entry per submission
+    int servicing;
+    bool running;
+    bool stopping;
+
+    std::mutex fsLock;  // Serializes file system calls between workers
+    std::atomic<uint64_t> submitted, completed, failed, bytes;
+
+    void workerLoop(int worker);
+    int service(IoRequest& request);
+    void post(int cpu, const std::shared_ptr<IoRing>& ring);  // Ring the CPU's doorbell
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "BufferCache.hpp"
+
+const uint32_t JOURNAL_MAGIC = 0x4c4e524a;  // "JRNL"
+
+enum JournalBlockType : uint32_t {
+    JOURNAL_SUPER = 1,       // First block of the region: where replay starts
+    JOURNAL_DESCRIPTOR = 2,  // Home block numbers of the logged blocks that follow it
+    JOURNAL_COMMIT = 3       // Ends a transaction; carries its checksum
+};
+
+// First 16 bytes of every journal block
+struct JournalHeader {
+    uint32_t magic;
+    uint32_t type;
+    uint32_t seq;    // Transaction; in the journal superblock, the first to replay
+    uint32_t count;  // Descriptor: entries; commit: blocks in the transaction
+};
+
+const size_t DESCRIPTOR_ENTRIES = (BLOCK_SIZE - sizeof(JournalHeader)) / sizeof(uint32_t);
+
+struct JournalStats {
+    uint64_t commits;
+    uint64_t blocksLogged;  // Metadata blocks written to the journal
+    uint64_t checkpoints;   // Times the journal wrapped
+    uint64_t replayed;      // Transactions recovered at the last mount
+    size_t running;         // Blocks in the open transaction
+    size_t capacity;        // Journal blocks, excluding its superblock
+};
+
+// Write-ahead log for file system metadata, in ordered mode: commit() first
+// flushes the buffer cache, so the data a transaction points at is on disk
+// before the transaction is, then logs descriptor blocks, the metadata
+// blocks and a checksummed commit block, and syncs once. Only then do the
+// blocks go to the cache for write-back to their home locations.
+//
+// Metadata writes collect in one running transaction shared by every
+// operation (group commit); the file system commits it once it fills a
+// quarter of the journal or is COMMIT_INTERVAL old, and on sync and
+// unmount. Until start(), writes go straight to the cache.
+class Journal {
+  public:
+    static constexpr std::chrono::milliseconds COMMIT_INTERVAL{50};
+
+    explicit Journal(BufferCache& cache);
+
+    // Lay out an empty journal in 'blocks' blocks from 'start' (0 = none)
+    void format(uint32_t start, uint32_t blocks);
+    // Replay every committed transaction into place. Returns how many.
+    int recover(uint32_t start, uint32_t blocks);
+    void start() { active = capacity > 0; }
+    void stop() { active = false; }
+    bool enabled() const { return capacity > 0; }
+
+    bool read(size_t offset, char* buffer, size_t len);
+    bool write(size_t offset, const char* data, size_t len);
+
+    bool wantsCommit() const;
+    // Returns the number of blocks written to the image, -1 on an I/O error
+    int commit();
+    // Flush the installed blocks home and empty the log
+    int checkpoint();
+
+    JournalStats getStats() const;
+
+  private:
+    BufferCache& cache;
+    uint32_t region;    // First block: the journal superblock
+    uint32_t capacity;  // Log blocks after it
+    uint32_t head;      // Next free log block
+    uint32_t seq;       // Next transaction
+    bool active;
+    std::map<uint32_t, std::vector<char>> running;  // Home block -> new contents
+    std::chrono::steady_clock::time_point opened;   // First write of the running transaction
+    JournalStats stats;
+
+    std::vector<char>* runningBlock(uint32_t block);
+    bool writeLog(uint32_t pos, const char* block);
+    bool readLog(uint32_t pos, char* block);
+    bool writeSuper();
+};
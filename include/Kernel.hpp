@@ -1,59 +1,162 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include "AddressSpace.hpp"
+#include "Cpu.hpp"
 #include "Scheduler.hpp"
 #include "Mutex.hpp"
 #include "MemoryManager.hpp"
 #include "FileSystem.hpp"
+#include "IoRing.hpp"
+#include "Pager.hpp"
 #include "Process.hpp"
+#include "Program.hpp"
 
 class Shell; // Forward declaration
 
+// Boot-time configuration (set from the command line in main)
+struct KernelConfig {
+    int priorityLevels = DEFAULT_PRIORITY_LEVELS;
+    int quantum = DEFAULT_QUANTUM;  // Ticks per time slice
+    SchedPolicy schedPolicy = SchedPolicy::Priority;
+    int numCpus = 1;
+    AllocPolicy allocPolicy = AllocPolicy::FirstFit;
+    size_t memoryBytes = MemoryManager::DEFAULT_MEMORY;
+    PagerPolicy pagerPolicy = PagerPolicy::Clock;
+    size_t swapBytes = Pager::DEFAULT_SWAP;
+    size_t diskBytes = FileSystem::DEFAULT_DISK_SIZE;
+    size_t inodeCount = FileSystem::DEFAULT_INODES;
+    bool formatDisk = false;  // Reformat disk.bin even if it holds a file system
+    int ioWorkers = IoWorkerPool::DEFAULT_WORKERS;
+    int ioLatencyMicros = IoWorkerPool::DEFAULT_LATENCY_US;  // Simulated device time per request
+};
+
 class Kernel {
   private:
-    Scheduler scheduler;
-    Mutex sharedMutex;
+    static constexpr int IO_POLL_MICROS = 50;  // Longest an idle CPU waits per tick for a completion
+
+    std::vector<std::unique_ptr<Cpu>> cpus;
+    int nextCpu;  // Round-robin placement of new threads
+    Mutex sharedMutex;  // Taken by the programs' lock/unlock
+    std::shared_ptr<const Program> demoProgram;  // Run by threads nothing was loaded into
     MemoryManager memoryManager;
     FileSystem fileSystem;
+    Pager pager;
+    IoWorkerPool io;  // Services the processes' I/O rings
+    std::mutex vmLock;  // Page tables, frame allocation and the pager; TLB hits skip it
+    TlbShootdown shootdown;  // What the pager waits for before reusing a frame
     
     // Process management
     std::vector<Process*> processes;
+    std::unordered_map<int, Process*> processIndex;  // PID -> Process
+    std::unordered_map<int, Thread*> threadIndex;    // TID -> Thread
     int nextPid;
     int nextThreadId;
 
-    struct SleepingThread {
-        Thread* thread;
-        int wakeAtTick;
-    };
-    std::vector<SleepingThread> sleepList;
-    int currentTick;
-
   public:
-    Kernel();
+    Kernel(const KernelConfig& config = KernelConfig());
     ~Kernel();
 
     void boot();
     void run();  // Legacy mode
-    void runCycles(int cycles); // Shell mode
-    void executeInstruction(Thread* thread);
+    void runCycles(int cycles); // Shell mode, cycles apply to every CPU
+    // One tick of the thread's program
+    void executeInstruction(Cpu& cpu, Thread* thread);
 
     // Process/Thread API
-    int createProcess(const std::string& name);
+    int createProcess(const std::string& name, size_t pages = DEFAULT_PROCESS_PAGES);
+    // Copy-on-write clone of 'pid' and its live threads. Returns the child PID, -1 if not found.
+    int forkProcess(int pid);
     int spawnThread(int pid, const std::string& name, int priority);
+    // exec: restart each thread of 'pid' at the top of 'program', exited
+    // ones included. Threads blocked on the mutex or I/O are left alone.
+    // Returns the number of threads loaded, -1 if the process is not found,
+    // -2 if the code does not fit in its address space.
+    int loadProgram(int pid, const std::shared_ptr<const Program>& program);
     void listProcesses();
     void listThreads();
     bool killThread(int id);
     bool killProcess(int pid);
+    bool sleepThread(int id, int ticks);
+    bool setNice(int id, int nice);  // -20..19 (clamped); false if no such thread
+
+    // Syscalls, made by the thread currently running on 'cpu'
+    void sysSleep(Cpu& cpu, int ticks);
+    // Asynchronous file I/O between 'path' and the thread's memory at 'vaddr':
+    // the request goes on the process's I/O ring and the thread blocks until
+    // it completes (the result is left in Thread::getIoResult). An 'offset'
+    // of -1 appends. False, without blocking, if the ring is full or the
+    // buffer faults.
+    bool sysRead(Cpu& cpu, const std::string& path, int64_t offset, uint64_t vaddr, size_t len);
+    bool sysWrite(Cpu& cpu, const std::string& path, int64_t offset, uint64_t vaddr, size_t len);
+    // The same on behalf of a ready thread, from the shell
+    bool submitIo(int tid, IoOp op, const std::string& path, int64_t offset, uint64_t vaddr, size_t len);
+
+    // MMU: pointer into RAM for 'vaddr' in the thread's address space, via
+    // the CPU's TLB. nullptr if the access faulted fatally (thread terminated).
+    // Otherwise the frame stays put until endAccess(cpu): other CPUs' pagers
+    // wait for it before evicting.
+    char* translate(Cpu& cpu, Thread* thread, uint64_t vaddr, bool write);
+    void endAccess(Cpu& cpu) { shootdown.leave(cpu.id); }
+
+    // Access a process's memory from the shell (no TLB). Returns false on a fault.
+    bool touchMemory(int pid, uint64_t vaddr, bool write, FaultResult& result, size_t& frame);
     
     // Legacy spawn (creates process with main thread)
     int spawnTask(const std::string& name, int priority);
     
     void showMemory();
+    bool showPageTable(int pid);
+    void showSwap();
+    void setPagerPolicy(PagerPolicy policy);
+    // Replay a reference trace against every replacement policy with 'frames' frames
+    void compareReplacement(const std::vector<PageRef>& trace, size_t frames);
     void showFiles();
+    int syncDisk();  // Dirty blocks written, -1 on error
+    bool checkDisk();
+    void showCpus();
+    // Scheduling class, per-CPU wait percentiles, and each thread's share
+    // of the CPU against its weight
+    void showSched();
+    void showSlabs();
 
     MemoryManager& getMemoryManager() { return memoryManager; }
     FileSystem& getFileSystem() { return fileSystem; }
+    Pager& getPager() { return pager; }
+    int getPriorityLevels() const { return cpus[0]->scheduler.getPriorityLevels(); }
+    int getQuantum() const { return cpus[0]->scheduler.getQuantum(); }
+    void setQuantum(int ticks);
+    SchedPolicy getSchedPolicy() const { return cpus[0]->scheduler.getPolicy(); }
+    void setSchedPolicy(SchedPolicy policy);
+    int getCpuCount() const { return static_cast<int>(cpus.size()); }
+    int getIoWorkerCount() const { return io.getWorkerCount(); }
+    uint64_t getIdleTicks() const;  // Summed over every CPU
+    uint64_t getInstructions() const;  // Likewise
     
 private:
     Process* findProcess(int pid);
+    void registerThread(Process* proc, Thread* thread);
+    void detachThread(Thread* thread);
+    // Hand on the mutexes a dead thread holds and free its allocations
+    void reclaimThread(Scheduler& scheduler, Thread* thread);
+
+    // I/O rings: submission, and completion on the submitting CPU
+    bool queueIo(Cpu* cpu, Thread* thread, IoRequest&& request);
+    void completeIo(Cpu& cpu, IoCompletion& completion);
+    // Copy between a thread's memory and 'buffer', through the CPU's TLB
+    // (nullptr: from the shell). False if the access faulted.
+    bool copyUser(Cpu* cpu, Thread* thread, uint64_t vaddr, char* buffer, size_t len, bool toUser);
+
+    // Per-CPU execution loop and load balancing
+    void runParallel(int cycles);
+    void runCpu(Cpu& cpu, int cycles);
+    // Ticks until the earliest timer of any CPU once all are idle, 1 while
+    // another CPU is busy
+    uint64_t idleSkip(const Cpu& cpu, uint64_t own) const;
+    std::string cpuTag(const Cpu& cpu) const;
+    void balance(Cpu& cpu);
+    bool stealWork(Cpu& cpu);
 };
@@ -0,0 +1,62 @@
+#pragma once
+#include <sstream>
+#include <string>
+
+enum class LogLevel : int {
+    Off = 0,
+    Error = 1,
+    Warn = 2,
+    Info = 3,
+    Debug = 4,  // Per-instruction and per-context-switch events
+    Trace = 5
+};
+
+// Compile-time ceiling: statements above it are removed entirely
+#ifndef MYOS_LOG_LEVEL
+#define MYOS_LOG_LEVEL 5
+#endif
+
+// Leveled kernel log. Each simulated CPU writes fixed-size records into its
+// own lock-free single-producer ring, a long line taking several in a row;
+// while Kernel::runCycles is executing a background thread drains the rings
+// to stdout, otherwise records are drained as soon as they are written so
+// shell output stays in order.
+class Logger {
+  public:
+    // Runtime level. Default (Debug) prints everything the shell always printed.
+    static int level;
+
+    static bool enabled(LogLevel l) {
+        return static_cast<int>(l) <= MYOS_LOG_LEVEL && static_cast<int>(l) <= level;
+    }
+
+    // Allocate one ring per CPU plus one shared by non-CPU host threads
+    static void configure(int numCpus);
+
+    // Route this host thread's records to CPU 'cpu''s ring
+    static void setCpu(int cpu);
+
+    static void write(LogLevel l, const std::string& line);
+
+    // Switch to background draining (and back, flushing everything)
+    static void startAsync();
+    static void stopAsync();
+
+    static const char* levelName(int l);
+    static int parseLevel(const std::string& name);  // -1 if unknown
+};
+
+#define LOG_AT(lvl, expr)                       \
+    do {                                        \
+        if (Logger::enabled(lvl)) {             \
+            std::ostringstream logStream_;      \
+            logStream_ << expr;                 \
+            Logger::write(lvl, logStream_.str()); \
+        }                                       \
+    } while (0)
+
+#define LOG_ERROR(expr) LOG_AT(LogLevel::Error, expr)
+#define LOG_WARN(expr) LOG_AT(LogLevel::Warn, expr)
+#define LOG_INFO(expr) LOG_AT(LogLevel::Info, expr)
+#define LOG_DEBUG(expr) LOG_AT(LogLevel::Debug, expr)
+#define LOG_TRACE(expr) LOG_AT(LogLevel::Trace, expr)
@@ -0,0 +1,37 @@
+#pragma once
+#include <sys/mman.h>
+#include <cstddef>
+#include <new>
+
+// Anonymous private mapping. It starts zero-filled and host pages are only
+// committed once touched, so reserving gigabytes of simulated RAM is cheap.
+class MappedRegion {
+  private:
+    char* base;
+    size_t length;
+
+  public:
+    explicit MappedRegion(size_t bytes) : base(nullptr), length(bytes) {
+        if (length == 0) {
+            return;
+        }
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        base = static_cast<char*>(p);
+    }
+
+    ~MappedRegion() {
+        if (base != nullptr) {
+            munmap(base, length);
+        }
+    }
+
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+
+    char* data() const { return base; }
+    size_t size() const { return length; }
+};
@@ -1,29 +1,55 @@
 #pragma once
-#include <vector>
-#include <list>
+#include <memory>
+#include <string>
 #include <cstddef> // for size_t
+#include "Allocator.hpp"
 
-struct MemoryBlock {
-    size_t offset;
-    size_t size;
-    bool isFree;
+enum class AllocPolicy {
+    FirstFit,
+    Segregated,
+    Buddy
+};
+
+struct MemoryStats {
+    size_t capacity;
+    size_t usedBytes;    // Including size-class / power-of-two rounding
+    size_t freeBytes;
+    size_t largestFree;  // Biggest single allocation that can still succeed
+    size_t usedBlocks;
+    size_t freeBlocks;
 };
 
 class MemoryManager {
 private:
-    std::vector<char> ram;
-    std::list<MemoryBlock> memoryList;
-    const size_t MAX_MEMORY = 1024; // 1 KB Simulated RAM
+    MappedRegion ram;  // Simulated RAM, zero-filled on first touch
+    std::unique_ptr<Allocator> allocator;
+    AllocPolicy policy;
 
 public:
-    MemoryManager();
+    static constexpr size_t DEFAULT_MEMORY = 1024; // 1 KB Simulated RAM unless booted with --mem
+
+    MemoryManager(AllocPolicy policy = AllocPolicy::FirstFit, size_t capacity = DEFAULT_MEMORY);
 
     // Allocate 'size' bytes. Returns pointer to memory or nullptr if failed.
     void* allocate(size_t size);
 
+    // Same, without the failure warning, for callers that have a fallback
+    void* tryAllocate(size_t size);
+
     // Free memory pointed to by 'ptr'.
     void deallocate(void* ptr);
 
     // Debug: Print current memory layout
     void printMemoryMap();
+
+    // Translate between RAM offsets and pointers
+    char* at(size_t offset) const { return ram.data() + offset; }
+    size_t offsetOf(const void* ptr) const { return static_cast<const char*>(ptr) - ram.data(); }
+
+    MemoryStats getStats() const;
+    AllocPolicy getPolicy() const { return policy; }
+    size_t getCapacity() const { return ram.size(); }
+
+    static const char* policyName(AllocPolicy policy);
+    static bool parsePolicy(const std::string& name, AllocPolicy& policy);
 };
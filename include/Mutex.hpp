@@ -1,27 +1,82 @@
 #ifndef MUTEX_HPP
 #define MUTEX_HPP
 
-#include <queue>
+#include <cstdint>
+#include <mutex>
 #include "Thread.hpp"
+#include "ThreadQueue.hpp"
 #include "Scheduler.hpp"
 
+enum class LockResult {
+    Acquired,
+    Spinning,  // Still running: retry on the next tick
+    Blocked    // Woken once ownership has been handed over
+};
+
+struct MutexStats {
+    uint64_t acquisitions;
+    uint64_t contentions;   // Acquisitions that found the mutex held
+    uint64_t spinAcquires;  // ...of which were won by spinning
+    uint64_t blocks;
+    uint64_t boosts;        // Owners raised to a waiter's priority
+};
+
+// Kernel mutex for simulated threads. Waiters queue by priority (FIFO among
+// equals) and ownership is handed straight to the first of them.
+//
+// Priority inheritance: while a thread waits, the owner runs at the
+// waiter's priority if that is higher, and so on down a chain of owners
+// blocked on other mutexes, so a medium-priority thread can't keep a
+// high-priority one waiting by starving the low-priority owner. Releasing
+// drops the owner back to the highest priority its remaining waiters are
+// owed.
+//
+// Adaptive spinning: a contender whose owner is running on another CPU
+// keeps its own CPU and retries on the next tick instead of blocking, for at
+// most a bound that follows how long recent spinners had to wait.
+//
+// Inheritance chains cross mutexes and CPUs, so every mutex shares one host lock.
 class Mutex {
 private:
-    bool locked;
     Thread* owner;
-    std::queue<Thread*> waitingQueue;
+    ThreadQueue waiters;
+    Mutex* nextHeld;  // In the owner's list of held mutexes
+    bool inherit;
+    bool spin;
+    int spinAverage;  // Ticks recent spinners waited, x8
+    MutexStats stats;
+
+    static std::mutex hostLock;
+
+    void take(Thread* thread);
+    void release(Thread* holder, Scheduler& scheduler);
+    void boost(Scheduler& scheduler, int priority);
+    int spinLimit() const;
+    void adapt(int ticks);
+    static int owedPriority(const Thread* thread);
 
 public:
-    Mutex();
+    static const int MIN_SPIN_TICKS = 2;
+    static const int MAX_SPIN_TICKS = 32;
+
+    explicit Mutex(bool priorityInheritance = true, bool adaptiveSpin = true);
 
-    // Attempt to lock the mutex. 
-    // If successful, returns true.
-    // If held by another, blocks the current thread via scheduler and returns false (should yield).
-    bool lock(Scheduler& scheduler);
+    // Acquire for the scheduler's current thread. A Blocked thread owns the
+    // mutex when it next runs.
+    LockResult lock(Scheduler& scheduler);
 
-    // Release the mutex.
-    // If threads are waiting, wakes up the next one.
+    // Release; the first waiter, if any, becomes the owner and is woken
     void unlock(Scheduler& scheduler);
+
+    // Hand on every mutex 'thread' holds (it is being killed)
+    static void releaseAll(Thread* thread, Scheduler& scheduler);
+
+    // Take a killed 'thread' out of the wait queue it is blocked in, and
+    // drop whatever its owners inherited from it. False if it was not waiting.
+    static bool cancelWait(Thread* thread, Scheduler& scheduler);
+
+    Thread* getOwner() const { return owner; }
+    MutexStats getStats() const { return stats; }
 };
 
 #endif
@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MappedRegion.hpp"
+#include "Replacement.hpp"
+
+class AddressSpace;
+class MemoryManager;
+class FileSystem;
+class TlbShootdown;
+
+struct PagerStats {
+    uint64_t faults;       // Every page fault that mapped a frame
+    uint64_t majorFaults;  // ...of which read the page back from swap
+    uint64_t cowFaults;    // ...of which copied a shared page on write
+    uint64_t pageOuts;     // Dirty pages written to swap
+    uint64_t evictions;
+    size_t frames;         // Frames holding a page (shared ones count once)
+    size_t residentPages;  // Mappings of those frames, summed over processes
+    size_t swappedPages;   // Paged out, not resident
+    size_t swapUsed;       // Slots in use, including clean copies of resident pages
+    size_t swapSlots;
+};
+
+// Frame allocation and page replacement for every address space. When RAM
+// is full a victim picked by the replacement policy is written to the swap
+// region of the disk image (if dirty) and its frame reused. All calls except
+// the reference recorder are serialized by the caller (Kernel::vmLock).
+//
+// Frames and swap slots are reference counted so forked address spaces can
+// share them copy-on-write. Each resident frame has one entry in the policy,
+// under its owner's (asid, vpn); a fork family (every address space forked
+// from the same ancestor) maps a shared frame at the same vpn, so the
+// mappers are found by scanning the family rather than a per-page list.
+class Pager : private ReferenceBits {
+  public:
+    static constexpr size_t NONE = SIZE_MAX;
+    static constexpr size_t TRACE_LIMIT = 1 << 20;  // Recorded references
+    static constexpr size_t DEFAULT_SWAP = 4096;    // Bytes of disk image
+
+    Pager(MemoryManager& memory, FileSystem& disk, PagerPolicy policy, size_t swapBytes);
+
+    // CPUs to wait for before an evicted frame is read or reused (none: no
+    // CPU caches translations, as in the benchmarks)
+    void setShootdown(TlbShootdown* s) { shootdown = s; }
+
+    // Join (or leave) the address space's fork family
+    void attach(AddressSpace* space);
+    void detach(AddressSpace* space);
+
+    // Frame for page 'vpn' of 'asid', evicting while RAM is full. NONE if
+    // nothing can be evicted.
+    size_t allocateFrame(int asid, uint64_t vpn);
+    void discardFrame(size_t frame);  // An allocated frame that was never mapped
+    // 'frame' now privately holds the page; 'copied' for a copy-on-write break
+    void mapped(int asid, uint64_t vpn, size_t frame, bool copied = false);
+    void referenced(uint64_t vpn, size_t frame);  // Page walk on a resident page
+    // Drop one mapping of 'frame', freeing it with the last one
+    void unmap(int asid, uint64_t vpn, size_t frame);
+    char* frameData(size_t frame) const;
+
+    // Copy-on-write sharing
+    void shareFrame(size_t frame) { info(frame).refs++; }
+    bool isShared(size_t frame) const { return info(frame).refs > 1; }
+    void shareSlot(uint32_t slot) { slotRefs[slot]++; }
+
+    bool swapIn(int asid, uint64_t vpn, uint32_t slot, size_t frame);
+    void freeSlot(uint32_t slot);
+
+    // Switch policies, seeding the new one with the current resident set
+    void setPolicy(PagerPolicy policy);
+    PagerPolicy getPolicy() const { return policyId; }
+    PagerStats getStats() const;
+
+    // Reference recording for trace replay. While off, record() is one branch.
+    void startRecording();
+    void stopRecording() { recording.store(false, std::memory_order_relaxed); }
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+    void record(int asid, uint64_t vpn, bool write) {
+        if (isRecording()) {
+            append(asid, vpn, write);
+        }
+    }
+    const std::vector<PageRef>& getTrace() const { return trace; }
+
+    // Traces on the host file system, one "asid vpn r|w" per line
+    bool saveTrace(const std::string& path) const;
+    static bool loadTrace(const std::string& path, std::vector<PageRef>& out);
+
+  private:
+    struct FrameInfo {
+        uint32_t refs;  // Page table entries mapping the frame
+        int32_t owner;  // ASID whose page represents the frame in the policy
+    };
+
+    MemoryManager& memory;
+    FileSystem& disk;
+    PagerPolicy policyId;
+    std::unique_ptr<ReplacementPolicy> policy;
+    MappedRegion frameTable;  // FrameInfo per 16-byte unit of RAM, indexed by frame offset
+    std::unordered_map<int, AddressSpace*> spaces;                 // By ASID
+    std::unordered_map<int, std::vector<AddressSpace*>> families;  // By family ID
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> slotRefs;
+    size_t swapSlots;
+    PagerStats counters;
+    TlbShootdown* shootdown;
+
+    std::atomic<bool> recording;
+    std::mutex traceLock;  // CPUs record TLB hits concurrently
+    std::vector<PageRef> trace;
+
+    FrameInfo& info(size_t frame) const {
+        return reinterpret_cast<FrameInfo*>(frameTable.data())[frame / 16];
+    }
+    // Address spaces in 'family' mapping 'frame' at 'vpn'
+    void mappers(int family, uint64_t vpn, size_t frame, std::vector<AddressSpace*>& out) const;
+    void release(size_t frame);
+    bool evictOne(uint64_t incoming);
+    bool evict(AddressSpace& space, uint64_t vpn);
+    void append(int asid, uint64_t vpn, bool write);
+    bool testAndClear(uint64_t page) override;
+};
@@ -1,33 +1,44 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <cstddef>
+#include <memory>
 
 class Thread;  // Forward declaration
+class SlabCache;
+class AddressSpace;
+class IoRing;
 
 class Process {
 private:
     int pid;
     std::string name;
     std::vector<Thread*> threads;
-    int memoryStart;  // Start of allocated memory region
-    int memorySize;   // Size of allocated memory
+    std::unique_ptr<AddressSpace> addressSpace;
+    std::shared_ptr<IoRing> ioRing;  // Shared with I/O workers still servicing it
 
 public:
     Process(int pid, const std::string& name);
     ~Process();
 
+    // new/delete are served from a per-type slab cache
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+    static SlabCache& cache();
+
     // Thread management
     void addThread(Thread* thread);
     bool removeThread(int threadId);
+    bool removeThread(Thread* thread);
 
     // Getters
     int getPid() const;
     std::string getName() const;
     const std::vector<Thread*>& getThreads() const;
     int getThreadCount() const;
-    int getMemoryStart() const;
-    int getMemorySize() const;
+    AddressSpace* getAddressSpace() const;
+    const std::shared_ptr<IoRing>& getIoRing() const { return ioRing; }
 
-    // Memory allocation (set by Kernel)
-    void setMemory(int start, int size);
+    // Virtual memory (set by Kernel, owned by the process)
+    void setAddressSpace(AddressSpace* space);
 };
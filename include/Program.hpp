@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class OpCode : uint8_t {
+    Compute,  // Spend 'arg' ticks on the CPU
+    Lock,     // Acquire the kernel's shared mutex
+    Unlock,
+    Sleep,    // Give up the CPU for 'arg' ticks
+    Alloc,    // Allocate 'arg' bytes of kernel memory
+    Free,     // Free the most recent allocation still held
+    Read,     // 'len' bytes of file 'path' at 'offset' into memory at 'arg'
+    Write,    // 'len' bytes of memory at 'arg' to file 'path' at 'offset' (-1 = append)
+    Exit
+};
+
+// A decoded instruction: operands are parsed once, at load time, so the
+// interpreter only switches on 'op'
+struct Instruction {
+    OpCode op;
+    uint32_t path;   // Read/Write: index into the program's file names
+    uint64_t arg;
+    uint64_t len;
+    int64_t offset;
+};
+
+// A thread's code, shared by every thread running it. Programs are text,
+// one instruction per line, '#' starting a comment:
+//
+//   compute <ticks>     lock     unlock     sleep <ticks>
+//   alloc <bytes>       free     exit
+//   read <file> <address> <bytes> [offset]
+//   write <file> <address> <bytes> [offset]
+//
+// Numbers may be given in hex. A program that does not end in 'exit' gets
+// one appended, so execution never runs off the end.
+class Program {
+  public:
+    // nullptr if the file cannot be read or does not parse (logged with the line)
+    static std::shared_ptr<const Program> load(const std::string& path);
+    static std::shared_ptr<const Program> parse(const std::string& name, std::istream& in);
+
+    const Instruction& at(int pc) const { return code[pc]; }
+    const std::string& pathOf(const Instruction& instruction) const { return paths[instruction.path]; }
+    size_t size() const { return code.size(); }
+    const std::string& getName() const { return name; }
+
+    static const char* mnemonic(OpCode op);
+
+  private:
+    std::string name;
+    std::vector<Instruction> code;
+    std::vector<std::string> paths;
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class PagerPolicy {
+    Fifo,
+    Clock,
+    Lru,  // LRU approximation: 8-bit aging counters over the reference bits
+    Arc
+};
+
+// A resident page, identified across address spaces
+inline uint64_t pageKey(int asid, uint64_t vpn) { return (static_cast<uint64_t>(asid) << 32) | vpn; }
+inline int pageAsid(uint64_t page) { return static_cast<int>(page >> 32); }
+inline uint64_t pageVpn(uint64_t page) { return page & 0xffffffffu; }
+
+// One recorded page reference
+struct PageRef {
+    uint64_t page;
+    bool write;
+};
+
+// Hardware-style reference bits the policy may sample (PTE_ACCESSED in the
+// kernel, a flag per page in trace replay)
+class ReferenceBits {
+  public:
+    virtual ~ReferenceBits() {}
+    virtual bool testAndClear(uint64_t page) = 0;
+};
+
+// Chooses which resident page to evict. The pager tells it about every page
+// that becomes resident and every reference it observes; victim() removes
+// the page it returns.
+class ReplacementPolicy {
+  public:
+    virtual ~ReplacementPolicy() {}
+
+    virtual void inserted(uint64_t page) = 0;  // Faulted in
+    virtual void referenced(uint64_t) {}       // Seen again while resident
+    virtual void removed(uint64_t page) = 0;   // Freed without eviction (process exit)
+
+    // Pick and forget a resident page. 'incoming' is the page being faulted in.
+    // Only called while size() > 0.
+    virtual uint64_t victim(ReferenceBits& bits, uint64_t incoming) = 0;
+
+    virtual size_t size() const = 0;
+    virtual const char* name() const = 0;
+};
+
+class FifoPolicy : public ReplacementPolicy {
+  private:
+    std::list<uint64_t> queue;
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> where;
+
+  public:
+    void inserted(uint64_t page) override;
+    void removed(uint64_t page) override;
+    uint64_t victim(ReferenceBits& bits, uint64_t incoming) override;
+    size_t size() const override { return queue.size(); }
+    const char* name() const override { return "fifo"; }
+};
+
+// Second chance: the hand skips (and clears) referenced pages
+class ClockPolicy : public ReplacementPolicy {
+  private:
+    std::list<uint64_t> ring;
+    std::list<uint64_t>::iterator hand;
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> where;
+
+  public:
+    ClockPolicy() : hand(ring.end()) {}
+    void inserted(uint64_t page) override;
+    void removed(uint64_t page) override;
+    uint64_t victim(ReferenceBits& bits, uint64_t incoming) override;
+    size_t size() const override { return ring.size(); }
+    const char* name() const override { return "clock"; }
+};
+
+// Aging: a sweep shifts every page's reference bit into an 8-bit counter
+// and queues the 1/16th with the lowest counters (oldest first on ties) as
+// the next victims, so the O(resident pages) sweep is amortized over many
+// evictions
+class AgingPolicy : public ReplacementPolicy {
+  private:
+    struct Entry {
+        uint64_t page;
+        uint64_t loaded;  // Fault-in order
+        uint8_t age;
+    };
+    std::vector<Entry> pages;
+    std::unordered_map<uint64_t, size_t> where;  // Index into 'pages'
+    std::vector<uint64_t> candidates;            // Next victims, best first
+    size_t nextCandidate;
+    uint64_t loads;
+
+    void erase(size_t index);
+    void sweep(ReferenceBits& bits);
+
+  public:
+    AgingPolicy() : nextCandidate(0), loads(0) {}
+    void inserted(uint64_t page) override;
+    void removed(uint64_t page) override;
+    uint64_t victim(ReferenceBits& bits, uint64_t incoming) override;
+    size_t size() const override { return pages.size(); }
+    const char* name() const override { return "lru"; }
+};
+
+// Adaptive Replacement Cache (Megiddo & Modha): recency (T1) and frequency
+// (T2) lists plus ghost lists (B1, B2) of recently evicted pages that steer
+// the target size 'p' of T1. Frame count is not fixed here, so the cache
+// size 'c' is the largest resident set seen so far.
+class ArcPolicy : public ReplacementPolicy {
+  private:
+    enum ListId { T1, T2, B1, B2, LISTS };
+    struct Slot {
+        ListId list;
+        std::list<uint64_t>::iterator it;
+    };
+    std::list<uint64_t> lists[LISTS];  // Front = MRU
+    std::unordered_map<uint64_t, Slot> where;
+    size_t c;
+    size_t p;
+
+    void moveTo(uint64_t page, ListId list);
+    void dropLru(ListId list);
+
+  public:
+    ArcPolicy() : c(0), p(0) {}
+    void inserted(uint64_t page) override;
+    void referenced(uint64_t page) override;
+    void removed(uint64_t page) override;
+    uint64_t victim(ReferenceBits& bits, uint64_t incoming) override;
+    size_t size() const override { return lists[T1].size() + lists[T2].size(); }
+    const char* name() const override { return "arc"; }
+};
+
+std::unique_ptr<ReplacementPolicy> makeReplacementPolicy(PagerPolicy policy);
+const char* pagerPolicyName(PagerPolicy policy);
+bool parsePagerPolicy(const std::string& name, PagerPolicy& policy);
+
+struct ReplayStats {
+    uint64_t references;
+    uint64_t faults;    // Demand-zero and swap-in
+    uint64_t pageIns;   // Faults that read the page back from swap
+    uint64_t pageOuts;  // Evictions of dirty pages
+};
+
+// Run a recorded reference string through 'policy' with 'frames' page
+// frames, modelling the kernel's dirty/swap-copy rules
+ReplayStats replayTrace(PagerPolicy policy, const std::vector<PageRef>& trace, size_t frames);
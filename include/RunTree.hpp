@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "Thread.hpp"
+
+// Red-black tree of ready threads ordered by virtual runtime (ties by TID),
+// for the fair scheduling class. Intrusive like ThreadQueue: the links live
+// in the Thread, so insert and remove never allocate. The leftmost thread is
+// cached, so the next thread to run is found in O(1); insert and remove are
+// O(log n).
+class RunTree {
+  public:
+    RunTree() : root(nullptr), leftmost(nullptr), count(0) {}
+
+    RunTree(const RunTree&) = delete;
+    RunTree& operator=(const RunTree&) = delete;
+
+    void insert(Thread* thread);
+    void remove(Thread* thread);
+
+    Thread* first() const { return leftmost; }  // Smallest virtual runtime
+    Thread* last() const;                        // Largest, O(log n)
+    static Thread* next(const Thread* thread);   // In-order successor
+
+    bool contains(const Thread* thread) const { return thread->runTree == this; }
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    template <typename F>
+    void forEach(F f) const {
+        for (Thread* t = leftmost; t != nullptr; t = next(t)) {
+            f(t);
+        }
+    }
+
+  private:
+    Thread* root;
+    Thread* leftmost;
+    size_t count;
+
+    static bool before(const Thread* a, const Thread* b) {
+        return a->vruntime < b->vruntime || (a->vruntime == b->vruntime && a->id < b->id);
+    }
+    static bool isRed(const Thread* t) { return t != nullptr && t->rbRed; }
+
+    void rotateLeft(Thread* x);
+    void rotateRight(Thread* x);
+    void replace(Thread* old, Thread* with);  // In old's parent
+    void insertFixup(Thread* z);
+    void removeFixup(Thread* x, Thread* parent);
+};
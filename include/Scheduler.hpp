@@ -1,40 +1,180 @@
 #pragma once
 #include <vector>
-#include <queue> 
 #include <memory>
+#include <atomic>
 #include <algorithm>
+#include <cstdint>
+#include <string>
 #include "Thread.hpp"
+#include "ThreadQueue.hpp"
+#include "RunTree.hpp"
+
+// Number of priority levels when none is configured (0 = highest)
+const int DEFAULT_PRIORITY_LEVELS = 64;
+// Two-level bitmap: 64 words of 64 bits each
+const int MAX_PRIORITY_LEVELS = 64 * 64;
+// Ticks a thread keeps the CPU before others at its level get a turn
+const int DEFAULT_QUANTUM = 10;
+
+enum class SchedPolicy {
+    Priority,  // Most urgent level first, round robin within a level
+    Fair       // Least weighted virtual runtime first (CFS-style); levels ignored
+};
+
+// Ticks threads spent ready before getting the CPU: exact below 16, then 8
+// buckets per power of two, so percentiles are within 12.5%
+class WaitHistogram {
+  public:
+    static const int BUCKETS = 16 + 60 * 8;
+
+    WaitHistogram() : counts(), total(0), largest(0) {}
+    void record(uint64_t ticks);
+    void merge(const WaitHistogram& other);
+    uint64_t percentile(double p) const;  // 'p' in percent; lower bound of its bucket
+    uint64_t count() const { return total; }
+    uint64_t max() const { return largest; }
+
+  private:
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    uint64_t largest;
+};
 
 class Scheduler {
-  private: 
-    // Multi-Level Queues
-    std::queue<Thread*> readyQueueHigh; // Priority 0
-    std::queue<Thread*> readyQueueLow;  // Priority 1
-    
+  private:
+    SchedPolicy policy;
+
+    // Multi-Level Queues, one intrusive FIFO per priority level
+    int numLevels;
+    std::unique_ptr<ThreadQueue[]> readyQueues;
+    size_t readyCount;
+
+    // Ready bitmap: bit N of readyBitmap[N / 64] is set while level N is non-empty.
+    // readySummary has bit W set while readyBitmap[W] is non-zero.
+    std::vector<uint64_t> readyBitmap;
+    uint64_t readySummary;
+
+    // Fair class: ready threads by virtual runtime. minVruntime only moves
+    // forward; woken and new threads are placed just behind it. Read by
+    // other CPUs adopting threads taken from here.
+    RunTree runTree;
+    std::atomic<uint64_t> minVruntime;
+    bool resched;  // A thread woken since the current one's slice began should preempt it
+
     Thread* currentThread;
+    int cpuId;  // CPU this run queue belongs to
+    bool idle;  // Already reported that nothing is ready
 
-  public: 
-    Scheduler();
+    int quantum;
+    int sliceLeft;  // Ticks left in the current thread's slice after this one
+    uint64_t contextSwitches;
+    uint64_t clock;  // schedule() calls so far: this CPU's ticks
+    WaitHistogram waits;
 
-    // Add a new thread to the scheduler 
+    // Every CPU's scheduler, by CPU id (empty on a uniprocessor)
+    std::vector<Scheduler*> peers;
+    // Threads other CPUs or host threads posted a wakeup or priority change
+    // for, applied by schedule() and yield(). A lock-free stack linked
+    // through the threads, newest first: posting is one CAS and never
+    // allocates, and the owner takes the whole batch with one exchange.
+    // Repeated posts for a thread coalesce into its pending bits.
+    static const unsigned POST_WAKE = 1;
+    static const unsigned POST_REFILE = 2;
+    std::atomic<Thread*> inbox;
+
+    void markReady(int level);
+    void markEmpty(int level);
+    int topReadyLevel() const;  // Most urgent non-empty level, numLevels if none
+    void enqueue(Thread* thread);  // addThread without the fair class's placement
+    void unqueue(Thread* thread);  // Out of its ready queue
+    void refile(Thread* thread);   // Into the ready queue of its current priority, if queued
+    bool preempts() const;         // A ready thread should take the CPU from the current one
+    void updateMinVruntime();
+    void post(Thread* thread, unsigned what);
+    void drainInbox();  // Oldest first
+
+  public:
+    Scheduler(int levels = DEFAULT_PRIORITY_LEVELS, int cpuId = 0);
+
+    // Virtual runtime of one tick at nice 0; other nice values accrue it
+    // faster or slower, in inverse proportion to their weight
+    static const uint64_t VRUNTIME_TICK = uint64_t(1) << 20;
+    static const int NICE_0_WEIGHT = 1024;
+    static int niceWeight(int nice);  // Linux's table: each step is ~10% of CPU
+    static const char* policyName(SchedPolicy policy);
+    static bool parsePolicy(const std::string& name, SchedPolicy& policy);
+
+    // Between runs: ready threads move to the new class's run queue
+    void setPolicy(SchedPolicy p);
+    SchedPolicy getPolicy() const { return policy; }
+
+    // Add a new thread to the scheduler
     void addThread(Thread* thread);
-    
+
+    // Dequeue the highest-priority ready thread in O(1) (nullptr if none);
+    // under the fair class, the one with the least virtual runtime
+    Thread* pickNext();
+
+    // Dequeue the most recently queued thread of the lowest non-empty level
+    // (handed to other CPUs by the load balancer, nullptr if none); under
+    // the fair class, the one with the most virtual runtime
+    Thread* takeLowest();
+    // Queue a thread that 'from' gave up through takeLowest (this scheduler,
+    // or another CPU's). Under the fair class it keeps its virtual runtime,
+    // or its distance from the minimum if it changes CPU.
+    void adopt(Thread* thread, const Scheduler& from);
 
     // The Core Function: Switch to the next thread
     void yield();
 
+    // Once per tick: the current thread keeps the CPU until its quantum is
+    // used up, it blocks, sleeps or exits, or a more urgent thread is ready
+    // (fair class: a thread woken having run less by over a tick); then yield()
+    void schedule();
+    // The next schedule() will yield() (whoever is current stops running)
+    bool yieldsNext() const;
+    void setQuantum(int ticks) { quantum = std::max(1, ticks); }
+    int getQuantum() const { return quantum; }
+
     // Helper to see who is running
     Thread* getCurrentThread();
 
     // Block the current thread (transition to BLOCKED state)
     void blockCurrentThread();
 
-    // Wake up a blocked thread (transition to READY and add to queue)
+    // Wake up a blocked or sleeping thread (transition to READY and add to queue)
     void wakeup(Thread* thread);
 
-    // Get all threads (for ps command)
-    std::vector<Thread*> getAllThreads();
+    // Wake a thread, or change its effective priority, from any CPU: done
+    // here if it belongs to this scheduler, else posted to the one it does
+    void setPeers(const std::vector<Scheduler*>& all) { peers = all; }
+    void wakeupAnywhere(Thread* thread);
+    void setPriority(Thread* thread, int priority);
+    // Wake a thread of this scheduler from any host thread (an I/O worker,
+    // a timer); it is queued when this CPU next schedules
+    void postWakeup(Thread* thread) { post(thread, POST_WAKE); }
+    void cancelPosted(Thread* thread);  // Between runs, for kill
+    bool hasPosted() const { return inbox.load(std::memory_order_acquire) != nullptr; }
+
+    // Visit the running thread, then every ready thread in priority order (for ps command)
+    template <typename F>
+    void forEachThread(F f) const {
+        if (currentThread) {
+            f(currentThread);
+        }
+        for (int level = 0; level < numLevels; ++level) {
+            readyQueues[level].forEach(f);
+        }
+        runTree.forEach(f);
+    }
+
+    // Remove a thread from the CPU or its ready queue (for kill command):
+    // O(1), O(log n) under the fair class
+    bool removeThread(Thread* thread);
 
-    // Remove a thread by ID (for kill command)
-    bool removeThread(int id);
+    int getPriorityLevels() const { return numLevels; }
+    size_t getReadyCount() const { return readyCount; }
+    uint64_t getContextSwitches() const { return contextSwitches; }
+    uint64_t getMinVruntime() const { return minVruntime.load(std::memory_order_relaxed); }
+    const WaitHistogram& getWaits() const { return waits; }
 };
@@ -13,6 +13,7 @@ private:
     std::vector<std::string> tokenize(const std::string& input);
     void printPrompt();
     void executeCommand(const std::vector<std::string>& tokens);
+    int parsePriority(const std::string& arg);
 
     // Command handlers
     void cmdSpawn(const std::vector<std::string>& args);
@@ -21,8 +22,30 @@ private:
     void cmdPs();
     void cmdProcs();
     void cmdKill(const std::vector<std::string>& args);
-    void cmdMem();
+    void cmdKillProcess(const std::vector<std::string>& args);
+    void cmdSleep(const std::vector<std::string>& args);
+    void cmdNice(const std::vector<std::string>& args);
+    void cmdMem(const std::vector<std::string>& args);
+    void cmdTouch(const std::vector<std::string>& args);
+    void cmdAio(const std::vector<std::string>& args);
+    void cmdLoad(const std::vector<std::string>& args);
+    void cmdSwap(const std::vector<std::string>& args);
     void cmdFiles();
+    void cmdSync();
+    void cmdFsck();
+    void cmdWrite(const std::vector<std::string>& args);
+    void cmdCat(const std::vector<std::string>& args);
+    void cmdRm(const std::vector<std::string>& args);
+    void cmdTruncate(const std::vector<std::string>& args);
+    void cmdMkdir(const std::vector<std::string>& args);
+    void cmdRmdir(const std::vector<std::string>& args);
+    void cmdLs(const std::vector<std::string>& args);
+    void cmdCpus();
+    void cmdQuantum(const std::vector<std::string>& args);
+    void cmdSched(const std::vector<std::string>& args);
+    void cmdSlabs();
+    void cmdLog(const std::vector<std::string>& args);
+    void cmdTrace(const std::vector<std::string>& args);
     void cmdHelp();
     void cmdRun(const std::vector<std::string>& args);
 
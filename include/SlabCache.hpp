@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+struct SlabStats {
+    const char* name;
+    size_t objectSize;   // Slot size, rounded up to a cache line
+    size_t slabs;
+    size_t capacity;     // Slots across all slabs
+    size_t inUse;
+    size_t depotFree;    // Free slots in the shared depot (not in magazines)
+    size_t allocs;
+    size_t depotTrips;   // Magazine refills and flushes that took the lock
+};
+
+// Object cache for one fixed-size kernel type (Bonwick-style slab allocator
+// with magazines). Slots are carved from 64-byte-aligned slabs and never go
+// back to the host heap. Each host thread, and so each simulated CPU, keeps
+// a small magazine of free slots and only takes the depot lock to refill or
+// flush half a magazine at a time.
+class SlabCache {
+  public:
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr size_t MAGAZINE_SIZE = 32;
+    // Caches with magazines; any created beyond these go to the depot on
+    // every allocation and release
+    static constexpr int MAX_CACHES = 8;
+
+    SlabCache(const char* name, size_t objectSize, size_t objectsPerSlab = 64);
+    ~SlabCache();
+
+    SlabCache(const SlabCache&) = delete;
+    SlabCache& operator=(const SlabCache&) = delete;
+
+    void* allocate();
+    void release(void* ptr);
+
+    SlabStats stats() const;
+
+    // Every cache created so far, for the 'slabs' shell command
+    static std::vector<SlabCache*>& all();
+
+  private:
+    struct Magazine {
+        void* slots[MAGAZINE_SIZE];
+        size_t count = 0;
+    };
+
+    const char* name;
+    size_t slotSize;
+    size_t perSlab;
+    int index;  // Into each thread's magazine set, -1 past MAX_CACHES
+
+    mutable std::mutex depotLock;
+    void* depot;  // Intrusive free list through the slots themselves
+    size_t depotCount;
+    std::vector<void*> slabs;
+
+    std::atomic<size_t> allocs;
+    std::atomic<size_t> frees;
+    std::atomic<size_t> depotTrips;
+
+    Magazine& magazine();
+    void* allocateFromDepot();
+    void releaseToDepot(void* ptr);
+    void refill(Magazine& mag);
+    void flush(Magazine& mag, size_t keep);
+    void grow();
+
+    friend struct MagazineSet;
+};
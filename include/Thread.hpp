@@ -1,10 +1,30 @@
 #pragma once 
 #include <string> 
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Display label for a priority level (0 and 1 keep their HIGH/LOW names)
+inline std::string priorityLabel(int priority) {
+  if (priority == 0) return "HIGH";
+  if (priority == 1) return "LOW";
+  return "P" + std::to_string(priority);
+}
+
+class ThreadQueue;
+class RunTree;
+class SlabCache;
+class AddressSpace;
+class Mutex;
+class Program;
 
 enum class ThreadState {
   READY,
   RUNNING,
   BLOCKED,
+  SLEEPING,
   TERMINATED
 };
 
@@ -13,23 +33,100 @@ class Thread {
     int id;                 // Thread ID (TID)
     int parentPid;          // Parent Process ID
     std::string name;       // Debug name  
-    ThreadState state;      // Current status 
+    // Read by other CPUs (a mutex contender checks whether the owner is running)
+    std::atomic<ThreadState> state;
     int programCounter;     // Simulated Instruction Pointer
-    int priority;           // Priority (0=High, 1=Low) 
+    std::shared_ptr<const Program> program;  // Code it runs
+    uint64_t opTicks;       // Ticks spent so far in the current instruction
+    std::vector<size_t> allocations;  // RAM offsets from 'alloc', most recent last
+    std::atomic<int> priority;  // Effective level (0=Highest): basePriority, or higher while inheriting
+    int basePriority;           // Level it was created with
+    // CPU whose run queue last held this thread; other CPUs read it to
+    // decide where to post a wakeup or priority change
+    std::atomic<int> cpu;
+    uint64_t wakeTick;      // Deadline while SLEEPING
+    int ioResult;           // Bytes moved by the last read/write syscall, -1 on error
+    uint64_t runTicks;      // Ticks spent executing
+    uint64_t slices;        // Times it was given the CPU
+    int nice;               // -20..19, weights its share under the fair class
+    uint64_t readySince;    // Scheduler clock when it last became ready
+    uint64_t waitTicks;     // Ticks spent ready but not running
+    AddressSpace* addressSpace;  // Owned by the parent Process
+
+    // Mutexes held and waited for, kept by Mutex under its lock
+    friend class Mutex;
+    Mutex* heldMutexes;  // Linked through Mutex::nextHeld
+    Mutex* waitingFor;
+    int spinTicks;       // Spent spinning on the mutex it is acquiring
+
+    // Intrusive links for whichever ThreadQueue currently holds this thread
+    friend class ThreadQueue;
+    ThreadQueue* queue;
+    Thread* queuePrev;
+    Thread* queueNext;
+
+    // Node in whichever RunTree (fair class) currently holds this thread
+    friend class RunTree;
+    RunTree* runTree;
+    Thread* rbParent;
+    Thread* rbLeft;
+    Thread* rbRight;
+    bool rbRed;
+    uint64_t vruntime;  // Weighted ticks run; the tree's key
+
+    // Link in the wakeup inbox of the scheduler it was posted to, and what
+    // is pending for it there (Scheduler::POST_* bits, 0 while in none)
+    friend class Scheduler;
+    Thread* inboxNext;
+    std::atomic<unsigned> posted;
 
   public:
     Thread(int id, int parentPid, const std::string& name, int priority = 1);
 
+    // new/delete are served from a per-type slab cache
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+    static SlabCache& cache();
+
     // Getters
     int getId() const;
     int getParentPid() const;
     std::string getName() const;
     ThreadState getState() const;
     int getProgramCounter() const; 
+    const std::shared_ptr<const Program>& getProgram() const { return program; }
+    uint64_t getOpTicks() const { return opTicks; }
+    std::vector<size_t>& getAllocations() { return allocations; }
     int getPriority() const; 
+    int getBasePriority() const { return basePriority; }
+    ThreadQueue* getQueue() const { return queue; }
+    int getCpu() const { return cpu.load(std::memory_order_acquire); }
+    uint64_t getWakeTick() const { return wakeTick; }
+    int getIoResult() const { return ioResult; }
+    uint64_t getRunTicks() const { return runTicks; }
+    uint64_t getSlices() const { return slices; }
+    int getNice() const { return nice; }
+    uint64_t getReadySince() const { return readySince; }
+    uint64_t getWaitTicks() const { return waitTicks; }
+    RunTree* getRunTree() const { return runTree; }
+    uint64_t getVruntime() const { return vruntime; }
+    AddressSpace* getAddressSpace() const { return addressSpace; }
 
     // Setters / Control 
     void setState(ThreadState s);
+    void setPriority(int p) { priority.store(p, std::memory_order_relaxed); }  // Effective only
     void setProgramCounter(int pc);
     void incrementProgramCounter();
+    void setProgram(const std::shared_ptr<const Program>& code) { program = code; }
+    void setOpTicks(uint64_t ticks) { opTicks = ticks; }
+    void setCpu(int c) { cpu.store(c, std::memory_order_release); }
+    void setWakeTick(uint64_t tick) { wakeTick = tick; }
+    void setIoResult(int result) { ioResult = result; }
+    void addRunTick() { runTicks++; }
+    void addSlice() { slices++; }
+    void setNice(int n) { nice = n < -20 ? -20 : (n > 19 ? 19 : n); }
+    void setReadySince(uint64_t tick) { readySince = tick; }
+    void addWaitTicks(uint64_t ticks) { waitTicks += ticks; }
+    void setVruntime(uint64_t v) { vruntime = v; }  // Only while in no RunTree
+    void setAddressSpace(AddressSpace* space) { addressSpace = space; }
 };
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include "Thread.hpp"
+
+// Intrusive FIFO of threads linked through Thread::queuePrev/queueNext.
+// A thread sits in at most one ThreadQueue at a time, so push, pop and
+// remove-by-pointer are O(1) and never allocate.
+class ThreadQueue {
+  private:
+    Thread* head;
+    Thread* tail;
+    size_t count;
+    const void* owner;  // Structure this queue belongs to (scheduler, mutex, ...)
+
+  public:
+    ThreadQueue(const void* owner = nullptr) : head(nullptr), tail(nullptr), count(0), owner(owner) {}
+
+    // Linked threads point back at the queue, so it must stay put
+    ThreadQueue(const ThreadQueue&) = delete;
+    ThreadQueue& operator=(const ThreadQueue&) = delete;
+
+    bool empty() const { return head == nullptr; }
+    size_t size() const { return count; }
+    Thread* front() const { return head; }
+    Thread* back() const { return tail; }
+    const void* getOwner() const { return owner; }
+    void setOwner(const void* o) { owner = o; }
+
+    void pushBack(Thread* t) {
+        t->queue = this;
+        t->queuePrev = tail;
+        t->queueNext = nullptr;
+        if (tail) {
+            tail->queueNext = t;
+        } else {
+            head = t;
+        }
+        tail = t;
+        count++;
+    }
+
+    void pushFront(Thread* t) {
+        t->queue = this;
+        t->queuePrev = nullptr;
+        t->queueNext = head;
+        if (head) {
+            head->queuePrev = t;
+        } else {
+            tail = t;
+        }
+        head = t;
+        count++;
+    }
+
+    // Insert in priority order (0 first), behind threads of equal priority
+    void insertByPriority(Thread* t) {
+        Thread* before = tail;
+        while (before && before->getPriority() > t->getPriority()) {
+            before = before->queuePrev;
+        }
+        if (before == nullptr) {
+            pushFront(t);
+            return;
+        }
+        t->queue = this;
+        t->queuePrev = before;
+        t->queueNext = before->queueNext;
+        if (before->queueNext) {
+            before->queueNext->queuePrev = t;
+        } else {
+            tail = t;
+        }
+        before->queueNext = t;
+        count++;
+    }
+
+    // Unlink a thread that is in this queue
+    void remove(Thread* t) {
+        if (t->queuePrev) {
+            t->queuePrev->queueNext = t->queueNext;
+        } else {
+            head = t->queueNext;
+        }
+        if (t->queueNext) {
+            t->queueNext->queuePrev = t->queuePrev;
+        } else {
+            tail = t->queuePrev;
+        }
+        t->queue = nullptr;
+        t->queuePrev = nullptr;
+        t->queueNext = nullptr;
+        count--;
+    }
+
+    Thread* popFront() {
+        Thread* t = head;
+        if (t) {
+            remove(t);
+        }
+        return t;
+    }
+
+    // Visit every queued thread in order; f must not unlink the visited thread
+    template <typename F>
+    void forEach(F f) const {
+        for (Thread* t = head; t != nullptr; t = t->queueNext) {
+            f(t);
+        }
+    }
+};
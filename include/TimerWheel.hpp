@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include "Thread.hpp"
+#include "ThreadQueue.hpp"
+
+// Hierarchical timing wheel of sleeping threads (Varghese & Lauck).
+// Four levels of 64 slots cover 2^24 ticks; later deadlines wait in an
+// overflow list. A thread is filed at the lowest level whose slot range
+// still contains its deadline, and is cascaded one level down each time
+// the clock enters that slot. Advancing one tick costs O(1 + expired +
+// cascaded), independent of how many threads are asleep.
+class TimerWheel {
+  public:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const uint64_t NEVER = UINT64_MAX;
+
+  private:
+    ThreadQueue slots[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS];  // Bit N set while slots[level][N] is non-empty
+    ThreadQueue overflow;
+    uint64_t nextTick;          // Next tick to be processed
+    size_t count;
+
+    void file(Thread* thread);
+    void unfile(Thread* thread);
+    void cascade(int level);
+
+  public:
+    TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Queue a thread to expire at 'wakeAt' (clamped to the next unprocessed tick)
+    void insert(Thread* thread, uint64_t wakeAt);
+
+    // Cancel a pending timer (for kill). Returns false if the thread is not in this wheel.
+    bool remove(Thread* thread);
+
+    // Earliest tick at which advance() has work to do (expiry or cascade), NEVER if empty
+    uint64_t nextEvent() const;
+
+    // Process every tick up to and including 'now', calling expire(thread) for
+    // each deadline reached
+    template <typename F>
+    void advance(uint64_t now, F expire) {
+        while (nextTick <= now) {
+            if (count == 0) {
+                nextTick = now + 1;
+                return;
+            }
+            // Skip straight over ticks with nothing to expire or cascade
+            uint64_t event = nextEvent();
+            if (event > now) {
+                nextTick = now + 1;
+                return;
+            }
+            nextTick = event;
+
+            for (int level = LEVELS; level >= 1; --level) {
+                if ((nextTick & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                    cascade(level);
+                }
+            }
+            ThreadQueue& due = slots[0][nextTick & (SLOTS - 1)];
+            while (Thread* t = due.popFront()) {
+                count--;
+                expire(t);
+            }
+            occupied[0] &= ~(uint64_t(1) << (nextTick & (SLOTS - 1)));
+            nextTick++;
+        }
+    }
+
+    bool contains(const Thread* thread) const {
+        return thread->getQueue() != nullptr && thread->getQueue()->getOwner() == this;
+    }
+    size_t size() const { return count; }
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// Per-CPU translation lookaside buffer: 4-way set associative, round-robin
+// replacement. Entries are tagged with the ASID and the address space's
+// generation, so a process's mappings are shot down without touching every
+// CPU. Only the owning CPU's host thread uses it.
+class Tlb {
+  public:
+    static const int SETS = 16;
+    static const int WAYS = 4;
+
+    uint64_t hits;
+    uint64_t misses;
+
+    Tlb() : hits(0), misses(0) { flush(); }
+
+    // A write only hits an entry already marked dirty, so the first store
+    // to a page goes through the page walk and sets the PTE's DIRTY bit
+    bool lookup(int asid, uint64_t vpn, uint64_t generation, bool write, size_t& frame) {
+        Entry* set = entries[setOf(asid, vpn)];
+        for (int way = 0; way < WAYS; ++way) {
+            Entry& e = set[way];
+            if (e.valid && e.vpn == vpn && e.asid == asid && e.generation == generation &&
+                (!write || e.dirty)) {
+                frame = e.frame;
+                hits++;
+                return true;
+            }
+        }
+        misses++;
+        return false;
+    }
+
+    void insert(int asid, uint64_t vpn, uint64_t generation, size_t frame, bool dirty) {
+        int s = setOf(asid, vpn);
+        Entry* set = entries[s];
+        int victim = -1;
+        for (int way = 0; way < WAYS; ++way) {
+            if (set[way].valid && set[way].vpn == vpn && set[way].asid == asid) {
+                victim = way;
+                break;
+            }
+        }
+        if (victim < 0) {
+            victim = nextVictim[s];
+            nextVictim[s] = (nextVictim[s] + 1) % WAYS;
+        }
+        set[victim] = {vpn, generation, frame, asid, true, dirty};
+    }
+
+    void flush() {
+        for (int s = 0; s < SETS; ++s) {
+            for (int way = 0; way < WAYS; ++way) {
+                entries[s][way].valid = false;
+            }
+            nextVictim[s] = 0;
+        }
+    }
+
+  private:
+    struct Entry {
+        uint64_t vpn;
+        uint64_t generation;
+        size_t frame;
+        int asid;
+        bool valid;
+        bool dirty;
+    };
+
+    Entry entries[SETS][WAYS];
+    int nextVictim[SETS];
+
+    static int setOf(int asid, uint64_t vpn) {
+        return static_cast<int>((vpn ^ (static_cast<uint64_t>(asid) * 7)) & (SETS - 1));
+    }
+};
+
+// Acknowledgement for TLB shootdowns. Bumping an address space's generation
+// stops new hits on its old translations, but a CPU may already be using a
+// pointer it got from one. Each CPU's counter is odd from before its lookup
+// until it is done with the pointer; whoever takes a frame away (under
+// Kernel::vmLock) invalidates first, then waits for every CPU it finds
+// inside to come out. A CPU leaves before blocking on vmLock, so the wait
+// never waits on the lock holder.
+class TlbShootdown {
+  public:
+    explicit TlbShootdown(int cpus) : slots(new Slot[cpus]), count(cpus) {}
+
+    void enter(int cpu) {
+        slots[cpu].seq.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with the fence in wait(): either this CPU's lookup sees the
+        // new generation, or wait() sees it inside
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    void leave(int cpu) { slots[cpu].seq.fetch_add(1, std::memory_order_release); }
+
+    // After invalidating: every access that might use the old translation is over
+    void wait() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (int cpu = 0; cpu < count; ++cpu) {
+            uint64_t seq = slots[cpu].seq.load(std::memory_order_acquire);
+            while ((seq & 1) && slots[cpu].seq.load(std::memory_order_acquire) == seq) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+  private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq{0};
+    };
+    std::unique_ptr<Slot[]> slots;
+    int count;
+};
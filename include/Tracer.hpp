@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class TraceEvent : uint8_t {
+    ContextSwitch,  // tid = next thread (0 = idle), arg0 = previous thread
+    Wake,           // tid = woken thread
+    Sleep,          // tid = sleeping thread, arg0 = ticks
+    MutexAcquire,   // tid = new owner
+    MutexContend,   // tid = waiter, arg0 = owner
+    MutexRelease,   // tid = releasing thread, arg0 = next owner (0 = none)
+    Alloc,          // arg0 = size, arg1 = offset (UINT64_MAX = failed)
+    Free,           // arg0 = offset, arg1 = size
+    FileOpen,       // arg0 = fd
+    FileRead,       // arg0 = fd, arg1 = bytes
+    FileWrite,      // arg0 = fd, arg1 = bytes
+    FileClose,      // arg0 = fd
+    PageIn,         // tid = ASID, arg0 = page, arg1 = swap slot
+    PageOut,        // tid = ASID, arg0 = page, arg1 = swap slot
+    IoSubmit,       // tid = submitting thread, arg0 = op (0 read, 1 write), arg1 = bytes
+    IoComplete,     // tid = woken thread, arg0 = result
+    Count
+};
+
+// Compact fixed-size trace record, written into a preallocated per-CPU buffer
+struct TraceRecord {
+    uint64_t timestamp;  // Host nanoseconds since 'trace start'
+    uint64_t arg0;
+    uint64_t arg1;
+    int32_t tid;
+    int16_t cpu;         // -1 for the shell and other non-CPU host threads
+    uint8_t type;        // TraceEvent
+    char phase;          // 'i' instant, 'B'/'E' begin/end of a duration
+};
+
+// Binary event tracer. While inactive every TRACE_EVENT costs one branch on
+// Tracer::active; while active each event is one record copied into the
+// calling CPU's buffer with no locking and no allocation. Records are only
+// converted to Chrome trace JSON (loadable in Perfetto) by dump().
+class Tracer {
+  public:
+    static bool active;
+
+    // Allocate 'recordsPerCpu' records for each CPU, each I/O worker and one
+    // buffer shared by the other host threads, and start recording
+    static void start(int numCpus, size_t recordsPerCpu, int ioWorkers = 0);
+    static void stop();
+    static bool dump(const std::string& path);
+
+    // Route this host thread's records to CPU 'cpu''s buffer
+    static void setCpu(int cpu);
+    // ...or, for I/O worker threads, to worker 'worker''s buffer and track:
+    // file operations on different workers overlap in time
+    static void setIoWorker(int worker);
+
+    static void record(TraceEvent type, char phase, int tid, uint64_t arg0 = 0, uint64_t arg1 = 0);
+
+    static size_t recorded();
+    static size_t dropped();
+};
+
+#define TRACE_EVENT(...)                 \
+    do {                                 \
+        if (Tracer::active) {            \
+            Tracer::record(__VA_ARGS__); \
+        }                                \
+    } while (0)
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Lock-free Chase-Lev work-stealing deque (Le et al., PPoPP'13 C11 variant).
+// The owning CPU pushes and pops at the bottom; any other CPU may steal
+// from the top. T must be trivially copyable (we store Thread*).
+template <typename T>
+class WorkStealingDeque {
+  private:
+    struct Buffer {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Buffer(int64_t cap) : capacity(cap), slots(new std::atomic<T>[cap]) {}
+
+        T get(int64_t i) const {
+            return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        void put(int64_t i, T item) {
+            slots[i & (capacity - 1)].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    std::atomic<Buffer*> buffer;
+    // Outgrown buffers stay alive until destruction: a thief may still read them
+    std::vector<std::unique_ptr<Buffer>> buffers;
+
+    Buffer* grow(Buffer* old, int64_t b, int64_t t) {
+        buffers.emplace_back(new Buffer(old->capacity * 2));
+        Buffer* bigger = buffers.back().get();
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        buffer.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+  public:
+    explicit WorkStealingDeque(int64_t capacity = 64) : top(0), bottom(0) {
+        buffers.emplace_back(new Buffer(capacity));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only
+    void push(T item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Buffer* buf = buffer.load(std::memory_order_relaxed);
+        if (b - t > buf->capacity - 1) {
+            buf = grow(buf, b, t);
+        }
+        buf->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only. Returns false when empty or the last item was stolen.
+    bool pop(T& out) {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buf = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = buf->get(b);
+        if (t == b) {
+            // Last item: race against thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread. Returns false when empty or another thief won the race.
+    bool steal(T& out) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Buffer* buf = buffer.load(std::memory_order_acquire);
+        out = buf->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                           std::memory_order_relaxed);
+    }
+
+    // Approximate when called concurrently
+    int64_t size() const {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+};
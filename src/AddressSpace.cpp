@@ -0,0 +1,152 @@
+#include "../include/AddressSpace.hpp"
+#include "../include/Pager.hpp"
+#include <cstring>
+
+AddressSpace::AddressSpace(int asid, Pager& pager, size_t pages, int family) :
+  asid(asid),
+  family(family < 0 ? asid : family),
+  pager(pager),
+  pageTable(pages, PageTableEntry{0, PTE_WRITABLE, 0}),
+  residentPages(0),
+  swappedPages(0),
+  faults(0),
+  generation(0) {
+    pager.attach(this);
+}
+
+AddressSpace::~AddressSpace() {
+    for (uint64_t vpn = 0; vpn < pageTable.size(); ++vpn) {
+        PageTableEntry& pte = pageTable[vpn];
+        if (pte.flags & PTE_PRESENT) {
+            pager.unmap(asid, vpn, pte.frame);
+        }
+        if (pte.flags & PTE_SWAPPED) {
+            pager.freeSlot(pte.slot);
+        }
+    }
+    pager.detach(this);
+}
+
+FaultResult AddressSpace::resolve(uint64_t vpn, bool write, size_t& frame) {
+    if (vpn >= pageTable.size()) {
+        return FaultResult::Segfault;
+    }
+    FaultResult result = FaultResult::Mapped;
+
+    // Making room can evict any page, this one included, so the walk is
+    // retried if the page disappears while a copy-on-write frame is found
+    for (;;) {
+        PageTableEntry& pte = pageTable[vpn];
+        if (!(pte.flags & PTE_PRESENT)) {
+            size_t newFrame = pager.allocateFrame(asid, vpn);
+            if (newFrame == Pager::NONE) {
+                return FaultResult::OutOfMemory;
+            }
+            if (pte.flags & PTE_SWAPPED) {
+                if (!pager.swapIn(asid, vpn, pte.slot, newFrame)) {
+                    pager.discardFrame(newFrame);
+                    return FaultResult::OutOfMemory;
+                }
+                swappedPages--;
+                result = FaultResult::SwapIn;
+            } else {
+                // Demand-zero: back the page with a fresh frame on first touch
+                std::memset(pager.frameData(newFrame), 0, PAGE_SIZE);
+                result = FaultResult::DemandZero;
+            }
+            pte.frame = newFrame;
+            pte.flags = (pte.flags | PTE_PRESENT) & ~PTE_COW;
+            residentPages++;
+            faults++;
+            pager.mapped(asid, vpn, newFrame);
+        } else if (write && (pte.flags & PTE_COW)) {
+            if (pager.isShared(pte.frame)) {
+                size_t copy = pager.allocateFrame(asid, vpn);
+                if (copy == Pager::NONE) {
+                    return FaultResult::OutOfMemory;
+                }
+                if (!(pte.flags & PTE_PRESENT)) {
+                    pager.discardFrame(copy);
+                    continue;
+                }
+                std::memcpy(pager.frameData(copy), pager.frameData(pte.frame), PAGE_SIZE);
+                pager.unmap(asid, vpn, pte.frame);
+                pte.frame = copy;
+                // Other threads of this process may have the shared frame cached
+                invalidate();
+                faults++;
+                pager.mapped(asid, vpn, copy, true);
+                result = FaultResult::CopyOnWrite;
+            }
+            // Otherwise every other sharer has gone and the frame is ours
+            pte.flags &= ~PTE_COW;
+        } else {
+            pager.referenced(vpn, pte.frame);
+        }
+        break;
+    }
+
+    PageTableEntry& pte = pageTable[vpn];
+    if (write && !(pte.flags & PTE_WRITABLE)) {
+        return FaultResult::Segfault;
+    }
+    pte.flags |= PTE_ACCESSED;
+    if (write) {
+        pte.flags |= PTE_DIRTY;
+        if (pte.flags & PTE_SWAPPED) {
+            // The swap copy is stale from the first store on
+            pager.freeSlot(pte.slot);
+            pte.flags &= ~PTE_SWAPPED;
+        }
+    }
+    frame = pte.frame;
+    return result;
+}
+
+const PageTableEntry* AddressSpace::entry(uint64_t vpn) const {
+    return vpn < pageTable.size() ? &pageTable[vpn] : nullptr;
+}
+
+AddressSpace* AddressSpace::fork(int childAsid) {
+    AddressSpace* child = new AddressSpace(childAsid, pager, 0, family);
+    for (PageTableEntry& pte : pageTable) {
+        if (pte.flags & PTE_PRESENT) {
+            pager.shareFrame(pte.frame);
+            if (pte.flags & PTE_WRITABLE) {
+                pte.flags |= PTE_COW;
+            }
+        }
+        if (pte.flags & PTE_SWAPPED) {
+            pager.shareSlot(pte.slot);
+        }
+    }
+    child->pageTable = pageTable;
+    child->residentPages = residentPages;
+    child->swappedPages = swappedPages;
+
+    // Cached translations may still allow writes to what is now shared
+    invalidate();
+    return child;
+}
+
+void AddressSpace::unmapPage(uint64_t vpn, bool toSwap, uint32_t slot) {
+    PageTableEntry& pte = pageTable[vpn];
+    if (toSwap) {
+        pte.slot = slot;
+        pte.flags |= PTE_SWAPPED;
+    }
+    // Shoot down cached translations before the frame is reused
+    invalidate();
+    pte.flags &= ~(PTE_PRESENT | PTE_ACCESSED | PTE_DIRTY | PTE_COW);
+    residentPages--;
+    if (pte.flags & PTE_SWAPPED) {
+        swappedPages++;
+    }
+}
+
+bool AddressSpace::testAndClearAccessed(uint64_t vpn) {
+    PageTableEntry& pte = pageTable[vpn];
+    bool accessed = (pte.flags & PTE_ACCESSED) != 0;
+    pte.flags &= ~PTE_ACCESSED;
+    return accessed;
+}
@@ -0,0 +1,263 @@
+#include "../include/Allocator.hpp"
+#include <algorithm>
+
+namespace {
+
+int floorLog2(uint64_t n) {
+    return 63 - __builtin_clzll(n);
+}
+
+int ceilLog2(uint64_t n) {
+    return n <= 1 ? 0 : floorLog2(n - 1) + 1;
+}
+
+}  // namespace
+
+// --------------------------------------------------------------- free lists
+
+FreeLists::FreeLists(char* base, size_t linkAt, int classes) :
+  base(base),
+  linkAt(linkAt),
+  heads(classes, END),
+  nonEmpty(0) {}
+
+void FreeLists::push(int cls, uint64_t block) {
+    setPrev(block, END);
+    setNext(block, heads[cls]);
+    if (heads[cls] != END) {
+        setPrev(heads[cls], block);
+    }
+    heads[cls] = block;
+    nonEmpty |= uint64_t(1) << cls;
+}
+
+void FreeLists::remove(int cls, uint64_t block) {
+    uint64_t prev = prevOf(block);
+    uint64_t next = nextOf(block);
+    if (prev != END) {
+        setNext(prev, next);
+    } else {
+        heads[cls] = next;
+    }
+    if (next != END) {
+        setPrev(next, prev);
+    }
+    if (heads[cls] == END) {
+        nonEmpty &= ~(uint64_t(1) << cls);
+    }
+}
+
+int FreeLists::firstAtLeast(int cls) const {
+    uint64_t candidates = cls >= 64 ? 0 : nonEmpty & ~((uint64_t(1) << cls) - 1);
+    return candidates == 0 ? -1 : __builtin_ctzll(candidates);
+}
+
+// ------------------------------------------------------------ boundary tags
+
+BoundaryTagAllocator::BoundaryTagAllocator(char* base, size_t capacity, int classes) :
+  base(base),
+  limit(capacity >= MIN_BLOCK ? capacity & ~(ALIGN - 1) : 0),
+  classes(classes),
+  bins(base, HEADER, classes) {
+    // Initially, one large free block covering simulated RAM
+    if (limit > 0) {
+        insertFree(0, limit);
+    }
+}
+
+int BoundaryTagAllocator::classOf(size_t size) const {
+    return classes == 1 ? 0 : std::min(floorLog2(size / ALIGN), classes - 1);
+}
+
+void BoundaryTagAllocator::setPrevFree(size_t block, bool prevFree) {
+    if (block >= limit) {
+        return;
+    }
+    uint64_t header = load(block);
+    store(block, prevFree ? header | PREV_FREE : header & ~PREV_FREE);
+}
+
+void BoundaryTagAllocator::insertFree(size_t block, size_t size) {
+    // Its predecessor is never free: neighbours are always coalesced
+    store(block, size | FREE);
+    store(block + size - 8, size);
+    setPrevFree(block + size, true);
+    bins.push(classOf(size), block);
+}
+
+void BoundaryTagAllocator::removeFree(size_t block) {
+    bins.remove(classOf(sizeOf(block)), block);
+}
+
+size_t BoundaryTagAllocator::findFit(size_t size) const {
+    int cls = classOf(size);
+
+    // First fit (one list), or a short look at the exact bin
+    int scanned = 0;
+    for (uint64_t b = bins.head(cls); !bins.isEnd(b); b = bins.after(b)) {
+        if (sizeOf(b) >= size) {
+            return b;
+        }
+        if (classes > 1 && ++scanned == BIN_SCAN) {
+            break;
+        }
+    }
+    if (classes == 1) {
+        return NONE;
+    }
+
+    // Anything in a higher bin is at least twice the class minimum
+    int higher = bins.firstAtLeast(cls + 1);
+    if (higher >= 0) {
+        return bins.head(higher);
+    }
+
+    // Last resort: the rest of the exact bin
+    for (uint64_t b = bins.head(cls); !bins.isEnd(b); b = bins.after(b)) {
+        if (sizeOf(b) >= size) {
+            return b;
+        }
+    }
+    return NONE;
+}
+
+size_t BoundaryTagAllocator::allocate(size_t size) {
+    if (size == 0 || size > limit) {
+        return NONE;
+    }
+    size_t want = std::max(MIN_BLOCK, (size + HEADER + ALIGN - 1) & ~(ALIGN - 1));
+    size_t block = findFit(want);
+    if (block == NONE) {
+        return NONE;
+    }
+
+    size_t have = sizeOf(block);
+    removeFree(block);
+    if (have - want >= MIN_BLOCK) {
+        // Split off the remainder as a new free block
+        store(block, want);
+        insertFree(block + want, have - want);
+    } else {
+        store(block, have);
+        setPrevFree(block + have, false);
+    }
+    return block + HEADER;
+}
+
+size_t BoundaryTagAllocator::release(size_t offset) {
+    if (offset < HEADER || offset >= limit || (offset - HEADER) % ALIGN != 0) {
+        return 0;
+    }
+    size_t block = offset - HEADER;
+    uint64_t header = load(block);
+    size_t size = header & ~FLAGS;
+    if ((header & FREE) || size < MIN_BLOCK || size > limit - block) {
+        return 0;
+    }
+    size_t freed = size;
+    // Marked free even if it ends up inside its predecessor, so a second
+    // release of the same offset is still caught
+    store(block, header | FREE);
+
+    // Coalesce with next block if free
+    size_t next = block + size;
+    if (next < limit && (load(next) & FREE)) {
+        size += sizeOf(next);
+        removeFree(next);
+    }
+
+    // Coalesce with previous block if free, found through its footer
+    if (header & PREV_FREE) {
+        size_t prevSize = load(block - 8);
+        block -= prevSize;
+        size += prevSize;
+        removeFree(block);
+    }
+    insertFree(block, size);
+    return freed;
+}
+
+void BoundaryTagAllocator::blocks(std::vector<MemoryBlock>& out) const {
+    out.clear();
+    for (size_t b = 0; b < limit; b += sizeOf(b)) {
+        out.push_back({b, sizeOf(b), (load(b) & FREE) != 0});
+    }
+}
+
+// -------------------------------------------------------------------- buddy
+
+BuddyAllocator::BuddyAllocator(char* base, size_t capacity) :
+  units(capacity / MIN_BLOCK),
+  tags(units),
+  orders(base, 0, MAX_ORDER + 1) {
+    // Cover RAM with the largest naturally aligned power-of-two blocks
+    size_t unit = 0;
+    while (unit < units) {
+        int order = unit == 0 ? MAX_ORDER : std::min(MAX_ORDER, __builtin_ctzll(unit));
+        while ((size_t(1) << order) > units - unit) {
+            order--;
+        }
+        setTag(unit, order, FREE_BLOCK);
+        orders.push(order, unit * MIN_BLOCK);
+        unit += size_t(1) << order;
+    }
+}
+
+size_t BuddyAllocator::allocate(size_t size) {
+    if (size == 0 || size > units * MIN_BLOCK) {
+        return NONE;
+    }
+    int want = ceilLog2((size + MIN_BLOCK - 1) / MIN_BLOCK);
+    int order = orders.firstAtLeast(want);
+    if (order < 0) {
+        return NONE;
+    }
+
+    size_t unit = orders.head(order) / MIN_BLOCK;
+    orders.remove(order, unit * MIN_BLOCK);
+    // Split, returning the upper halves to their free lists
+    while (order > want) {
+        order--;
+        size_t buddy = unit + (size_t(1) << order);
+        setTag(buddy, order, FREE_BLOCK);
+        orders.push(order, buddy * MIN_BLOCK);
+    }
+    setTag(unit, order, USED_BLOCK);
+    return unit * MIN_BLOCK;
+}
+
+size_t BuddyAllocator::release(size_t offset) {
+    if (offset % MIN_BLOCK != 0 || offset / MIN_BLOCK >= units) {
+        return 0;
+    }
+    size_t unit = offset / MIN_BLOCK;
+    if (stateAt(unit) != USED_BLOCK) {
+        return 0;
+    }
+    int order = orderAt(unit);
+    size_t freed = (size_t(1) << order) * MIN_BLOCK;
+
+    // Merge with the buddy while it is a free block of the same order
+    while (order < MAX_ORDER) {
+        size_t buddy = unit ^ (size_t(1) << order);
+        if (buddy + (size_t(1) << order) > units || stateAt(buddy) != FREE_BLOCK ||
+            orderAt(buddy) != order) {
+            break;
+        }
+        orders.remove(order, buddy * MIN_BLOCK);
+        setTag(std::max(unit, buddy), 0, INTERIOR);
+        unit = std::min(unit, buddy);
+        order++;
+    }
+    setTag(unit, order, FREE_BLOCK);
+    orders.push(order, unit * MIN_BLOCK);
+    return freed;
+}
+
+void BuddyAllocator::blocks(std::vector<MemoryBlock>& out) const {
+    out.clear();
+    for (size_t unit = 0; unit < units; unit += size_t(1) << orderAt(unit)) {
+        out.push_back({unit * MIN_BLOCK, (size_t(1) << orderAt(unit)) * MIN_BLOCK,
+                       stateAt(unit) == FREE_BLOCK});
+    }
+}
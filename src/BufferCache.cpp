@@ -0,0 +1,187 @@
+#include "../include/BufferCache.hpp"
+#include "../include/Logger.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint64_t BufferCache::crashAfterWrites = 0;
+
+BufferCache::BufferCache(const std::string& path, size_t blocks) :
+  fd(::open(path.c_str(), O_RDWR | O_CREAT, 0644)),
+  capacity(std::max<size_t>(blocks, 1)),
+  memory(capacity * BLOCK_SIZE),
+  dirtyCount(0),
+  hits(0),
+  misses(0),
+  writebacks(0),
+  syncs(0) {
+    for (size_t slot = capacity; slot-- > 0;) {
+        freeSlots.push_back(slot);
+    }
+    if (fd < 0) {
+        LOG_ERROR("[BufferCache] Cannot open disk image " << path);
+    }
+}
+
+BufferCache::~BufferCache() {
+    if (fd >= 0) {
+        flush();
+        ::close(fd);
+    }
+}
+
+size_t BufferCache::imageSize() const {
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+bool BufferCache::resize(size_t bytes) {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto it = lru.begin(); it != lru.end();) {
+        if ((it->block + 1) * BLOCK_SIZE > bytes) {
+            dirtyCount -= it->dirty ? 1 : 0;
+            freeSlots.push_back(it->slot);
+            blocks.erase(it->block);
+            it = lru.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return fd >= 0 && ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+}
+
+BufferCache::Buffer* BufferCache::get(uint64_t block, bool overwrite) {
+    auto it = blocks.find(block);
+    if (it != blocks.end()) {
+        hits++;
+        lru.splice(lru.begin(), lru, it->second);
+        return &lru.front();
+    }
+    misses++;
+
+    if (freeSlots.empty()) {
+        Buffer& old = lru.back();
+        if (old.dirty && !writeBack(old)) {
+            return nullptr;
+        }
+        freeSlots.push_back(old.slot);
+        blocks.erase(old.block);
+        lru.pop_back();
+    }
+    size_t slot = freeSlots.back();
+    freeSlots.pop_back();
+    lru.push_front({block, slot, false});
+    Buffer& buffer = lru.front();
+    blocks[block] = lru.begin();
+
+    if (!overwrite) {
+        ssize_t n = pread(fd, dataOf(buffer), BLOCK_SIZE, static_cast<off_t>(block * BLOCK_SIZE));
+        if (n < 0) {
+            LOG_ERROR("[BufferCache] Read of block " << block << " failed");
+            freeSlots.push_back(slot);
+            blocks.erase(block);
+            lru.pop_front();
+            return nullptr;
+        }
+        // Short read at the end of the image: the rest is a hole
+        std::memset(dataOf(buffer) + n, 0, BLOCK_SIZE - n);
+    }
+    return &buffer;
+}
+
+bool BufferCache::writeBack(Buffer& buffer) {
+    if (crashAfterWrites != 0 && --crashAfterWrites == 0) {
+        raise(SIGKILL);
+    }
+    ssize_t n = pwrite(fd, dataOf(buffer), BLOCK_SIZE, static_cast<off_t>(buffer.block * BLOCK_SIZE));
+    if (n != static_cast<ssize_t>(BLOCK_SIZE)) {
+        LOG_ERROR("[BufferCache] Write of block " << buffer.block << " failed");
+        return false;
+    }
+    buffer.dirty = false;
+    dirtyCount--;
+    writebacks++;
+    return true;
+}
+
+bool BufferCache::read(size_t offset, char* buffer, size_t len) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (fd < 0) {
+        return false;
+    }
+    while (len > 0) {
+        size_t within = offset % BLOCK_SIZE;
+        size_t chunk = std::min(len, BLOCK_SIZE - within);
+        Buffer* b = get(offset / BLOCK_SIZE, false);
+        if (b == nullptr) {
+            return false;
+        }
+        std::memcpy(buffer, dataOf(*b) + within, chunk);
+        buffer += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool BufferCache::write(size_t offset, const char* data, size_t len) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (fd < 0) {
+        return false;
+    }
+    while (len > 0) {
+        size_t within = offset % BLOCK_SIZE;
+        size_t chunk = std::min(len, BLOCK_SIZE - within);
+        Buffer* b = get(offset / BLOCK_SIZE, chunk == BLOCK_SIZE);
+        if (b == nullptr) {
+            return false;
+        }
+        std::memcpy(dataOf(*b) + within, data, chunk);
+        if (!b->dirty) {
+            b->dirty = true;
+            dirtyCount++;
+        }
+        data += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+int BufferCache::flush() {
+    std::vector<Buffer*> dirty;
+    for (Buffer& b : lru) {
+        if (b.dirty) {
+            dirty.push_back(&b);
+        }
+    }
+    // Ascending block order keeps the writes sequential on the image
+    std::sort(dirty.begin(), dirty.end(), [](const Buffer* a, const Buffer* b) { return a->block < b->block; });
+    for (Buffer* b : dirty) {
+        if (!writeBack(*b)) {
+            return -1;
+        }
+    }
+    if (fdatasync(fd) != 0) {
+        LOG_ERROR("[BufferCache] fdatasync failed");
+        return -1;
+    }
+    syncs++;
+    return static_cast<int>(dirty.size());
+}
+
+int BufferCache::sync() {
+    std::lock_guard<std::mutex> guard(lock);
+    return fd >= 0 ? flush() : -1;
+}
+
+BufferCacheStats BufferCache::getStats() {
+    std::lock_guard<std::mutex> guard(lock);
+    return {hits, misses, writebacks, syncs, lru.size(), dirtyCount, capacity};
+}
@@ -0,0 +1,56 @@
+#include "../include/DentryCache.hpp"
+#include <algorithm>
+
+DentryCache::DentryCache(size_t capacity) :
+  capacity(std::max<size_t>(capacity, 1)),
+  hits(0),
+  misses(0) {}
+
+std::string DentryCache::keyOf(uint32_t dir, const std::string& name) {
+    std::string key(reinterpret_cast<const char*>(&dir), sizeof(dir));
+    return key + name;
+}
+
+int DentryCache::lookup(uint32_t dir, const std::string& name) {
+    auto it = entries.find(keyOf(dir, name));
+    if (it == entries.end()) {
+        misses++;
+        return -1;
+    }
+    hits++;
+    lru.splice(lru.begin(), lru, it->second);
+    return static_cast<int>(it->second->inode);
+}
+
+void DentryCache::insert(uint32_t dir, const std::string& name, uint32_t inode) {
+    std::string key = keyOf(dir, name);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        it->second->inode = inode;
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    if (lru.size() == capacity) {
+        entries.erase(lru.back().key);
+        lru.pop_back();
+    }
+    lru.push_front({key, inode});
+    entries[key] = lru.begin();
+}
+
+void DentryCache::erase(uint32_t dir, const std::string& name) {
+    auto it = entries.find(keyOf(dir, name));
+    if (it != entries.end()) {
+        lru.erase(it->second);
+        entries.erase(it);
+    }
+}
+
+void DentryCache::clear() {
+    lru.clear();
+    entries.clear();
+}
+
+DentryCacheStats DentryCache::getStats() const {
+    return {hits, misses, lru.size(), capacity};
+}
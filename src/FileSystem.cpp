@@ -1,129 +1,1231 @@
 #include "../include/FileSystem.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Tracer.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <cstring>
 
-FileSystem::FileSystem(const std::string& path) : diskPath(path), nextFreeOffset(0) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        inodeTable[i].inUse = false;
+namespace {
+
+// FNV-1a: where a name lives in its directory's hash table
+uint32_t nameHash(const std::string& name) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : name) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+// Linear hashing: bucket hash mod 2^(i+1), or mod 2^i if that one isn't split off yet
+size_t bucketOf(uint32_t hash, size_t buckets) {
+    size_t span = 1;
+    while (span < buckets) {
+        span <<= 1;
+    }
+    size_t bucket = hash & (span - 1);
+    return bucket < buckets ? bucket : bucket - span / 2;
+}
+
+}  // namespace
+
+size_t Inode::blockCount() const {
+    size_t blocks = 0;
+    for (const Extent& e : extents) {
+        blocks += e.length;
     }
+    return blocks;
+}
+
+FileSystem::FileSystem(const std::string& path, size_t diskBytes, size_t inodes, bool formatDisk, bool journaled) :
+  diskPath(path), cache(path), journal(cache), super(), reservedBlocks(0), allInodesLoaded(false), allocHint(0) {
     for (int i = 0; i < MAX_OPEN_FILES; i++) {
         openFiles[i].isOpen = false;
     }
-    initDisk();
-    std::cout << "[FileSystem] Initialized with disk: " << diskPath << std::endl;
+    if (formatDisk || !mount()) {
+        format(diskBytes, inodes, journaled);
+    }
+    LOG_INFO("[FileSystem] Initialized with disk: " << diskPath << " (" << super.totalBlocks
+             << " blocks, " << super.inodeCount << " inodes)");
+}
+
+FileSystem::~FileSystem() {
+    // Everything else must be on disk, and the journal empty, before the
+    // clean flag is
+    commit(true);
+    journal.stop();
+    super.clean = 1;
+    writeSuperBlock();
+}
+
+bool FileSystem::mount() {
+    SuperBlock disk;
+    if (cache.imageSize() < BLOCK_SIZE || !cache.read(0, reinterpret_cast<char*>(&disk), sizeof(disk))) {
+        return false;
+    }
+    if (disk.magic != FS_MAGIC || disk.version != FS_VERSION || disk.blockSize != BLOCK_SIZE ||
+        disk.dataStart >= disk.totalBlocks || disk.inodeHighWater > disk.inodeCount ||
+        disk.journalStart + disk.journalBlocks != disk.dataStart) {
+        return false;
+    }
+    // Committed metadata goes back in place before any of it is read. After
+    // a clean unmount the journal is empty.
+    if (journal.recover(disk.journalStart, disk.journalBlocks) < 0) {
+        LOG_ERROR("[FileSystem] Error: Journal replay failed.");
+    }
+    cache.read(0, reinterpret_cast<char*>(&super), sizeof(super));
+    allocHint = super.dataStart;
+    dentries.clear();
+    bitmap.assign(static_cast<size_t>(super.bitmapBlocks) * BLOCK_SIZE / 8, 0);
+    reserved.assign(bitmap.size(), 0);
+    inodeBlockLoaded.assign(super.inodeBlocks, false);
+
+    if (super.clean || super.journalBlocks > 0) {
+        // Only the bitmap is read now; inodes follow on first lookup
+        cache.read(static_cast<size_t>(super.bitmapStart) * BLOCK_SIZE,
+                   reinterpret_cast<char*>(bitmap.data()), bitmap.size() * 8);
+    } else {
+        rebuildBitmap();
+    }
+
+    // Mark the image in use until unmount, ahead of any other write
+    super.clean = 0;
+    writeSuperBlock();
+    cache.sync();
+    journal.start();
+    LOG_INFO("[FileSystem] Mounted existing disk file.");
+    return true;
 }
 
-void FileSystem::initDisk() {
-    std::ifstream check(diskPath);
-    if (!check.good()) {
-        std::ofstream create(diskPath, std::ios::binary);
-        std::vector<char> zeros(DISK_SIZE, 0);
-        create.write(zeros.data(), DISK_SIZE);
-        create.close();
-        std::cout << "[FileSystem] Created new disk file." << std::endl;
+void FileSystem::rebuildBitmap() {
+    loadAllInodes();
+    std::fill(bitmap.begin(), bitmap.end(), 0);
+    auto markUsed = [this](uint32_t start, size_t count) {
+        for (size_t block = start; block < start + count; ++block) {
+            bitmap[block / 64] |= 1ULL << (block % 64);
+        }
+    };
+    markUsed(0, super.dataStart);
+    markUsed(super.totalBlocks, bitmap.size() * 64 - super.totalBlocks);
+    for (const auto& entry : inodeTable) {
+        for (const Extent& e : entry.second.extents) {
+            markUsed(e.start, e.length);
+        }
+        if (entry.second.indirect != 0) {
+            markUsed(entry.second.indirect, 1);
+        }
+    }
+    size_t used = 0;
+    for (uint64_t word : bitmap) {
+        used += __builtin_popcountll(word);
     }
-    check.close();
+    super.freeBlocks = static_cast<uint32_t>(bitmap.size() * 64 - used);
+    writeBitmap(0, static_cast<uint32_t>(bitmap.size() * 64));
+    LOG_WARN("[FileSystem] Unclean shutdown: rebuilt the block bitmap from " << inodeTable.size() << " files.");
 }
 
-int FileSystem::findInode(const std::string& filename) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (inodeTable[i].inUse && inodeTable[i].filename == filename) {
-            return i;
+void FileSystem::loadInodeBlock(uint32_t block) {
+    const uint32_t perBlock = BLOCK_SIZE / sizeof(DiskInode);
+    DiskInode raw[perBlock];
+    journal.read((static_cast<size_t>(super.inodeStart) + block) * BLOCK_SIZE, reinterpret_cast<char*>(raw), sizeof(raw));
+    for (uint32_t k = 0; k < perBlock && block * perBlock + k < super.inodeCount; ++k) {
+        const DiskInode& disk = raw[k];
+        if (!(disk.flags & INODE_USED)) {
+            continue;
         }
+        uint32_t index = block * perBlock + k;
+        if (inodeTable.count(index)) {
+            continue;  // Allocated since mount; memory is current
+        }
+        Inode inode{std::string(disk.name, strnlen(disk.name, sizeof(disk.name))), disk.size, {}, disk.indirect,
+                    disk.parent, (disk.flags & INODE_DIR) != 0};
+        size_t count = std::min<size_t>(disk.extentCount, DIRECT_EXTENTS + INDIRECT_EXTENTS);
+        inode.extents.assign(disk.extents, disk.extents + std::min(count, DIRECT_EXTENTS));
+        if (count > DIRECT_EXTENTS && disk.indirect != 0) {
+            Extent overflow[INDIRECT_EXTENTS];
+            journal.read(static_cast<size_t>(disk.indirect) * BLOCK_SIZE, reinterpret_cast<char*>(overflow), sizeof(overflow));
+            inode.extents.insert(inode.extents.end(), overflow, overflow + (count - DIRECT_EXTENTS));
+        }
+        inodeTable[index] = std::move(inode);
     }
-    return -1;
+    inodeBlockLoaded[block] = true;
+}
+
+void FileSystem::loadAllInodes() {
+    if (allInodesLoaded) {
+        return;
+    }
+    const uint32_t perBlock = BLOCK_SIZE / sizeof(DiskInode);
+    for (uint32_t block = 0; block * perBlock < super.inodeHighWater; ++block) {
+        if (!inodeBlockLoaded[block]) {
+            loadInodeBlock(block);
+        }
+    }
+    freeInodes.clear();
+    for (uint32_t index = super.inodeHighWater; index-- > 0;) {
+        if (inodeTable.find(index) == inodeTable.end()) {
+            freeInodes.push_back(index);
+        }
+    }
+    allInodesLoaded = true;
+}
+
+void FileSystem::format(size_t diskBytes, size_t inodes, bool journaled) {
+    const size_t minDataBlocks = 8;
+    size_t total = std::min(diskBytes, MAX_DISK_SIZE) / BLOCK_SIZE;
+    inodes = std::max<size_t>(inodes, 1);
+    size_t inodeBlocks = (inodes * sizeof(DiskInode) + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    size_t bitmapBlocks, journalBlocks, dataStart;
+    for (;;) {
+        bitmapBlocks = (total + BLOCK_SIZE * 8 - 1) / (BLOCK_SIZE * 8);
+        journalBlocks = journaled ? std::min(std::max(total / 64, MIN_JOURNAL_BLOCKS), MAX_JOURNAL_BLOCKS) : 0;
+        dataStart = 1 + bitmapBlocks + inodeBlocks + journalBlocks;
+        if (total >= dataStart + minDataBlocks) {
+            break;
+        }
+        total = dataStart + minDataBlocks;
+        LOG_WARN("[FileSystem] Disk too small for its metadata, using " << total * BLOCK_SIZE << " bytes.");
+    }
+
+    super.magic = FS_MAGIC;
+    super.version = FS_VERSION;
+    super.blockSize = BLOCK_SIZE;
+    super.totalBlocks = static_cast<uint32_t>(total);
+    super.inodeCount = static_cast<uint32_t>(inodes);
+    super.bitmapStart = 1;
+    super.bitmapBlocks = static_cast<uint32_t>(bitmapBlocks);
+    super.inodeStart = static_cast<uint32_t>(1 + bitmapBlocks);
+    super.inodeBlocks = static_cast<uint32_t>(inodeBlocks);
+    super.dataStart = static_cast<uint32_t>(dataStart);
+    super.freeBlocks = super.totalBlocks;
+    super.clean = 0;
+    super.inodeHighWater = 0;
+    super.journalStart = static_cast<uint32_t>(1 + bitmapBlocks + inodeBlocks);
+    super.journalBlocks = static_cast<uint32_t>(journalBlocks);
+    allocHint = super.dataStart;
+
+    // A fresh sparse image reads as zeros: empty inodes, free blocks
+    cache.resize(0);
+    cache.resize(total * BLOCK_SIZE);
+    inodeTable.clear();
+    dentries.clear();
+    freeInodes.clear();
+    inodeBlockLoaded.assign(inodeBlocks, true);
+    allInodesLoaded = true;
+    bitmap.assign(bitmapBlocks * BLOCK_SIZE / 8, 0);
+    reserved.assign(bitmap.size(), 0);
+    reservedBlocks = 0;
+    pendingFree.clear();
+    pendingLogged.clear();
+    heldLogged.clear();
+    setBits(0, super.dataStart, true);
+    // Bits past the last block never describe a free block
+    for (size_t block = total; block < bitmap.size() * 64; ++block) {
+        bitmap[block / 64] |= 1ULL << (block % 64);
+    }
+    writeBitmap(super.totalBlocks, static_cast<uint32_t>(bitmap.size() * 64 - total));
+    // The root directory is inode 0, its own parent
+    allocateInode("/", ROOT_INODE, true);
+    initDirectory(inodeTable[ROOT_INODE]);
+    writeInode(ROOT_INODE);
+    writeSuperBlock();
+    journal.format(super.journalStart, super.journalBlocks);
+    journal.start();
+    LOG_INFO("[FileSystem] Formatted new disk file.");
+}
+
+void FileSystem::writeSuperBlock() {
+    journal.write(0, reinterpret_cast<const char*>(&super), sizeof(super));
+}
+
+int FileSystem::commit(bool checkpoint) {
+    uint64_t wraps = journal.getStats().checkpoints;
+    int written = journal.commit();
+    if (written >= 0 && checkpoint && journal.enabled()) {
+        int flushed = journal.checkpoint();
+        written = flushed < 0 ? -1 : written + flushed;
+    }
+    if (written < 0) {
+        LOG_ERROR("[FileSystem] Error: Commit failed.");
+        return -1;
+    }
+    for (const Extent& e : pendingFree) {
+        release(e.start, e.length);
+    }
+    pendingFree.clear();
+    if (journal.getStats().checkpoints != wraps) {
+        for (const Extent& e : heldLogged) {
+            release(e.start, e.length);
+        }
+        heldLogged.clear();
+    }
+    for (const Extent& e : pendingLogged) {
+        if (checkpoint) {
+            release(e.start, e.length);
+        } else {
+            heldLogged.push_back(e);
+        }
+    }
+    pendingLogged.clear();
+    return written;
+}
+
+void FileSystem::maybeCommit() {
+    if (journal.wantsCommit()) {
+        commit(false);
+    }
+}
+
+Inode* FileSystem::getInode(uint32_t index) {
+    const uint32_t perBlock = BLOCK_SIZE / sizeof(DiskInode);
+    if (index >= super.inodeHighWater) {
+        return nullptr;
+    }
+    if (!inodeBlockLoaded[index / perBlock]) {
+        loadInodeBlock(index / perBlock);
+    }
+    auto it = inodeTable.find(index);
+    return it != inodeTable.end() ? &it->second : nullptr;
+}
+
+int FileSystem::allocateInode(const std::string& name, uint32_t parent, bool isDir) {
+    // Fresh indexes first; holes left by earlier sessions need a full table scan
+    uint32_t index;
+    if (!freeInodes.empty()) {
+        index = freeInodes.back();
+        freeInodes.pop_back();
+    } else if (super.inodeHighWater < super.inodeCount) {
+        index = super.inodeHighWater++;
+        writeSuperBlock();
+    } else {
+        loadAllInodes();
+        if (freeInodes.empty()) {
+            return -1;
+        }
+        index = freeInodes.back();
+        freeInodes.pop_back();
+    }
+    getInode(index);  // Load the rest of its table block first
+    inodeTable[index] = Inode{name, 0, {}, 0, parent, isDir};
+    writeInode(static_cast<int>(index));
+    return static_cast<int>(index);
+}
+
+void FileSystem::releaseInode(uint32_t index) {
+    inodeTable.erase(index);
+    freeInodes.push_back(index);
+    writeInode(static_cast<int>(index));
+}
+
+bool FileSystem::writeInode(int index) {
+    auto it = inodeTable.find(index);
+    DiskInode disk;
+    std::memset(&disk, 0, sizeof(disk));
+    if (it == inodeTable.end()) {
+        // Unlinked: an all-zero entry
+        size_t offset = static_cast<size_t>(super.inodeStart) * BLOCK_SIZE + index * sizeof(DiskInode);
+        return journal.write(offset, reinterpret_cast<const char*>(&disk), sizeof(disk));
+    }
+    const Inode& inode = it->second;
+    {
+        disk.flags = INODE_USED | (inode.isDir ? INODE_DIR : 0);
+        disk.extentCount = static_cast<uint32_t>(inode.extents.size());
+        disk.size = inode.size;
+        std::strncpy(disk.name, inode.filename.c_str(), MAX_FILENAME);
+        for (size_t i = 0; i < inode.extents.size() && i < DIRECT_EXTENTS; ++i) {
+            disk.extents[i] = inode.extents[i];
+        }
+        disk.indirect = inode.indirect;
+        disk.parent = inode.parent;
+    }
+    size_t offset = static_cast<size_t>(super.inodeStart) * BLOCK_SIZE + index * sizeof(DiskInode);
+    if (!journal.write(offset, reinterpret_cast<const char*>(&disk), sizeof(disk))) {
+        return false;
+    }
+    if (inode.extents.size() > DIRECT_EXTENTS) {
+        Extent overflow[INDIRECT_EXTENTS] = {};
+        std::copy(inode.extents.begin() + DIRECT_EXTENTS, inode.extents.end(), overflow);
+        return journal.write(static_cast<size_t>(inode.indirect) * BLOCK_SIZE,
+                             reinterpret_cast<const char*>(overflow), sizeof(overflow));
+    }
+    return true;
+}
+
+uint32_t FileSystem::findFree(uint32_t goal) const {
+    // First free block at or after 'goal', wrapping to the data area
+    uint32_t from[2] = {goal, super.dataStart};
+    uint32_t to[2] = {super.totalBlocks, goal};
+    for (int pass = 0; pass < 2; ++pass) {
+        for (uint32_t block = from[pass]; block < to[pass]; block = (block / 64 + 1) * 64) {
+            uint64_t used = bitmap[block / 64] | reserved[block / 64] | ((1ULL << (block % 64)) - 1);
+            if (used != ~0ULL) {
+                return (block / 64) * 64 + __builtin_ctzll(~used);
+            }
+        }
+    }
+    return 0;  // Block 0 is the superblock, never free
 }
 
-int FileSystem::allocateInode(const std::string& filename) {
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (!inodeTable[i].inUse) {
-            inodeTable[i].filename = filename;
-            inodeTable[i].offset = nextFreeOffset;
-            inodeTable[i].size = 0;
-            inodeTable[i].inUse = true;
-            return i;
+void FileSystem::setBits(uint32_t start, uint32_t count, bool used) {
+    for (uint32_t block = start; block < start + count; ++block) {
+        if (used) {
+            bitmap[block / 64] |= 1ULL << (block % 64);
+        } else {
+            bitmap[block / 64] &= ~(1ULL << (block % 64));
+        }
+    }
+    super.freeBlocks = used ? super.freeBlocks - count : super.freeBlocks + count;
+    writeBitmap(start, count);
+    writeSuperBlock();
+}
+
+void FileSystem::freeRun(uint32_t start, uint32_t count, bool logged) {
+    setBits(start, count, false);
+    if (!journal.enabled()) {
+        return;
+    }
+    for (uint32_t block = start; block < start + count; ++block) {
+        reserved[block / 64] |= 1ULL << (block % 64);
+    }
+    reservedBlocks += count;
+    if (logged) {
+        pendingLogged.push_back({start, count});
+    } else {
+        pendingFree.push_back({start, count});
+    }
+}
+
+void FileSystem::release(uint32_t start, uint32_t count) {
+    for (uint32_t block = start; block < start + count; ++block) {
+        reserved[block / 64] &= ~(1ULL << (block % 64));
+    }
+    reservedBlocks -= count;
+}
+
+void FileSystem::writeBitmap(uint32_t start, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    size_t first = start / 8;
+    size_t last = (static_cast<size_t>(start) + count - 1) / 8;
+    journal.write(static_cast<size_t>(super.bitmapStart) * BLOCK_SIZE + first,
+                  reinterpret_cast<const char*>(bitmap.data()) + first, last - first + 1);
+}
+
+bool FileSystem::growTo(Inode& inode, size_t blocks) {
+    size_t have = inode.blockCount();
+    while (have < blocks) {
+        if (available() == 0) {
+            return false;
+        }
+        // Continue the last extent if the block after it is free
+        uint32_t goal = allocHint;
+        if (!inode.extents.empty()) {
+            goal = inode.extents.back().start + inode.extents.back().length;
+        }
+        uint32_t start = findFree(goal < super.totalBlocks ? goal : super.dataStart);
+        bool extends = !inode.extents.empty() && start == goal;
+        if (!extends && inode.extents.size() == DIRECT_EXTENTS + INDIRECT_EXTENTS) {
+            return false;  // Too fragmented
+        }
+        if (!extends && inode.extents.size() == DIRECT_EXTENTS && inode.indirect == 0) {
+            // The first overflow extent needs a block to live in
+            inode.indirect = start;
+            setBits(start, 1, true);
+            continue;
+        }
+
+        // Take a few blocks beyond the request while the disk has room, so
+        // files appended to in turn still get long extents
+        size_t want = blocks - have;
+        if (available() > super.totalBlocks / 8) {
+            want = std::max(want, PREALLOC_BLOCKS);
+        }
+        uint32_t length = 1;
+        while (length < want && start + length < super.totalBlocks && isFree(start + length)) {
+            length++;
+        }
+        setBits(start, length, true);
+        if (extends) {
+            inode.extents.back().length += length;
+        } else {
+            inode.extents.push_back({start, length});
+        }
+        have += length;
+        allocHint = start + length;
+    }
+    return true;
+}
+
+void FileSystem::shrinkTo(Inode& inode, size_t blocks) {
+    size_t have = inode.blockCount();
+    while (have > blocks) {
+        Extent& last = inode.extents.back();
+        uint32_t cut = static_cast<uint32_t>(std::min<size_t>(last.length, have - blocks));
+        freeRun(last.start + last.length - cut, cut, inode.isDir);
+        last.length -= cut;
+        have -= cut;
+        if (last.length == 0) {
+            inode.extents.pop_back();
+        }
+    }
+    if (inode.extents.size() <= DIRECT_EXTENTS && inode.indirect != 0) {
+        freeRun(inode.indirect, 1, true);
+        inode.indirect = 0;
+    }
+}
+
+bool FileSystem::reclaimPreallocated(const Inode& except) {
+    uint32_t before = super.freeBlocks;
+    for (auto& entry : inodeTable) {
+        Inode& inode = entry.second;
+        size_t used = (inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        if (&inode != &except && inode.blockCount() > used) {
+            shrinkTo(inode, used);
+            writeInode(static_cast<int>(entry.first));
+        }
+    }
+    return super.freeBlocks > before;
+}
+
+size_t FileSystem::diskOffset(const Inode& inode, uint64_t pos, size_t& contiguous) const {
+    uint64_t extentPos = 0;
+    for (const Extent& e : inode.extents) {
+        uint64_t bytes = static_cast<uint64_t>(e.length) * BLOCK_SIZE;
+        if (pos < extentPos + bytes) {
+            contiguous = static_cast<size_t>(extentPos + bytes - pos);
+            return static_cast<size_t>(e.start) * BLOCK_SIZE + static_cast<size_t>(pos - extentPos);
+        }
+        extentPos += bytes;
+    }
+    contiguous = 0;
+    return 0;
+}
+
+int FileSystem::lookup(uint32_t dir, const std::string& name) {
+    Inode* d = getInode(dir);
+    if (d == nullptr || !d->isDir) {
+        return -1;
+    }
+    if (name == ".") {
+        return static_cast<int>(dir);
+    }
+    if (name == "..") {
+        return static_cast<int>(d->parent);
+    }
+    int cached = dentries.lookup(dir, name);
+    if (cached >= 0) {
+        return cached;
+    }
+    // One bucket read, whatever the directory's size
+    uint32_t hash = nameHash(name);
+    DirEntry entries[DIR_ENTRIES_PER_BLOCK];
+    if (!readBucket(*d, bucketOf(hash, d->size / BLOCK_SIZE), entries)) {
+        return -1;
+    }
+    for (const DirEntry& e : entries) {
+        if (e.name[0] != '\0' && e.hash == hash && name == e.name) {
+            dentries.insert(dir, name, e.inode);
+            return static_cast<int>(e.inode);
         }
     }
     return -1;
 }
 
-int FileSystem::my_open(const std::string& filename) {
-    int inodeIdx = findInode(filename);
+int FileSystem::resolve(const std::string& path) {
+    int index = ROOT_INODE;
+    for (size_t pos = 0; index >= 0 && pos < path.size();) {
+        size_t end = std::min(path.find('/', pos), path.size());
+        if (end > pos) {
+            index = lookup(static_cast<uint32_t>(index), path.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+    // Loaded from here on, so callers may index inodeTable directly
+    return index >= 0 && getInode(index) != nullptr ? index : -1;
+}
+
+int FileSystem::resolveParent(const std::string& path, std::string& name) {
+    size_t end = path.find_last_not_of('/');
+    if (end == std::string::npos) {
+        return -1;  // The root
+    }
+    size_t slash = path.rfind('/', end);
+    size_t start = slash == std::string::npos ? 0 : slash + 1;
+    name = path.substr(start, end + 1 - start);
+    if (name == "." || name == ".." || name.size() > MAX_FILENAME) {
+        return -1;
+    }
+    int parent = resolve(path.substr(0, start));
+    Inode* dir = parent >= 0 ? getInode(parent) : nullptr;
+    return dir != nullptr && dir->isDir ? parent : -1;
+}
+
+int FileSystem::create(const std::string& path, bool isDir) {
+    std::string name;
+    int parent = resolveParent(path, name);
+    if (parent < 0) {
+        LOG_ERROR("[FileSystem] Error: Invalid path: " << path);
+        return -1;
+    }
+    if (lookup(parent, name) != -1) {
+        LOG_ERROR("[FileSystem] Error: '" << path << "' exists.");
+        return -1;
+    }
+    // Splitting first means every transaction ends with a consistent tree
+    if (!makeRoom(parent, nameHash(name))) {
+        LOG_ERROR("[FileSystem] Error: Directory full.");
+        return -1;
+    }
+    int index = allocateInode(name, parent, isDir);
+    if (index == -1) {
+        LOG_ERROR("[FileSystem] Error: No free inodes.");
+        return -1;
+    }
+    if (isDir && !initDirectory(inodeTable[index])) {
+        shrinkTo(inodeTable[index], 0);
+        releaseInode(index);
+        LOG_ERROR("[FileSystem] Error: Disk full.");
+        return -1;
+    }
+    writeInode(index);
+    if (!dirInsert(parent, name, index)) {
+        shrinkTo(inodeTable[index], 0);
+        releaseInode(index);
+        return -1;
+    }
+    return index;
+}
+
+bool FileSystem::readBucket(const Inode& dir, size_t bucket, DirEntry* entries) {
+    size_t contiguous;
+    size_t offset = diskOffset(dir, static_cast<uint64_t>(bucket) * BLOCK_SIZE, contiguous);
+    return contiguous >= BLOCK_SIZE && journal.read(offset, reinterpret_cast<char*>(entries), BLOCK_SIZE);
+}
+
+bool FileSystem::writeBucket(const Inode& dir, size_t bucket, const DirEntry* entries) {
+    // Directory blocks are metadata: journaled like the inode table
+    size_t contiguous;
+    size_t offset = diskOffset(dir, static_cast<uint64_t>(bucket) * BLOCK_SIZE, contiguous);
+    return contiguous >= BLOCK_SIZE && journal.write(offset, reinterpret_cast<const char*>(entries), BLOCK_SIZE);
+}
+
+bool FileSystem::initDirectory(Inode& dir) {
+    DirEntry empty[DIR_ENTRIES_PER_BLOCK] = {};
+    if (!growTo(dir, 1)) {
+        return false;
+    }
+    dir.size = BLOCK_SIZE;
+    return writeBucket(dir, 0, empty);
+}
+
+bool FileSystem::splitBucket(uint32_t index) {
+    Inode& dir = inodeTable[index];
+    size_t buckets = dir.size / BLOCK_SIZE;
+    size_t half = 1;
+    while (half * 2 <= buckets) {
+        half *= 2;
+    }
+    size_t oldBlocks = dir.blockCount();
+    if (buckets + 1 > oldBlocks && !growTo(dir, buckets + 1)) {
+        shrinkTo(dir, oldBlocks);
+        return false;
+    }
+    // Bucket (buckets - half) holds every name that now maps to the new bucket
+    size_t from = buckets - half;
+    DirEntry entries[DIR_ENTRIES_PER_BLOCK];
+    DirEntry stay[DIR_ENTRIES_PER_BLOCK] = {};
+    DirEntry move[DIR_ENTRIES_PER_BLOCK] = {};
+    if (!readBucket(dir, from, entries)) {
+        return false;
+    }
+    size_t stayed = 0, moved = 0;
+    for (const DirEntry& e : entries) {
+        if (e.name[0] == '\0') {
+            continue;
+        }
+        if (e.hash & half) {
+            move[moved++] = e;
+        } else {
+            stay[stayed++] = e;
+        }
+    }
+    dir.size += BLOCK_SIZE;
+    writeBucket(dir, from, stay);
+    writeBucket(dir, buckets, move);
+    return writeInode(static_cast<int>(index));
+}
+
+bool FileSystem::makeRoom(uint32_t dir, uint32_t hash) {
+    for (;;) {
+        const Inode& d = inodeTable[dir];
+        DirEntry entries[DIR_ENTRIES_PER_BLOCK];
+        if (!readBucket(d, bucketOf(hash, d.size / BLOCK_SIZE), entries)) {
+            return false;
+        }
+        for (const DirEntry& e : entries) {
+            if (e.name[0] == '\0') {
+                return true;
+            }
+        }
+        // The split bucket may not be this one; each split is whole on its own
+        if (!splitBucket(dir)) {
+            return false;
+        }
+        maybeCommit();
+    }
+}
+
+bool FileSystem::dirInsert(uint32_t dir, const std::string& name, uint32_t inode) {
+    const Inode& d = inodeTable[dir];
+    uint32_t hash = nameHash(name);
+    size_t bucket = bucketOf(hash, d.size / BLOCK_SIZE);
+    DirEntry entries[DIR_ENTRIES_PER_BLOCK];
+    if (!readBucket(d, bucket, entries)) {
+        return false;
+    }
+    for (DirEntry& e : entries) {
+        if (e.name[0] == '\0') {
+            e.inode = inode;
+            e.hash = hash;
+            std::strncpy(e.name, name.c_str(), MAX_FILENAME);
+            e.name[MAX_FILENAME] = '\0';
+            dentries.insert(dir, name, inode);
+            return writeBucket(d, bucket, entries);
+        }
+    }
+    return false;
+}
+
+void FileSystem::dirRemove(uint32_t dir, const std::string& name) {
+    const Inode& d = inodeTable[dir];
+    uint32_t hash = nameHash(name);
+    size_t bucket = bucketOf(hash, d.size / BLOCK_SIZE);
+    DirEntry entries[DIR_ENTRIES_PER_BLOCK];
+    dentries.erase(dir, name);
+    if (!readBucket(d, bucket, entries)) {
+        return;
+    }
+    for (DirEntry& e : entries) {
+        if (e.name[0] != '\0' && e.hash == hash && name == e.name) {
+            std::memset(&e, 0, sizeof(e));
+            writeBucket(d, bucket, entries);
+            return;
+        }
+    }
+}
+
+bool FileSystem::dirEmpty(const Inode& dir) {
+    DirEntry entries[DIR_ENTRIES_PER_BLOCK];
+    for (size_t bucket = 0; bucket < dir.size / BLOCK_SIZE; ++bucket) {
+        if (!readBucket(dir, bucket, entries)) {
+            return false;
+        }
+        for (const DirEntry& e : entries) {
+            if (e.name[0] != '\0') {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool FileSystem::isDirectory(const std::string& path) {
+    int index = resolve(path);
+    Inode* inode = index >= 0 ? getInode(index) : nullptr;
+    return inode != nullptr && inode->isDir;
+}
+
+int FileSystem::my_open(const std::string& path) {
+    int inodeIdx = resolve(path);
     if (inodeIdx == -1) {
-        inodeIdx = allocateInode(filename);
+        inodeIdx = create(path, false);
         if (inodeIdx == -1) {
-            std::cout << "[FileSystem] Error: No free inodes." << std::endl;
             return -1;
         }
-        std::cout << "[FileSystem] Created file: " << filename << std::endl;
+        LOG_INFO("[FileSystem] Created file: " << path);
+        maybeCommit();
+    } else if (inodeTable[inodeIdx].isDir) {
+        LOG_ERROR("[FileSystem] Error: '" << path << "' is a directory.");
+        return -1;
     }
     for (int fd = 0; fd < MAX_OPEN_FILES; fd++) {
         if (!openFiles[fd].isOpen) {
             openFiles[fd].inodeIndex = inodeIdx;
-            openFiles[fd].readPos = 0;
+            openFiles[fd].offset = 0;
             openFiles[fd].isOpen = true;
-            std::cout << "[FileSystem] Opened '" << filename << "' as fd=" << fd << std::endl;
+            TRACE_EVENT(TraceEvent::FileOpen, 'i', 0, fd);
+            LOG_INFO("[FileSystem] Opened '" << path << "' as fd=" << fd);
             return fd;
         }
     }
-    std::cout << "[FileSystem] Error: No free file descriptors." << std::endl;
+    LOG_ERROR("[FileSystem] Error: No free file descriptors.");
     return -1;
 }
 
-int FileSystem::my_write(int fd, const char* data, size_t len) {
+OpenFile* FileSystem::fileOf(int fd) {
     if (fd < 0 || fd >= MAX_OPEN_FILES || !openFiles[fd].isOpen) {
-        std::cout << "[FileSystem] Error: Invalid fd." << std::endl;
+        LOG_ERROR("[FileSystem] Error: Invalid fd.");
+        return nullptr;
+    }
+    return &openFiles[fd];
+}
+
+bool FileSystem::copyOut(const Inode& inode, uint64_t pos, char* buffer, size_t len) {
+    bool ok = true;
+    for (size_t done = 0; ok && done < len;) {
+        size_t contiguous;
+        size_t offset = diskOffset(inode, pos + done, contiguous);
+        size_t chunk = std::min(len - done, contiguous);
+        ok = chunk > 0 && cache.read(offset, buffer + done, chunk);
+        done += chunk;
+    }
+    return ok;
+}
+
+bool FileSystem::copyIn(const Inode& inode, uint64_t pos, const char* data, size_t len) {
+    bool ok = true;
+    for (size_t done = 0; ok && done < len;) {
+        size_t contiguous;
+        size_t offset = diskOffset(inode, pos + done, contiguous);
+        size_t chunk = std::min(len - done, contiguous);
+        ok = chunk > 0 && cache.write(offset, data + done, chunk);
+        done += chunk;
+    }
+    return ok;
+}
+
+int FileSystem::readAt(const Inode& inode, uint64_t pos, char* buffer, size_t len) {
+    if (pos >= inode.size) {
+        return 0;
+    }
+    size_t bytesToRead = static_cast<size_t>(std::min<uint64_t>(len, inode.size - pos));
+    TRACE_EVENT(TraceEvent::FileRead, 'B', 0, 0, bytesToRead);
+    bool ok = copyOut(inode, pos, buffer, bytesToRead);
+    TRACE_EVENT(TraceEvent::FileRead, 'E', 0, 0, bytesToRead);
+    if (!ok) {
+        LOG_ERROR("[FileSystem] Error: Read failed.");
         return -1;
     }
-    int inodeIdx = openFiles[fd].inodeIndex;
+    return static_cast<int>(bytesToRead);
+}
+
+int FileSystem::writeAt(int inodeIdx, uint64_t pos, const char* data, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
     Inode& inode = inodeTable[inodeIdx];
-    if (inode.offset + inode.size + len > DISK_SIZE) {
-        std::cout << "[FileSystem] Error: Disk full." << std::endl;
+    uint64_t end = pos + len;
+    size_t oldBlocks = inode.blockCount();
+    size_t needed = static_cast<size_t>((end + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    if (needed > oldBlocks) {
+        // One spare for an indirect block
+        if (needed - oldBlocks + 1 > available()) {
+            // Take back other files' preallocation, then let everything freed
+            // since the last commit be reused
+            reclaimPreallocated(inode);
+            if (reservedBlocks > 0) {
+                commit(true);
+            }
+        }
+        if (!growTo(inode, needed)) {
+            shrinkTo(inode, oldBlocks);
+            LOG_ERROR("[FileSystem] Error: Disk full.");
+            return -1;
+        }
+    }
+    TRACE_EVENT(TraceEvent::FileWrite, 'B', 0, inodeIdx, len);
+    // Blocks past the old end may hold another file's old bytes
+    static const char zeros[BLOCK_SIZE] = {};
+    bool ok = true;
+    for (uint64_t gap = inode.size; ok && gap < pos;) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, pos - gap));
+        ok = copyIn(inode, gap, zeros, chunk);
+        gap += chunk;
+    }
+    ok = ok && copyIn(inode, pos, data, len);
+    TRACE_EVENT(TraceEvent::FileWrite, 'E', 0, inodeIdx, len);
+    if (!ok) {
+        LOG_ERROR("[FileSystem] Error: Write failed.");
+        return -1;
+    }
+    // Overwrites inside the file leave its metadata alone
+    if (end > inode.size) {
+        inode.size = end;
+        writeInode(inodeIdx);
+    }
+    maybeCommit();
+    return static_cast<int>(len);
+}
+
+int FileSystem::my_write(int fd, const char* data, size_t len) {
+    OpenFile* of = fileOf(fd);
+    if (of == nullptr) {
         return -1;
     }
-    std::fstream disk(diskPath, std::ios::in | std::ios::out | std::ios::binary);
-    disk.seekp(inode.offset + inode.size);
-    disk.write(data, len);
-    disk.close();
-    inode.size += len;
-    nextFreeOffset = inode.offset + inode.size;
-    std::cout << "[FileSystem] Wrote " << len << " bytes to fd=" << fd << std::endl;
-    return len;
+    int written = writeAt(of->inodeIndex, of->offset, data, len);
+    if (written > 0) {
+        of->offset += written;
+    }
+    LOG_INFO("[FileSystem] Wrote " << written << " bytes to fd=" << fd);
+    return written;
 }
 
 int FileSystem::my_read(int fd, char* buffer, size_t len) {
-    if (fd < 0 || fd >= MAX_OPEN_FILES || !openFiles[fd].isOpen) {
-        std::cout << "[FileSystem] Error: Invalid fd." << std::endl;
+    OpenFile* of = fileOf(fd);
+    if (of == nullptr) {
         return -1;
     }
-    int inodeIdx = openFiles[fd].inodeIndex;
-    Inode& inode = inodeTable[inodeIdx];
-    OpenFile& of = openFiles[fd];
-    size_t bytesToRead = std::min(len, inode.size - of.readPos);
-    if (bytesToRead == 0) return 0;
-    std::ifstream disk(diskPath, std::ios::binary);
-    disk.seekg(inode.offset + of.readPos);
-    disk.read(buffer, bytesToRead);
-    disk.close();
-    of.readPos += bytesToRead;
-    std::cout << "[FileSystem] Read " << bytesToRead << " bytes from fd=" << fd << std::endl;
-    return bytesToRead;
+    int got = readAt(inodeTable[of->inodeIndex], of->offset, buffer, len);
+    if (got > 0) {
+        of->offset += got;
+    }
+    LOG_INFO("[FileSystem] Read " << got << " bytes from fd=" << fd);
+    return got;
+}
+
+int FileSystem::my_pwrite(int fd, const char* data, size_t len, uint64_t offset) {
+    OpenFile* of = fileOf(fd);
+    return of != nullptr ? writeAt(of->inodeIndex, offset, data, len) : -1;
+}
+
+int FileSystem::my_pread(int fd, char* buffer, size_t len, uint64_t offset) {
+    OpenFile* of = fileOf(fd);
+    return of != nullptr ? readAt(inodeTable[of->inodeIndex], offset, buffer, len) : -1;
+}
+
+int FileSystem::my_writev(int fd, const IoVec* iov, int count) {
+    OpenFile* of = fileOf(fd);
+    if (of == nullptr || count < 0) {
+        return -1;
+    }
+    if (count == 1) {
+        return my_write(fd, iov[0].base, iov[0].len);
+    }
+    // Gathered into one run, the buffers cost one extent walk and one
+    // inode update instead of one each
+    size_t len = 0;
+    for (int i = 0; i < count; ++i) {
+        len += iov[i].len;
+    }
+    std::vector<char> gathered(len);
+    size_t at = 0;
+    for (int i = 0; i < count; ++i) {
+        std::memcpy(gathered.data() + at, iov[i].base, iov[i].len);
+        at += iov[i].len;
+    }
+    int written = writeAt(of->inodeIndex, of->offset, gathered.data(), len);
+    if (written > 0) {
+        of->offset += written;
+    }
+    LOG_INFO("[FileSystem] Wrote " << written << " bytes from " << count << " buffers to fd=" << fd);
+    return written;
+}
+
+int FileSystem::my_readv(int fd, const IoVec* iov, int count) {
+    OpenFile* of = fileOf(fd);
+    if (of == nullptr || count < 0) {
+        return -1;
+    }
+    if (count == 1) {
+        return my_read(fd, iov[0].base, iov[0].len);
+    }
+    size_t len = 0;
+    for (int i = 0; i < count; ++i) {
+        len += iov[i].len;
+    }
+    std::vector<char> gathered(len);
+    int got = readAt(inodeTable[of->inodeIndex], of->offset, gathered.data(), len);
+    if (got <= 0) {
+        return got;
+    }
+    size_t left = got;
+    for (int i = 0; i < count && left > 0; ++i) {
+        size_t chunk = std::min(left, iov[i].len);
+        std::memcpy(iov[i].base, gathered.data() + (got - left), chunk);
+        left -= chunk;
+    }
+    of->offset += got;
+    LOG_INFO("[FileSystem] Read " << got << " bytes into " << count << " buffers from fd=" << fd);
+    return got;
+}
+
+int64_t FileSystem::my_seek(int fd, int64_t offset, int whence) {
+    OpenFile* of = fileOf(fd);
+    if (of == nullptr) {
+        return -1;
+    }
+    int64_t base = whence == SEEK_SET ? 0
+                 : whence == SEEK_CUR ? static_cast<int64_t>(of->offset)
+                 : whence == SEEK_END ? static_cast<int64_t>(inodeTable[of->inodeIndex].size)
+                                      : -1;
+    if (base < 0 || base + offset < 0) {
+        LOG_ERROR("[FileSystem] Error: Invalid seek.");
+        return -1;
+    }
+    // Past the end is allowed; the next write fills the gap with zeros
+    of->offset = static_cast<uint64_t>(base + offset);
+    return static_cast<int64_t>(of->offset);
 }
 
 void FileSystem::my_close(int fd) {
     if (fd < 0 || fd >= MAX_OPEN_FILES || !openFiles[fd].isOpen) return;
     openFiles[fd].isOpen = false;
-    std::cout << "[FileSystem] Closed fd=" << fd << std::endl;
+    TRACE_EVENT(TraceEvent::FileClose, 'i', 0, fd);
+    LOG_INFO("[FileSystem] Closed fd=" << fd);
+}
+
+int FileSystem::my_truncate(const std::string& path, size_t size) {
+    int inodeIdx = resolve(path);
+    if (inodeIdx == -1 || inodeTable[inodeIdx].isDir) {
+        LOG_ERROR("[FileSystem] Error: No such file: " << path);
+        return -1;
+    }
+    Inode& inode = inodeTable[inodeIdx];
+    if (size > inode.size) {
+        LOG_ERROR("[FileSystem] Error: truncate only shrinks.");
+        return -1;
+    }
+    shrinkTo(inode, (size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    inode.size = size;
+    for (OpenFile& of : openFiles) {
+        if (of.isOpen && of.inodeIndex == inodeIdx) {
+            of.offset = std::min<uint64_t>(of.offset, size);
+        }
+    }
+    writeInode(inodeIdx);
+    maybeCommit();
+    LOG_INFO("[FileSystem] Truncated '" << path << "' to " << size << " bytes");
+    return 0;
+}
+
+int FileSystem::my_unlink(const std::string& path) {
+    int inodeIdx = resolve(path);
+    if (inodeIdx == -1) {
+        LOG_ERROR("[FileSystem] Error: No such file: " << path);
+        return -1;
+    }
+    Inode& inode = inodeTable[inodeIdx];
+    if (inode.isDir) {
+        LOG_ERROR("[FileSystem] Error: '" << path << "' is a directory.");
+        return -1;
+    }
+    for (const OpenFile& of : openFiles) {
+        if (of.isOpen && of.inodeIndex == inodeIdx) {
+            LOG_ERROR("[FileSystem] Error: '" << path << "' is open.");
+            return -1;
+        }
+    }
+    shrinkTo(inode, 0);
+    dirRemove(inode.parent, inode.filename);
+    releaseInode(inodeIdx);
+    maybeCommit();
+    LOG_INFO("[FileSystem] Removed file: " << path);
+    return 0;
+}
+
+int FileSystem::my_mkdir(const std::string& path) {
+    if (create(path, true) == -1) {
+        return -1;
+    }
+    maybeCommit();
+    LOG_INFO("[FileSystem] Created directory: " << path);
+    return 0;
+}
+
+int FileSystem::my_rmdir(const std::string& path) {
+    int inodeIdx = resolve(path);
+    if (inodeIdx == -1 || !inodeTable[inodeIdx].isDir) {
+        LOG_ERROR("[FileSystem] Error: No such directory: " << path);
+        return -1;
+    }
+    Inode& dir = inodeTable[inodeIdx];
+    if (inodeIdx == ROOT_INODE || !dirEmpty(dir)) {
+        LOG_ERROR("[FileSystem] Error: '" << path << "' is not empty.");
+        return -1;
+    }
+    shrinkTo(dir, 0);
+    dirRemove(dir.parent, dir.filename);
+    releaseInode(inodeIdx);
+    maybeCommit();
+    LOG_INFO("[FileSystem] Removed directory: " << path);
+    return 0;
+}
+
+int FileSystem::my_listdir(const std::string& path, std::vector<DirListing>& entries) {
+    int inodeIdx = resolve(path);
+    if (inodeIdx == -1 || !inodeTable[inodeIdx].isDir) {
+        LOG_ERROR("[FileSystem] Error: No such directory: " << path);
+        return -1;
+    }
+    entries.clear();
+    const Inode& dir = inodeTable[inodeIdx];
+    DirEntry bucket[DIR_ENTRIES_PER_BLOCK];
+    for (size_t b = 0; b < dir.size / BLOCK_SIZE; ++b) {
+        if (!readBucket(dir, b, bucket)) {
+            return -1;
+        }
+        for (const DirEntry& e : bucket) {
+            if (e.name[0] == '\0') {
+                continue;
+            }
+            const Inode* child = getInode(e.inode);
+            entries.push_back({e.name, e.inode, child != nullptr && child->isDir, child != nullptr ? child->size : 0});
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const DirListing& a, const DirListing& b) { return a.name < b.name; });
+    return static_cast<int>(entries.size());
+}
+
+bool FileSystem::readBlock(size_t offset, char* buffer, size_t len) {
+    return cache.read(offset, buffer, len);
+}
+
+bool FileSystem::writeBlock(size_t offset, const char* data, size_t len) {
+    // Writing past the end of the image grows it once the block is written back
+    return cache.write(offset, data, len);
+}
+
+int FileSystem::sync() {
+    return commit(false);
+}
+
+bool FileSystem::check(std::vector<std::string>& problems) {
+    loadAllInodes();
+    std::vector<uint64_t> owned(bitmap.size(), 0);
+    auto claim = [&](uint32_t start, uint64_t count, const std::string& owner) {
+        if (start < super.dataStart || start + count > super.totalBlocks) {
+            problems.push_back(owner + ": blocks " + std::to_string(start) + "+" + std::to_string(count) +
+                               " outside the data area");
+            return;
+        }
+        for (uint32_t block = start; block < start + count; ++block) {
+            if (owned[block / 64] >> (block % 64) & 1) {
+                problems.push_back(owner + ": block " + std::to_string(block) + " already in use");
+            }
+            owned[block / 64] |= 1ULL << (block % 64);
+        }
+    };
+    for (uint32_t block = 0; block < super.dataStart; ++block) {
+        owned[block / 64] |= 1ULL << (block % 64);
+    }
+    for (size_t block = super.totalBlocks; block < owned.size() * 64; ++block) {
+        owned[block / 64] |= 1ULL << (block % 64);
+    }
+
+    std::vector<uint32_t> indexes;
+    for (const auto& entry : inodeTable) {
+        indexes.push_back(entry.first);
+    }
+    std::sort(indexes.begin(), indexes.end());
+    for (uint32_t index : indexes) {
+        const Inode& inode = inodeTable[index];
+        std::string owner = "inode " + std::to_string(index) + " '" + inode.filename + "'";
+        if (index >= super.inodeHighWater) {
+            problems.push_back(owner + ": past the high-water mark");
+        }
+        for (const Extent& e : inode.extents) {
+            claim(e.start, e.length, owner);
+        }
+        if (inode.extents.size() > DIRECT_EXTENTS && inode.indirect == 0) {
+            problems.push_back(owner + ": overflow extents without an indirect block");
+        }
+        if (inode.indirect != 0) {
+            claim(inode.indirect, 1, owner + " indirect");
+        }
+        if (inode.size > static_cast<uint64_t>(inode.blockCount()) * BLOCK_SIZE) {
+            problems.push_back(owner + ": size " + std::to_string(inode.size) + " exceeds its blocks");
+        }
+    }
+
+    // The tree: every inode but the root is named exactly once, by its
+    // parent, in the bucket its hash selects
+    auto root = inodeTable.find(ROOT_INODE);
+    if (root == inodeTable.end() || !root->second.isDir) {
+        problems.push_back("no root directory");
+    }
+    std::unordered_map<uint32_t, int> names;
+    for (uint32_t index : indexes) {
+        const Inode& dir = inodeTable[index];
+        if (!dir.isDir) {
+            continue;
+        }
+        std::string owner = "directory " + std::to_string(index) + " '" + dir.filename + "'";
+        size_t buckets = dir.size / BLOCK_SIZE;
+        if (buckets == 0 || dir.size % BLOCK_SIZE != 0) {
+            problems.push_back(owner + ": size " + std::to_string(dir.size) + " is not whole buckets");
+            continue;
+        }
+        DirEntry entries[DIR_ENTRIES_PER_BLOCK];
+        for (size_t bucket = 0; bucket < buckets && readBucket(dir, bucket, entries); ++bucket) {
+            for (const DirEntry& e : entries) {
+                if (e.name[0] == '\0') {
+                    continue;
+                }
+                std::string name(e.name, strnlen(e.name, sizeof(e.name)));
+                auto child = inodeTable.find(e.inode);
+                if (child == inodeTable.end()) {
+                    problems.push_back(owner + ": '" + name + "' names free inode " + std::to_string(e.inode));
+                } else if (child->second.parent != index || child->second.filename != name) {
+                    problems.push_back(owner + ": '" + name + "' names inode " + std::to_string(e.inode) + " '" +
+                                       child->second.filename + "' of directory " +
+                                       std::to_string(child->second.parent));
+                }
+                if (e.hash != nameHash(name) || bucketOf(e.hash, buckets) != bucket) {
+                    problems.push_back(owner + ": '" + name + "' is in the wrong bucket");
+                }
+                names[e.inode]++;
+            }
+        }
+    }
+    for (uint32_t index : indexes) {
+        if (index != ROOT_INODE && names[index] != 1) {
+            problems.push_back("inode " + std::to_string(index) + " '" + inodeTable[index].filename + "': named " +
+                               std::to_string(names[index]) + " times");
+        }
+    }
+
+    size_t leaked = 0, unmarked = 0, used = 0;
+    for (size_t i = 0; i < bitmap.size(); ++i) {
+        leaked += __builtin_popcountll(bitmap[i] & ~owned[i]);
+        unmarked += __builtin_popcountll(owned[i] & ~bitmap[i]);
+        used += __builtin_popcountll(bitmap[i]);
+    }
+    if (leaked > 0) {
+        problems.push_back(std::to_string(leaked) + " block(s) marked in use but owned by no file");
+    }
+    if (unmarked > 0) {
+        problems.push_back(std::to_string(unmarked) + " block(s) in use but marked free");
+    }
+    if (super.freeBlocks != bitmap.size() * 64 - used) {
+        problems.push_back("superblock counts " + std::to_string(super.freeBlocks) + " free blocks, bitmap " +
+                           std::to_string(bitmap.size() * 64 - used));
+    }
+    return problems.empty();
 }
 
 void FileSystem::printInodeTable() {
     std::cout << "--- Inode Table ---" << std::endl;
-    for (int i = 0; i < MAX_FILES; i++) {
-        if (inodeTable[i].inUse) {
-            std::cout << "[" << i << "] " << inodeTable[i].filename 
-                      << " | Offset: " << inodeTable[i].offset 
-                      << " | Size: " << inodeTable[i].size << std::endl;
+    loadAllInodes();
+    std::vector<uint32_t> indexes;
+    for (const auto& entry : inodeTable) {
+        indexes.push_back(entry.first);
+    }
+    std::sort(indexes.begin(), indexes.end());
+    for (uint32_t i : indexes) {
+        const Inode& inode = inodeTable[i];
+        std::cout << "[" << i << "] " << inode.filename << (inode.isDir && i != ROOT_INODE ? "/" : "")
+                  << " | Size: " << inode.size
+                  << " | Blocks: " << inode.blockCount()
+                  << " | Extents:";
+        for (const Extent& e : inode.extents) {
+            std::cout << " " << e.start << "+" << e.length;
         }
+        std::cout << std::endl;
     }
+    std::cout << "Blocks: " << super.totalBlocks - super.freeBlocks << "/" << super.totalBlocks
+              << " used (" << BLOCK_SIZE << " bytes, data from block " << super.dataStart << ")"
+              << " | Inodes: " << inodeTable.size() << "/" << super.inodeCount << std::endl;
     std::cout << "-------------------" << std::endl;
 }
@@ -0,0 +1,216 @@
+#include "../include/IoRing.hpp"
+#include "../include/FileSystem.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Tracer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+IoRing::IoRing(size_t entries) : capacity(std::max<size_t>(entries, 1)), pending(0) {}
+
+bool IoRing::submit(IoRequest&& request) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (pending == capacity) {
+        return false;
+    }
+    pending++;
+    sq.push_back(std::move(request));
+    return true;
+}
+
+bool IoRing::take(IoRequest& request) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (sq.empty()) {
+        return false;
+    }
+    request = std::move(sq.front());
+    sq.pop_front();
+    return true;
+}
+
+void IoRing::complete(IoCompletion&& completion) {
+    std::lock_guard<std::mutex> guard(lock);
+    cq.push_back(std::move(completion));
+}
+
+bool IoRing::reap(int cpu, IoCompletion& completion) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = std::find_if(cq.begin(), cq.end(), [cpu](const IoCompletion& c) { return c.cpu == cpu; });
+    if (it == cq.end()) {
+        return false;
+    }
+    completion = std::move(*it);
+    cq.erase(it);
+    pending--;
+    return true;
+}
+
+void IoRing::cancel(std::vector<int>& cpus) {
+    std::lock_guard<std::mutex> guard(lock);
+    for (IoRequest& request : sq) {
+        cq.push_back({request.op, request.tid, request.cpu, request.vaddr, -1, {}});
+        cpus.push_back(request.cpu);
+    }
+    sq.clear();
+}
+
+IoWorkerPool::IoWorkerPool(FileSystem& fs, int cpus, int workers, int latencyMicros) :
+  fs(fs),
+  latencyMicros(std::max(0, latencyMicros)),
+  doorbells(new Doorbell[std::max(1, cpus)]),
+  servicing(0),
+  running(false),
+  stopping(false),
+  submitted(0),
+  completed(0),
+  failed(0),
+  bytes(0) {
+    for (int i = 0; i < std::max(1, workers); ++i) {
+        threads.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+IoWorkerPool::~IoWorkerPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    work.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+bool IoWorkerPool::submit(const std::shared_ptr<IoRing>& ring, IoRequest&& request) {
+    int cpu = request.cpu;
+    if (!ring->submit(std::move(request))) {
+        return false;
+    }
+    doorbells[cpu].inFlight.fetch_add(1, std::memory_order_relaxed);
+    submitted.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        queued.push_back(ring);
+    }
+    work.notify_one();
+    return true;
+}
+
+void IoWorkerPool::cancel(const std::shared_ptr<IoRing>& ring) {
+    std::vector<int> cpus;
+    ring->cancel(cpus);
+    for (int cpu : cpus) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        post(cpu, ring);
+    }
+}
+
+void IoWorkerPool::resume() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        running = true;
+    }
+    work.notify_all();
+}
+
+void IoWorkerPool::pause() {
+    std::unique_lock<std::mutex> guard(lock);
+    running = false;
+    idle.wait(guard, [this] { return servicing == 0; });
+}
+
+void IoWorkerPool::waitForCompletion(int cpu, int micros) {
+    Doorbell& bell = doorbells[cpu];
+    std::unique_lock<std::mutex> guard(bell.lock);
+    bell.posted.wait_for(guard, std::chrono::microseconds(micros),
+                         [&bell] { return bell.rung.load(std::memory_order_relaxed); });
+}
+
+void IoWorkerPool::post(int cpu, const std::shared_ptr<IoRing>& ring) {
+    Doorbell& bell = doorbells[cpu];
+    {
+        std::lock_guard<std::mutex> guard(bell.lock);
+        if (std::find(bell.rings.begin(), bell.rings.end(), ring) == bell.rings.end()) {
+            bell.rings.push_back(ring);
+        }
+        bell.rung.store(true, std::memory_order_release);
+    }
+    bell.posted.notify_one();
+}
+
+void IoWorkerPool::workerLoop(int worker) {
+    Tracer::setIoWorker(worker);
+    for (;;) {
+        std::shared_ptr<IoRing> next;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            work.wait(guard, [this] { return stopping || (running && !queued.empty()); });
+            if (stopping) {
+                return;
+            }
+            next = std::move(queued.front());
+            queued.pop_front();
+            servicing++;
+        }
+
+        IoRequest request;
+        if (next->take(request)) {
+            // The device's share of the request: other workers' requests
+            // and the simulated CPUs proceed meanwhile
+            if (latencyMicros > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(latencyMicros));
+            }
+            int result = service(request);
+            (result < 0 ? failed : completed).fetch_add(1, std::memory_order_relaxed);
+            if (result > 0) {
+                bytes.fetch_add(result, std::memory_order_relaxed);
+            }
+            if (request.op == IoOp::Read && result >= 0) {
+                request.data.resize(result);
+            } else {
+                request.data.clear();
+            }
+            int cpu = request.cpu;
+            next->complete({request.op, request.tid, cpu, request.vaddr, result, std::move(request.data)});
+            post(cpu, next);
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            servicing--;
+        }
+        idle.notify_all();
+    }
+}
+
+int IoWorkerPool::service(IoRequest& request) {
+    std::lock_guard<std::mutex> guard(fsLock);
+    if (request.op == IoOp::Read && !fs.exists(request.path)) {
+        LOG_ERROR("[IO] Error: " << request.path << " not found.");
+        return -1;
+    }
+    int fd = fs.my_open(request.path);
+    if (fd < 0) {
+        return -1;
+    }
+    uint64_t offset = static_cast<uint64_t>(std::max<int64_t>(request.offset, 0));
+    int result;
+    if (request.op == IoOp::Read) {
+        request.data.resize(request.len);
+        result = fs.my_pread(fd, request.data.data(), request.len, offset);
+    } else if (request.offset < 0) {
+        result = fs.my_seek(fd, 0, SEEK_END) < 0 ? -1 : fs.my_write(fd, request.data.data(), request.data.size());
+    } else {
+        result = fs.my_pwrite(fd, request.data.data(), request.data.size(), offset);
+    }
+    fs.my_close(fd);
+    return result;
+}
+
+IoStats IoWorkerPool::getStats() const {
+    uint64_t s = submitted.load(std::memory_order_relaxed);
+    uint64_t c = completed.load(std::memory_order_relaxed);
+    uint64_t f = failed.load(std::memory_order_relaxed);
+    return {s, c, f, bytes.load(std::memory_order_relaxed), static_cast<size_t>(s - c - f),
+            static_cast<int>(threads.size()), latencyMicros};
+}
@@ -0,0 +1,275 @@
+#include "../include/Journal.hpp"
+#include "../include/Logger.hpp"
+#include <algorithm>
+#include <cstring>
+
+constexpr std::chrono::milliseconds Journal::COMMIT_INTERVAL;
+
+namespace {
+
+// FNV-1a over whole blocks; a torn transaction fails the commit check
+uint64_t checksum(uint64_t sum, const char* block) {
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        sum = (sum ^ static_cast<unsigned char>(block[i])) * 1099511628211ULL;
+    }
+    return sum;
+}
+
+const uint64_t CHECKSUM_SEED = 14695981039346656037ULL;
+
+}  // namespace
+
+Journal::Journal(BufferCache& cache) :
+  cache(cache),
+  region(0),
+  capacity(0),
+  head(0),
+  seq(1),
+  active(false),
+  stats() {}
+
+bool Journal::writeLog(uint32_t pos, const char* block) {
+    return cache.write((static_cast<size_t>(region) + 1 + pos) * BLOCK_SIZE, block, BLOCK_SIZE);
+}
+
+bool Journal::readLog(uint32_t pos, char* block) {
+    return cache.read((static_cast<size_t>(region) + 1 + pos) * BLOCK_SIZE, block, BLOCK_SIZE);
+}
+
+bool Journal::writeSuper() {
+    char block[BLOCK_SIZE] = {};
+    JournalHeader header = {JOURNAL_MAGIC, JOURNAL_SUPER, seq, 0};
+    std::memcpy(block, &header, sizeof(header));
+    return cache.write(static_cast<size_t>(region) * BLOCK_SIZE, block, BLOCK_SIZE);
+}
+
+void Journal::format(uint32_t start, uint32_t blocks) {
+    region = start;
+    capacity = blocks > 0 ? blocks - 1 : 0;
+    head = 0;
+    seq = 1;
+    if (capacity > 0) {
+        writeSuper();
+    }
+}
+
+int Journal::recover(uint32_t start, uint32_t blocks) {
+    region = start;
+    capacity = blocks > 0 ? blocks - 1 : 0;
+    head = 0;
+    stats.replayed = 0;
+    if (capacity == 0) {
+        return 0;
+    }
+    char block[BLOCK_SIZE];
+    JournalHeader header;
+    cache.read(static_cast<size_t>(region) * BLOCK_SIZE, block, BLOCK_SIZE);
+    std::memcpy(&header, block, sizeof(header));
+    if (header.magic != JOURNAL_MAGIC || header.type != JOURNAL_SUPER) {
+        LOG_WARN("[Journal] No journal superblock, nothing to replay.");
+        seq = 1;
+        return writeSuper() ? 0 : -1;
+    }
+    seq = header.seq;
+
+    // Each pass validates one transaction end to end before replaying it
+    uint32_t pos = 0;
+    for (;;) {
+        std::vector<std::pair<uint32_t, uint32_t>> logged;  // (home, log position)
+        uint64_t sum = CHECKSUM_SEED;
+        uint32_t p = pos;
+        bool committed = false;
+        while (p < capacity && readLog(p, block)) {
+            std::memcpy(&header, block, sizeof(header));
+            if (header.magic != JOURNAL_MAGIC || header.seq != seq) {
+                break;
+            }
+            if (header.type == JOURNAL_COMMIT) {
+                uint64_t stored;
+                std::memcpy(&stored, block + sizeof(header), sizeof(stored));
+                committed = stored == sum && header.count == p - pos;
+                p++;
+                break;
+            }
+            if (header.type != JOURNAL_DESCRIPTOR || header.count > DESCRIPTOR_ENTRIES ||
+                p + 1 + header.count > capacity) {
+                break;
+            }
+            sum = checksum(sum, block);
+            uint32_t homes[DESCRIPTOR_ENTRIES];
+            std::memcpy(homes, block + sizeof(header), header.count * sizeof(uint32_t));
+            p++;
+            for (uint32_t i = 0; i < header.count; ++i, ++p) {
+                readLog(p, block);
+                sum = checksum(sum, block);
+                logged.push_back({homes[i], p});
+            }
+        }
+        if (!committed) {
+            break;
+        }
+        for (const auto& entry : logged) {
+            readLog(entry.second, block);
+            cache.write(static_cast<size_t>(entry.first) * BLOCK_SIZE, block, BLOCK_SIZE);
+        }
+        stats.replayed++;
+        seq++;
+        pos = p;
+    }
+
+    // Replayed blocks reach home before the journal forgets them
+    if (cache.sync() < 0 || !writeSuper() || cache.sync() < 0) {
+        return -1;
+    }
+    if (stats.replayed > 0) {
+        LOG_WARN("[Journal] Replayed " << stats.replayed << " committed transaction(s).");
+    }
+    return static_cast<int>(stats.replayed);
+}
+
+std::vector<char>* Journal::runningBlock(uint32_t block) {
+    auto it = running.find(block);
+    if (it != running.end()) {
+        return &it->second;
+    }
+    if (running.empty()) {
+        opened = std::chrono::steady_clock::now();
+    }
+    std::vector<char>& copy = running[block];
+    copy.resize(BLOCK_SIZE);
+    if (!cache.read(static_cast<size_t>(block) * BLOCK_SIZE, copy.data(), BLOCK_SIZE)) {
+        running.erase(block);
+        return nullptr;
+    }
+    return &copy;
+}
+
+bool Journal::read(size_t offset, char* buffer, size_t len) {
+    if (!active || running.empty()) {
+        return cache.read(offset, buffer, len);
+    }
+    while (len > 0) {
+        size_t within = offset % BLOCK_SIZE;
+        size_t chunk = std::min(len, BLOCK_SIZE - within);
+        auto it = running.find(static_cast<uint32_t>(offset / BLOCK_SIZE));
+        if (it != running.end()) {
+            std::memcpy(buffer, it->second.data() + within, chunk);
+        } else if (!cache.read(offset, buffer, chunk)) {
+            return false;
+        }
+        buffer += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool Journal::write(size_t offset, const char* data, size_t len) {
+    if (!active) {
+        return cache.write(offset, data, len);
+    }
+    while (len > 0) {
+        size_t within = offset % BLOCK_SIZE;
+        size_t chunk = std::min(len, BLOCK_SIZE - within);
+        std::vector<char>* block = runningBlock(static_cast<uint32_t>(offset / BLOCK_SIZE));
+        if (block == nullptr) {
+            return false;
+        }
+        std::memcpy(block->data() + within, data, chunk);
+        data += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return true;
+}
+
+bool Journal::wantsCommit() const {
+    if (!active || running.empty()) {
+        return false;
+    }
+    return running.size() >= capacity / 4 || std::chrono::steady_clock::now() - opened >= COMMIT_INTERVAL;
+}
+
+int Journal::checkpoint() {
+    // Everything logged so far is already home once the cache is flushed
+    int written = cache.sync();
+    if (written < 0 || !writeSuper()) {
+        return -1;
+    }
+    head = 0;
+    stats.checkpoints++;
+    return written;
+}
+
+int Journal::commit() {
+    if (!active || running.empty()) {
+        return cache.sync();
+    }
+
+    // Ordered mode: data (and earlier transactions' home blocks) first
+    int written = cache.sync();
+    if (written < 0) {
+        return -1;
+    }
+    size_t descriptors = (running.size() + DESCRIPTOR_ENTRIES - 1) / DESCRIPTOR_ENTRIES;
+    size_t needed = descriptors + running.size() + 1;
+    if (needed > capacity) {
+        LOG_ERROR("[Journal] Transaction of " << running.size() << " blocks exceeds the journal; writing in place.");
+    } else {
+        if (head + needed > capacity) {
+            // Wrap: the log restarts once the previous transactions are home
+            int flushed = checkpoint();
+            if (flushed < 0) {
+                return -1;
+            }
+            written += flushed;
+        }
+        uint64_t sum = CHECKSUM_SEED;
+        uint32_t pos = head;
+        char block[BLOCK_SIZE];
+        for (auto it = running.begin(); it != running.end();) {
+            size_t count = std::min<size_t>(DESCRIPTOR_ENTRIES, std::distance(it, running.end()));
+            std::memset(block, 0, BLOCK_SIZE);
+            JournalHeader header = {JOURNAL_MAGIC, JOURNAL_DESCRIPTOR, seq, static_cast<uint32_t>(count)};
+            std::memcpy(block, &header, sizeof(header));
+            auto first = it;
+            for (size_t i = 0; i < count; ++i, ++it) {
+                std::memcpy(block + sizeof(header) + i * sizeof(uint32_t), &it->first, sizeof(uint32_t));
+            }
+            sum = checksum(sum, block);
+            writeLog(pos++, block);
+            for (it = first; count-- > 0; ++it) {
+                sum = checksum(sum, it->second.data());
+                writeLog(pos++, it->second.data());
+            }
+        }
+        std::memset(block, 0, BLOCK_SIZE);
+        JournalHeader header = {JOURNAL_MAGIC, JOURNAL_COMMIT, seq, pos - head};
+        std::memcpy(block, &header, sizeof(header));
+        std::memcpy(block + sizeof(header), &sum, sizeof(sum));
+        writeLog(pos++, block);
+        int logged = cache.sync();
+        if (logged < 0) {
+            return -1;
+        }
+        written += logged;
+        stats.blocksLogged += running.size();
+        head = pos;
+        seq++;
+        stats.commits++;
+    }
+
+    // Durable in the log: the home copies may now be written back at any time
+    for (const auto& entry : running) {
+        cache.write(static_cast<size_t>(entry.first) * BLOCK_SIZE, entry.second.data(), BLOCK_SIZE);
+    }
+    running.clear();
+    return written;
+}
+
+JournalStats Journal::getStats() const {
+    JournalStats s = stats;
+    s.running = running.size();
+    s.capacity = capacity;
+    return s;
+}
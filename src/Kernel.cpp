@@ -1,10 +1,47 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <cstdio>
 #include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <sstream>
 #include "../include/Kernel.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Tracer.hpp"
+#include "../include/SlabCache.hpp"
 
-Kernel::Kernel() : nextPid(1), nextThreadId(1), currentTick(0) {
+Kernel::Kernel(const KernelConfig& config) :
+  nextCpu(0),
+  memoryManager(config.allocPolicy, config.memoryBytes),
+  fileSystem("disk.bin", config.diskBytes, config.inodeCount, config.formatDisk),
+  pager(memoryManager, fileSystem, config.pagerPolicy, config.swapBytes),
+  io(fileSystem, std::max(1, std::min(config.numCpus, MAX_CPUS)), config.ioWorkers, config.ioLatencyMicros),
+  shootdown(std::max(1, std::min(config.numCpus, MAX_CPUS))),
+  nextPid(1),
+  nextThreadId(1) {
+    int numCpus = std::max(1, std::min(config.numCpus, MAX_CPUS));
+    pager.setShootdown(&shootdown);
+    for (int i = 0; i < numCpus; ++i) {
+        cpus.emplace_back(new Cpu(i, config.priorityLevels));
+        cpus.back()->scheduler.setQuantum(config.quantum);
+        cpus.back()->scheduler.setPolicy(config.schedPolicy);
+    }
+    if (numCpus > 1) {
+        // Wakeups and priority changes for another CPU's threads go through it
+        std::vector<Scheduler*> schedulers;
+        for (auto& cpu : cpus) {
+            schedulers.push_back(&cpu->scheduler);
+        }
+        for (auto& cpu : cpus) {
+            cpu->scheduler.setPeers(schedulers);
+        }
+    }
+    Logger::configure(numCpus);
+
+    // What every thread did before programs could be loaded: five instructions
+    std::istringstream demo("compute 4\nexit\n");
+    demoProgram = Program::parse("demo", demo);
 }
 
 Kernel::~Kernel() {
@@ -18,7 +55,15 @@ void Kernel::boot() {
     std::cout << "[Kernel] MyOS booting up..." << std::endl;
     std::cout << "[Kernel] Memory Manager initialized." << std::endl;
     std::cout << "[Kernel] File System initialized." << std::endl;
-    std::cout << "[Kernel] Scheduler ready." << std::endl;
+    if (getSchedPolicy() == SchedPolicy::Fair) {
+        std::cout << "[Kernel] Scheduler ready (fair class, " << getQuantum() << "-tick quantum)." << std::endl;
+    } else {
+        std::cout << "[Kernel] Scheduler ready (" << getPriorityLevels()
+                  << " priority levels, " << getQuantum() << "-tick quantum)." << std::endl;
+    }
+    if (cpus.size() > 1) {
+        std::cout << "[Kernel] " << cpus.size() << " CPUs online." << std::endl;
+    }
 }
 
 void Kernel::run() {
@@ -28,69 +73,381 @@ void Kernel::run() {
 }
 
 void Kernel::runCycles(int cycles) {
-    while (cycles > 0) {
-        currentTick++;
-
-        // Wake up sleeping threads
-        auto it = sleepList.begin();
-        while (it != sleepList.end()) {
-            if (currentTick >= it->wakeAtTick) {
-                scheduler.wakeup(it->thread);
-                it = sleepList.erase(it);
-            } else {
-                ++it;
-            }
+    if (cycles <= 0) return;
+
+    uint64_t busyBefore = 0, idleBefore = 0, instrBefore = 0, switchesBefore = 0;
+    for (auto& cpu : cpus) {
+        busyBefore += cpu->busyTicks;
+        idleBefore += cpu->idleTicks;
+        instrBefore += cpu->instructions;
+        switchesBefore += cpu->scheduler.getContextSwitches();
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // Hot-path log records are drained by a background thread during the run
+    Logger::startAsync();
+    io.resume();
+    if (cpus.size() == 1) {
+        runCpu(*cpus[0], cycles);
+        // Back on the shell's own log ring and trace buffer
+        Logger::setCpu(-1);
+        Tracer::setCpu(-1);
+    } else {
+        runParallel(cycles);
+    }
+    // Requests still queued wait for the next run; completions are reaped then
+    io.pause();
+    Logger::stopAsync();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t busy = 0, idle = 0, instructions = 0, switches = 0;
+    for (auto& cpu : cpus) {
+        busy += cpu->busyTicks;
+        idle += cpu->idleTicks;
+        instructions += cpu->instructions;
+        switches += cpu->scheduler.getContextSwitches();
+    }
+    instructions -= instrBefore;
+    if (cpus.size() > 1) {
+        std::cout << "[Kernel] " << instructions << " instructions on " << cpus.size()
+                  << " CPUs in " << seconds * 1000.0 << " ms ("
+                  << static_cast<uint64_t>(instructions / std::max(seconds, 1e-9))
+                  << " instr/s)." << std::endl;
+    }
+    std::cout << "[Kernel] " << (busy - busyBefore) << " busy, " << (idle - idleBefore)
+              << " idle ticks, " << (switches - switchesBefore) << " context switches." << std::endl;
+}
+
+void Kernel::runParallel(int cycles) {
+    // One host thread per simulated CPU
+    for (auto& cpu : cpus) {
+        cpu->busy.store(true, std::memory_order_relaxed);
+    }
+
+    std::vector<std::thread> hostThreads;
+    for (auto& cpu : cpus) {
+        Cpu* c = cpu.get();
+        hostThreads.emplace_back([this, c, cycles] { runCpu(*c, cycles); });
+    }
+    for (auto& t : hostThreads) {
+        t.join();
+    }
+
+    // Threads left in steal queues go back to their owner's run queue so
+    // that ps and kill see them between runs
+    for (auto& cpu : cpus) {
+        Thread* t;
+        while (cpu->stealQueue.pop(t)) {
+            cpu->scheduler.adopt(t, cpu->scheduler);
         }
+    }
+}
+
+void Kernel::runCpu(Cpu& cpu, int cycles) {
+    Logger::setCpu(cpu.id);
+    Tracer::setCpu(cpu.id);
+    uint64_t remaining = cycles;
+    while (remaining > 0) {
+        cpu.tick++;
 
-        scheduler.yield();
+        // Wake up sleeping threads whose deadline is this tick
+        cpu.timers.advance(cpu.tick, [&cpu](Thread* t) { cpu.scheduler.wakeup(t); });
 
-        Thread* current = scheduler.getCurrentThread();
+        // ...and threads whose I/O has completed
+        if (io.hasCompletions(cpu.id)) {
+            io.reap(cpu.id, [this, &cpu](IoCompletion& completion) { completeIo(cpu, completion); });
+        }
+
+        if (cpus.size() > 1) {
+            balance(cpu);
+        }
+
+        cpu.scheduler.schedule();
+
+        Thread* current = cpu.scheduler.getCurrentThread();
         if (current != nullptr) {
-            executeInstruction(current);
+            if (!cpu.busy.load(std::memory_order_relaxed)) {
+                cpu.busy.store(true, std::memory_order_relaxed);
+            }
+            executeInstruction(cpu, current);
+            current->addRunTick();
+            cpu.busyTicks++;
+            remaining--;
+            continue;
+        }
+
+        // Idle: nothing can become runnable before the next timer, so jump
+        // the clock straight there instead of spinning one tick at a time
+        uint64_t skip = 1;
+        if (io.inFlight(cpu.id) > 0) {
+            // A thread here is waiting on the device: wait for it too, one
+            // tick at a time, rather than skip past its completion
+            cpu.busy.store(true, std::memory_order_relaxed);
+            io.waitForCompletion(cpu.id, IO_POLL_MICROS);
+        } else {
+            uint64_t next = cpu.timers.nextEvent();
+            uint64_t own = next == TimerWheel::NEVER ? TimerWheel::NEVER : next - cpu.tick;
+            cpu.idleFor.store(own, std::memory_order_relaxed);
+            cpu.busy.store(false, std::memory_order_release);
+            // A wakeup posted before its poster went idle is seen here
+            if (!cpu.scheduler.hasPosted()) {
+                skip = std::max<uint64_t>(1, std::min(remaining, idleSkip(cpu, own)));
+            }
+        }
+        cpu.tick += skip - 1;
+        cpu.idleTicks += skip;
+        remaining -= skip;
+    }
+    cpu.busy.store(false, std::memory_order_relaxed);
+}
+
+// Clocks are per CPU, so timers are compared by distance from each CPU's
+// own tick as it last published it
+uint64_t Kernel::idleSkip(const Cpu& cpu, uint64_t own) const {
+    uint64_t earliest = own;
+    for (const auto& other : cpus) {
+        if (other.get() == &cpu) {
+            continue;
+        }
+        if (other->busy.load(std::memory_order_acquire)) {
+            return 1;
+        }
+        earliest = std::min(earliest, other->idleFor.load(std::memory_order_relaxed));
+    }
+    return earliest;
+}
+
+// Offer surplus ready threads to other CPUs, or pull work in when idle
+void Kernel::balance(Cpu& cpu) {
+    Thread* current = cpu.scheduler.getCurrentThread();
+    bool running = current != nullptr && current->getState() == ThreadState::RUNNING;
+    size_t runnable = cpu.scheduler.getReadyCount() + (running ? 1 : 0);
+
+    if (runnable == 0) {
+        if (!stealWork(cpu)) {
+            // Idle: let the host run busier CPUs' threads
+            std::this_thread::yield();
+        }
+        return;
+    }
+
+    // The current thread stops running this tick: threads offered earlier
+    // that no one took get back in line, to be picked from with the rest.
+    // While every CPU is busy, none waits in the steal queue for good.
+    if (cpu.scheduler.yieldsNext()) {
+        Thread* parked;
+        while (cpu.stealQueue.pop(parked)) {
+            cpu.scheduler.adopt(parked, cpu.scheduler);
+        }
+        return;
+    }
+
+    // Keep one thread for ourselves; expose the lowest-priority rest to thieves
+    int64_t depth = static_cast<int64_t>(cpus.size()) - 1;
+    while (runnable > 1 && cpu.stealQueue.size() < depth) {
+        Thread* surplus = cpu.scheduler.takeLowest();
+        if (surplus == nullptr) break;
+        cpu.stealQueue.push(surplus);
+        runnable--;
+    }
+}
+
+bool Kernel::stealWork(Cpu& cpu) {
+    Thread* t = nullptr;
+    if (cpu.stealQueue.pop(t)) {
+        cpu.scheduler.adopt(t, cpu.scheduler);
+        return true;
+    }
+    int n = static_cast<int>(cpus.size());
+    for (int i = 1; i < n; ++i) {
+        Cpu& victim = *cpus[(cpu.id + i) % n];
+        if (victim.stealQueue.steal(t)) {
+            cpu.scheduler.adopt(t, victim.scheduler);
+            cpu.steals++;
+            return true;
         }
-        cycles--;
     }
+    return false;
 }
 
-void Kernel::executeInstruction(Thread* current) {
-    std::string name = current->getName();
+void Kernel::executeInstruction(Cpu& cpu, Thread* current) {
+    const Program& program = *current->getProgram();
     int pc = current->getProgramCounter();
-    int tid = current->getId();
-    int pid = current->getParentPid();
-    
-    std::cout << "  [CPU] Thread " << tid << " (PID " << pid << ", " << name << ") executing instruction " << pc << std::endl;
-    
-    // Generic thread simulation - just increment PC
-    current->incrementProgramCounter();
-    
-    // Threads "complete" after 5 instructions for demo
-    if (current->getProgramCounter() >= 5) {
-        std::cout << "  [CPU] Thread " << tid << " (" << name << ") completed!" << std::endl;
-        current->setState(ThreadState::TERMINATED);
+    const Instruction& in = program.at(pc);
+    LOG_DEBUG("  " << cpuTag(cpu) << " Thread " << current->getId() << " (PID "
+              << current->getParentPid() << ", " << current->getName()
+              << ") executing instruction " << pc << " (" << Program::mnemonic(in.op) << ")");
+
+    // Instruction fetch goes through the MMU like any other access
+    if (translate(cpu, current, pc * INSTRUCTION_SIZE, false) == nullptr) {
+        reclaimThread(cpu.scheduler, current);
+        return;
+    }
+    endAccess(cpu);
+    cpu.instructions++;
+
+    // Each case either moves the PC on or leaves it to run again next tick
+    switch (in.op) {
+        case OpCode::Compute:
+            current->setOpTicks(current->getOpTicks() + 1);
+            if (current->getOpTicks() < in.arg) {
+                return;
+            }
+            current->setOpTicks(0);
+            break;
+        case OpCode::Lock:
+            // Blocked: it owns the lock by the time it runs again
+            if (sharedMutex.lock(cpu.scheduler) == LockResult::Spinning) {
+                return;
+            }
+            break;
+        case OpCode::Unlock:
+            sharedMutex.unlock(cpu.scheduler);
+            break;
+        case OpCode::Sleep:
+            current->setProgramCounter(pc + 1);
+            sysSleep(cpu, static_cast<int>(in.arg));
+            return;
+        case OpCode::Alloc: {
+            std::lock_guard<std::mutex> guard(vmLock);
+            void* block = memoryManager.allocate(in.arg);
+            if (block != nullptr) {
+                current->getAllocations().push_back(memoryManager.offsetOf(block));
+            }
+            break;
+        }
+        case OpCode::Free:
+            if (!current->getAllocations().empty()) {
+                std::lock_guard<std::mutex> guard(vmLock);
+                memoryManager.deallocate(memoryManager.at(current->getAllocations().back()));
+                current->getAllocations().pop_back();
+            }
+            break;
+        case OpCode::Read:
+        case OpCode::Write: {
+            // Resumes past the syscall once the I/O completes
+            current->setProgramCounter(pc + 1);
+            bool submitted = in.op == OpCode::Read
+                                 ? sysRead(cpu, program.pathOf(in), in.offset, in.arg, in.len)
+                                 : sysWrite(cpu, program.pathOf(in), in.offset, in.arg, in.len);
+            if (!submitted) {
+                current->setIoResult(-1);
+                if (current->getState() == ThreadState::TERMINATED) {
+                    reclaimThread(cpu.scheduler, current);  // The buffer faulted
+                }
+            }
+            return;
+        }
+        case OpCode::Exit:
+            LOG_DEBUG("  " << cpuTag(cpu) << " Thread " << current->getId() << " ("
+                      << current->getName() << ") completed!");
+            current->setState(ThreadState::TERMINATED);
+            reclaimThread(cpu.scheduler, current);
+            return;
+    }
+    current->setProgramCounter(pc + 1);
+}
+
+// "[CPU]" on a uniprocessor, "[CPUn]" otherwise
+std::string Kernel::cpuTag(const Cpu& cpu) const {
+    return cpus.size() > 1 ? "[CPU" + std::to_string(cpu.id) + "]" : "[CPU]";
+}
+
+char* Kernel::translate(Cpu& cpu, Thread* thread, uint64_t vaddr, bool write) {
+    AddressSpace* space = thread->getAddressSpace();
+    uint64_t vpn = vaddr >> PAGE_SHIFT;
+    size_t frame;
+    pager.record(space->getAsid(), vpn, write);
+
+    shootdown.enter(cpu.id);
+    if (!cpu.tlb.lookup(space->getAsid(), vpn, space->getGeneration(), write, frame)) {
+        // Not inside while waiting for the lock: its holder may be evicting,
+        // and so waiting for this CPU. Holding it, nothing is evicted until
+        // this CPU is back inside.
+        shootdown.leave(cpu.id);
+        std::lock_guard<std::mutex> guard(vmLock);
+        FaultResult result = space->resolve(vpn, write, frame);
+        if (result == FaultResult::Segfault || result == FaultResult::OutOfMemory) {
+            LOG_ERROR("  " << cpuTag(cpu) << " Thread " << thread->getId() << " ("
+                      << thread->getName() << ") "
+                      << (result == FaultResult::Segfault ? "segmentation fault" : "out of memory")
+                      << " at 0x" << std::hex << vaddr << std::dec << ", terminated.");
+            thread->setState(ThreadState::TERMINATED);
+            return nullptr;
+        }
+        if (result != FaultResult::Mapped) {
+            LOG_DEBUG("  " << cpuTag(cpu) << " Page fault: PID " << thread->getParentPid()
+                      << " page " << vpn << " -> frame " << frame
+                      << (result == FaultResult::SwapIn ? " (from swap)" : "")
+                      << (result == FaultResult::CopyOnWrite ? " (copy-on-write)" : ""));
+        }
+        // Copy-on-write pages stay out of the TLB for writes until the copy is made
+        uint32_t flags = space->entry(vpn)->flags;
+        cpu.tlb.insert(space->getAsid(), vpn, space->getGeneration(), frame,
+                       (flags & PTE_DIRTY) && !(flags & PTE_COW));
+        shootdown.enter(cpu.id);
+    }
+    return memoryManager.at(frame) + (vaddr & (PAGE_SIZE - 1));
+}
+
+bool Kernel::touchMemory(int pid, uint64_t vaddr, bool write, FaultResult& result, size_t& frame) {
+    Process* proc = findProcess(pid);
+    if (!proc) {
+        return false;
     }
+    pager.record(pid, vaddr >> PAGE_SHIFT, write);
+    std::lock_guard<std::mutex> guard(vmLock);
+    result = proc->getAddressSpace()->resolve(vaddr >> PAGE_SHIFT, write, frame);
+    return result != FaultResult::Segfault && result != FaultResult::OutOfMemory;
 }
 
-int Kernel::createProcess(const std::string& name) {
+int Kernel::createProcess(const std::string& name, size_t pages) {
     int pid = nextPid++;
     Process* proc = new Process(pid, name);
-    
-    // Allocate memory for the process (64 bytes per process for demo)
-    void* mem = memoryManager.allocate(64);
-    if (mem != nullptr) {
-        // Store offset for display purposes
-        proc->setMemory(0, 64);
-    }
+
+    // Virtual memory only; frames are allocated on first touch
+    proc->setAddressSpace(new AddressSpace(pid, pager, pages));
     
     // Create main thread for the process
     int tid = nextThreadId++;
     Thread* mainThread = new Thread(tid, pid, "main", 0); // HIGH priority for main
-    proc->addThread(mainThread);
-    scheduler.addThread(mainThread);
+    registerThread(proc, mainThread);
     
     processes.push_back(proc);
+    processIndex[pid] = proc;
     return pid;
 }
 
+// fork(): the child shares the parent's frames copy-on-write and gets a copy
+// of each live thread, resuming at the same program counter
+int Kernel::forkProcess(int pid) {
+    Process* parent = findProcess(pid);
+    if (!parent) {
+        return -1;
+    }
+    int childPid = nextPid++;
+    Process* child = new Process(childPid, parent->getName());
+    {
+        std::lock_guard<std::mutex> guard(vmLock);
+        child->setAddressSpace(parent->getAddressSpace()->fork(childPid));
+    }
+
+    for (const Thread* thread : parent->getThreads()) {
+        if (thread->getState() == ThreadState::TERMINATED) {
+            continue;
+        }
+        Thread* copy = new Thread(nextThreadId++, childPid, thread->getName(), thread->getBasePriority());
+        copy->setProgram(thread->getProgram());
+        copy->setProgramCounter(thread->getProgramCounter());
+        copy->setOpTicks(thread->getOpTicks());
+        registerThread(child, copy);
+    }
+
+    processes.push_back(child);
+    processIndex[childPid] = child;
+    return childPid;
+}
+
 int Kernel::spawnThread(int pid, const std::string& name, int priority) {
     Process* proc = findProcess(pid);
     if (!proc) {
@@ -99,23 +456,57 @@ int Kernel::spawnThread(int pid, const std::string& name, int priority) {
     
     int tid = nextThreadId++;
     Thread* thread = new Thread(tid, pid, name, priority);
-    proc->addThread(thread);
-    scheduler.addThread(thread);
+    registerThread(proc, thread);
     
     return tid;
 }
 
+int Kernel::loadProgram(int pid, const std::shared_ptr<const Program>& program) {
+    Process* proc = findProcess(pid);
+    if (!proc) {
+        return -1;
+    }
+    // Code sits at the bottom of the address space: an instruction past the
+    // last page would fault on fetch
+    AddressSpace* space = proc->getAddressSpace();
+    if (space == nullptr || program->size() * INSTRUCTION_SIZE > space->getPageCount() * PAGE_SIZE) {
+        LOG_ERROR("[Kernel] " << program->size() << " instructions do not fit in the "
+                  << (space ? space->getPageCount() : 0) << " pages of PID " << pid);
+        return -2;
+    }
+    int loaded = 0;
+    for (Thread* thread : proc->getThreads()) {
+        if (thread->getState() == ThreadState::BLOCKED) {
+            continue;
+        }
+        Cpu& cpu = *cpus[thread->getCpu()];
+        reclaimThread(cpu.scheduler, thread);
+        thread->setProgram(program);
+        thread->setProgramCounter(0);
+        thread->setOpTicks(0);
+        if (thread->getState() == ThreadState::TERMINATED) {
+            // Having exited on the last cycle, it may still be current
+            cpu.scheduler.removeThread(thread);
+            thread->setState(ThreadState::READY);
+            cpu.scheduler.addThread(thread);
+        }
+        loaded++;
+    }
+    return loaded;
+}
+
 // Legacy spawn - creates a process with a single main thread
 int Kernel::spawnTask(const std::string& name, int priority) {
     int pid = nextPid++;
     Process* proc = new Process(pid, name);
+    proc->setAddressSpace(new AddressSpace(pid, pager, DEFAULT_PROCESS_PAGES));
     
     int tid = nextThreadId++;
     Thread* thread = new Thread(tid, pid, name, priority);
-    proc->addThread(thread);
-    scheduler.addThread(thread);
+    registerThread(proc, thread);
     
     processes.push_back(proc);
+    processIndex[pid] = proc;
     return tid;  // Return thread ID for backward compatibility
 }
 
@@ -128,11 +519,11 @@ void Kernel::listProcesses() {
         std::cout << "│              (no processes running)                    │" << std::endl;
     } else {
         for (const auto* proc : processes) {
-            printf("│ PID %-3d: %-20s [%d threads, %d bytes]  │\n", 
+            printf("│ PID %-3d: %-20s [%d threads, %zu bytes]  │\n", 
                    proc->getPid(), 
                    proc->getName().substr(0, 20).c_str(),
                    proc->getThreadCount(),
-                   proc->getMemorySize());
+                   proc->getAddressSpace()->getResidentPages() * PAGE_SIZE);
             
             const auto& threads = proc->getThreads();
             for (size_t i = 0; i < threads.size(); ++i) {
@@ -142,6 +533,7 @@ void Kernel::listProcesses() {
                     case ThreadState::READY: state = "READY"; break;
                     case ThreadState::RUNNING: state = "RUNNING"; break;
                     case ThreadState::BLOCKED: state = "BLOCKED"; break;
+                    case ThreadState::SLEEPING: state = "SLEEPING"; break;
                     case ThreadState::TERMINATED: state = "DONE"; break;
                 }
                 const char* prefix = (i == threads.size() - 1) ? "└─" : "├─";
@@ -149,7 +541,7 @@ void Kernel::listProcesses() {
                        prefix,
                        t->getId(),
                        t->getName().substr(0, 12).c_str(),
-                       t->getPriority() == 0 ? "HIGH" : "LOW",
+                       priorityLabel(t->getPriority()).c_str(),
                        state.c_str());
             }
         }
@@ -158,42 +550,55 @@ void Kernel::listProcesses() {
 }
 
 void Kernel::listThreads() {
-    std::cout << "\n┌─────┬─────┬────────────────────┬──────────┬──────────┐" << std::endl;
-    std::cout << "│ TID │ PID │ Name               │ Priority │ State    │" << std::endl;
-    std::cout << "├─────┼─────┼────────────────────┼──────────┼──────────┤" << std::endl;
+    std::cout << "\n┌─────┬─────┬────────────────────┬──────────┬──────────┬──────────┬──────────┐" << std::endl;
+    std::cout << "│ TID │ PID │ Name               │ Priority │ State    │ Run      │ Slices   │" << std::endl;
+    std::cout << "├─────┼─────┼────────────────────┼──────────┼──────────┼──────────┼──────────┤" << std::endl;
     
-    auto threads = scheduler.getAllThreads();
-    if (threads.empty()) {
-        std::cout << "│                (no threads running)                    │" << std::endl;
+    bool any = false;
+    for (const auto& cpu : cpus) {
+        any = any || cpu->scheduler.getCurrentThread() != nullptr || cpu->scheduler.getReadyCount() > 0;
+    }
+    if (!any) {
+        std::cout << "│                          (no threads running)                              │" << std::endl;
     } else {
-        for (const auto* thread : threads) {
-            std::string state;
-            switch (thread->getState()) {
-                case ThreadState::READY: state = "READY"; break;
-                case ThreadState::RUNNING: state = "RUNNING"; break;
-                case ThreadState::BLOCKED: state = "BLOCKED"; break;
-                case ThreadState::TERMINATED: state = "DONE"; break;
-            }
-            printf("│ %-3d │ %-3d │ %-18s │ %-8s │ %-8s │\n", 
-                   thread->getId(),
-                   thread->getParentPid(),
-                   thread->getName().substr(0, 18).c_str(),
-                   thread->getPriority() == 0 ? "HIGH" : "LOW",
-                   state.c_str());
+        for (const auto& cpu : cpus) {
+            cpu->scheduler.forEachThread([](const Thread* thread) {
+                std::string state;
+                switch (thread->getState()) {
+                    case ThreadState::READY: state = "READY"; break;
+                    case ThreadState::RUNNING: state = "RUNNING"; break;
+                    case ThreadState::BLOCKED: state = "BLOCKED"; break;
+                    case ThreadState::SLEEPING: state = "SLEEPING"; break;
+                    case ThreadState::TERMINATED: state = "DONE"; break;
+                }
+                printf("│ %-3d │ %-3d │ %-18s │ %-8s │ %-8s │ %-8llu │ %-8llu │\n",
+                       thread->getId(),
+                       thread->getParentPid(),
+                       thread->getName().substr(0, 18).c_str(),
+                       priorityLabel(thread->getPriority()).c_str(),
+                       state.c_str(),
+                       (unsigned long long)thread->getRunTicks(),
+                       (unsigned long long)thread->getSlices());
+            });
         }
     }
-    std::cout << "└─────┴─────┴────────────────────┴──────────┴──────────┘" << std::endl;
+    std::cout << "└─────┴─────┴────────────────────┴──────────┴──────────┴──────────┴──────────┘" << std::endl;
 }
 
 bool Kernel::killThread(int id) {
-    // Find the thread's parent process and remove it
-    for (auto* proc : processes) {
-        if (proc->removeThread(id)) {
-            scheduler.removeThread(id);
-            return true;
-        }
+    auto it = threadIndex.find(id);
+    if (it == threadIndex.end()) {
+        return false;
+    }
+    Thread* thread = it->second;
+    threadIndex.erase(it);
+
+    detachThread(thread);
+    Process* proc = findProcess(thread->getParentPid());
+    if (proc) {
+        proc->removeThread(thread);
     }
-    return scheduler.removeThread(id);
+    return true;
 }
 
 bool Kernel::killProcess(int pid) {
@@ -201,10 +606,14 @@ bool Kernel::killProcess(int pid) {
         if ((*it)->getPid() == pid) {
             // Remove all threads from scheduler
             for (auto* thread : (*it)->getThreads()) {
-                scheduler.removeThread(thread->getId());
+                detachThread(thread);
+                threadIndex.erase(thread->getId());
             }
-            // Note: Memory deallocation would require storing actual pointer
-            // For now, process memory is not reclaimed in this simplified demo
+            // Requests not yet taken by a worker fail; the rest complete
+            // to nobody
+            io.cancel((*it)->getIoRing());
+            // Deleting the process frees its address space and every frame
+            processIndex.erase(pid);
             delete *it;
             processes.erase(it);
             return true;
@@ -213,19 +622,463 @@ bool Kernel::killProcess(int pid) {
     return false;
 }
 
+bool Kernel::sleepThread(int id, int ticks) {
+    auto it = threadIndex.find(id);
+    if (it == threadIndex.end() || ticks <= 0) {
+        return false;
+    }
+    Thread* thread = it->second;
+    if (thread->getState() != ThreadState::READY && thread->getState() != ThreadState::RUNNING) {
+        return false;
+    }
+    Cpu& cpu = *cpus[thread->getCpu()];
+    cpu.scheduler.removeThread(thread);
+    thread->setState(ThreadState::SLEEPING);
+    cpu.timers.insert(thread, cpu.tick + ticks);
+    TRACE_EVENT(TraceEvent::Sleep, 'i', id, ticks);
+    return true;
+}
+
+bool Kernel::setNice(int id, int nice) {
+    auto it = threadIndex.find(id);
+    if (it == threadIndex.end()) {
+        return false;
+    }
+    // Only the weight changes: its place in a run tree stays valid
+    it->second->setNice(nice);
+    return true;
+}
+
+// sleep(ticks) syscall: the thread running on 'cpu' gives up the CPU until
+// its clock has advanced 'ticks' times
+void Kernel::sysSleep(Cpu& cpu, int ticks) {
+    Thread* current = cpu.scheduler.getCurrentThread();
+    if (current == nullptr || ticks <= 0) {
+        return;
+    }
+    current->setState(ThreadState::SLEEPING);
+    cpu.timers.insert(current, cpu.tick + ticks);
+    TRACE_EVENT(TraceEvent::Sleep, 'i', current->getId(), ticks);
+}
+
+bool Kernel::sysRead(Cpu& cpu, const std::string& path, int64_t offset, uint64_t vaddr, size_t len) {
+    Thread* current = cpu.scheduler.getCurrentThread();
+    if (current == nullptr || !queueIo(&cpu, current, {IoOp::Read, 0, 0, path, offset, vaddr, len, {}})) {
+        return false;
+    }
+    cpu.scheduler.blockCurrentThread();
+    return true;
+}
+
+bool Kernel::sysWrite(Cpu& cpu, const std::string& path, int64_t offset, uint64_t vaddr, size_t len) {
+    Thread* current = cpu.scheduler.getCurrentThread();
+    if (current == nullptr || !queueIo(&cpu, current, {IoOp::Write, 0, 0, path, offset, vaddr, len, {}})) {
+        return false;
+    }
+    cpu.scheduler.blockCurrentThread();
+    return true;
+}
+
+bool Kernel::submitIo(int tid, IoOp op, const std::string& path, int64_t offset, uint64_t vaddr, size_t len) {
+    auto it = threadIndex.find(tid);
+    if (it == threadIndex.end()) {
+        return false;
+    }
+    Thread* thread = it->second;
+    if (thread->getState() != ThreadState::READY && thread->getState() != ThreadState::RUNNING) {
+        return false;
+    }
+    if (!queueIo(nullptr, thread, {op, 0, 0, path, offset, vaddr, len, {}})) {
+        return false;
+    }
+    cpus[thread->getCpu()]->scheduler.removeThread(thread);
+    thread->setState(ThreadState::BLOCKED);
+    return true;
+}
+
+bool Kernel::queueIo(Cpu* cpu, Thread* thread, IoRequest&& request) {
+    Process* proc = findProcess(thread->getParentPid());
+    if (proc == nullptr) {
+        return false;
+    }
+    request.tid = thread->getId();
+    request.cpu = cpu ? cpu->id : thread->getCpu();
+    if (request.op == IoOp::Write) {
+        request.data.resize(request.len);
+        if (!copyUser(cpu, thread, request.vaddr, request.data.data(), request.len, false)) {
+            return false;
+        }
+    }
+    bool write = request.op == IoOp::Write;
+    size_t len = request.len;
+    if (!io.submit(proc->getIoRing(), std::move(request))) {
+        LOG_WARN("[Kernel] I/O ring of PID " << proc->getPid() << " is full.");
+        return false;
+    }
+    TRACE_EVENT(TraceEvent::IoSubmit, 'i', thread->getId(), write, len);
+    return true;
+}
+
+// On the CPU that submitted the request: deliver a read's bytes and wake the
+// thread. Threads killed meanwhile are no longer indexed.
+void Kernel::completeIo(Cpu& cpu, IoCompletion& completion) {
+    auto it = threadIndex.find(completion.tid);
+    if (it == threadIndex.end() || it->second->getState() != ThreadState::BLOCKED) {
+        return;
+    }
+    Thread* thread = it->second;
+    if (completion.op == IoOp::Read && completion.result > 0 &&
+        !copyUser(&cpu, thread, completion.vaddr, completion.data.data(), completion.result, true)) {
+        reclaimThread(cpu.scheduler, thread);  // The buffer faulted and the thread was terminated
+        return;
+    }
+    thread->setIoResult(completion.result);
+    TRACE_EVENT(TraceEvent::IoComplete, 'i', completion.tid, completion.result);
+    LOG_DEBUG("  " << cpuTag(cpu) << " Thread " << completion.tid << " "
+              << (completion.op == IoOp::Read ? "read " : "wrote ") << completion.result << " bytes");
+    cpu.scheduler.wakeup(thread);
+}
+
+bool Kernel::copyUser(Cpu* cpu, Thread* thread, uint64_t vaddr, char* buffer, size_t len, bool toUser) {
+    for (size_t done = 0; done < len;) {
+        uint64_t at = vaddr + done;
+        size_t chunk = std::min<size_t>(len - done, PAGE_SIZE - (at & (PAGE_SIZE - 1)));
+        auto copy = [&](char* memory) {
+            if (toUser) {
+                std::memcpy(memory, buffer + done, chunk);
+            } else {
+                std::memcpy(buffer + done, memory, chunk);
+            }
+        };
+        if (cpu != nullptr) {
+            char* memory = translate(*cpu, thread, at, toUser);
+            if (memory == nullptr) {
+                return false;
+            }
+            copy(memory);
+            endAccess(*cpu);
+        } else {
+            // Copied under the lock: the pager only evicts while holding it
+            std::lock_guard<std::mutex> guard(vmLock);
+            size_t frame;
+            FaultResult result = thread->getAddressSpace()->resolve(at >> PAGE_SHIFT, toUser, frame);
+            if (result == FaultResult::Segfault || result == FaultResult::OutOfMemory) {
+                return false;
+            }
+            copy(memoryManager.at(frame) + (at & (PAGE_SIZE - 1)));
+        }
+        done += chunk;
+    }
+    return true;
+}
+
 void Kernel::showMemory() {
     memoryManager.printMemoryMap();
+    std::cout << "--- Pages ---" << std::endl;
+    for (const auto* proc : processes) {
+        const AddressSpace* space = proc->getAddressSpace();
+        std::cout << "PID " << proc->getPid() << " (" << proc->getName() << ") | Resident: "
+                  << space->getResidentPages() << " | Swapped: " << space->getSwappedPages()
+                  << " | Faults: " << space->getFaults() << std::endl;
+    }
+    PagerStats stats = pager.getStats();
+    std::cout << "Total | Resident: " << stats.residentPages << " pages in " << stats.frames << " frames ("
+              << stats.frames * PAGE_SIZE << " bytes) | Swapped: " << stats.swappedPages << " pages" << std::endl;
+    std::cout << "------------------" << std::endl;
+}
+
+bool Kernel::showPageTable(int pid) {
+    Process* proc = findProcess(pid);
+    if (!proc) {
+        return false;
+    }
+    const AddressSpace* space = proc->getAddressSpace();
+    std::cout << "--- Page Table: PID " << pid << " (" << space->getPageCount() << " pages, "
+              << space->getResidentPages() << " resident, " << space->getSwappedPages()
+              << " swapped, " << space->getFaults()
+              << " faults) ---" << std::endl;
+    for (uint64_t vpn = 0; vpn < space->getPageCount(); ++vpn) {
+        const PageTableEntry* pte = space->entry(vpn);
+        if (!(pte->flags & (PTE_PRESENT | PTE_SWAPPED))) {
+            continue;
+        }
+        std::cout << "Page " << vpn << " (0x" << std::hex << (vpn << PAGE_SHIFT) << std::dec << ") -> ";
+        if (pte->flags & PTE_PRESENT) {
+            std::cout << "frame " << pte->frame;
+        } else {
+            std::cout << "swap slot " << pte->slot;
+        }
+        std::cout << " [" << ((pte->flags & PTE_WRITABLE) ? "W" : "-")
+                  << ((pte->flags & PTE_ACCESSED) ? "A" : "-")
+                  << ((pte->flags & PTE_DIRTY) ? "D" : "-")
+                  << ((pte->flags & PTE_SWAPPED) ? "S" : "-")
+                  << ((pte->flags & PTE_COW) ? "C" : "-") << "]" << std::endl;
+    }
+    std::cout << "------------------" << std::endl;
+    return true;
+}
+
+void Kernel::showSwap() {
+    PagerStats stats = pager.getStats();
+    std::cout << "--- Swap ---" << std::endl;
+    std::cout << "Policy: " << pagerPolicyName(pager.getPolicy())
+              << " | Slots: " << stats.swapUsed << "/" << stats.swapSlots
+              << " (" << stats.swapSlots * PAGE_SIZE << " bytes at disk offset " << fileSystem.swapOffset() << ")" << std::endl;
+    std::cout << "Faults: " << stats.faults << " (" << stats.majorFaults << " from swap, "
+              << stats.cowFaults << " copy-on-write)"
+              << " | Page-outs: " << stats.pageOuts
+              << " | Evictions: " << stats.evictions << std::endl;
+    std::cout << "Recording: " << (pager.isRecording() ? "on" : "off")
+              << " (" << pager.getTrace().size() << " references)" << std::endl;
+    std::cout << "------------" << std::endl;
+}
+
+void Kernel::setPagerPolicy(PagerPolicy policy) {
+    std::lock_guard<std::mutex> guard(vmLock);
+    pager.setPolicy(policy);
+}
+
+void Kernel::compareReplacement(const std::vector<PageRef>& trace, size_t frames) {
+    const PagerPolicy policies[] = {PagerPolicy::Fifo, PagerPolicy::Clock, PagerPolicy::Lru, PagerPolicy::Arc};
+    std::cout << "--- Replay: " << trace.size() << " references, " << frames << " frames ---" << std::endl;
+    for (PagerPolicy policy : policies) {
+        ReplayStats stats = replayTrace(policy, trace, frames);
+        double rate = stats.references ? 100.0 * stats.faults / stats.references : 0.0;
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-6s | Faults: %-8llu (%5.1f%%) | Page-ins: %-8llu | Page-outs: %llu",
+                      pagerPolicyName(policy), (unsigned long long)stats.faults, rate,
+                      (unsigned long long)stats.pageIns, (unsigned long long)stats.pageOuts);
+        std::cout << line << std::endl;
+    }
+    std::cout << "------------------" << std::endl;
 }
 
 void Kernel::showFiles() {
     fileSystem.printInodeTable();
+    BufferCacheStats cache = fileSystem.getCacheStats();
+    std::cout << "Buffer cache: " << cache.cached << "/" << cache.capacity << " blocks of " << BLOCK_SIZE
+              << " bytes, " << cache.dirty << " dirty | Hits: " << cache.hits << " | Misses: " << cache.misses
+              << " | Write-backs: " << cache.writebacks << std::endl;
+    DentryCacheStats dentries = fileSystem.getDentryStats();
+    std::cout << "Dentry cache: " << dentries.cached << "/" << dentries.capacity << " names | Hits: " << dentries.hits
+              << " | Misses: " << dentries.misses << std::endl;
+    IoStats aio = io.getStats();
+    std::cout << "Async I/O: " << aio.workers << " workers, " << aio.latencyMicros << " us per request | Submitted: "
+              << aio.submitted << " | Completed: " << aio.completed << " | Failed: " << aio.failed
+              << " | In flight: " << aio.inFlight << " | Bytes: " << aio.bytes << std::endl;
+    JournalStats journal = fileSystem.getJournalStats();
+    if (journal.capacity > 0) {
+        std::cout << "Journal: " << journal.capacity << " blocks, " << journal.running << " in the running transaction"
+                  << " | Commits: " << journal.commits << " | Blocks logged: " << journal.blocksLogged
+                  << " | Checkpoints: " << journal.checkpoints << " | Replayed at mount: " << journal.replayed
+                  << std::endl;
+    }
+}
+
+int Kernel::syncDisk() {
+    return fileSystem.sync();
+}
+
+bool Kernel::checkDisk() {
+    std::vector<std::string> problems;
+    bool clean = fileSystem.check(problems);
+    for (const std::string& problem : problems) {
+        std::cout << "  " << problem << std::endl;
+    }
+    return clean;
 }
 
 Process* Kernel::findProcess(int pid) {
-    for (auto* proc : processes) {
-        if (proc->getPid() == pid) {
-            return proc;
+    auto it = processIndex.find(pid);
+    return it != processIndex.end() ? it->second : nullptr;
+}
+
+void Kernel::registerThread(Process* proc, Thread* thread) {
+    proc->addThread(thread);
+    thread->setAddressSpace(proc->getAddressSpace());
+    if (thread->getProgram() == nullptr) {
+        thread->setProgram(demoProgram);
+    }
+    threadIndex[thread->getId()] = thread;
+    cpus[nextCpu]->scheduler.addThread(thread);
+    nextCpu = (nextCpu + 1) % static_cast<int>(cpus.size());
+}
+
+// Take a thread off its CPU, its timer or whatever queue holds it, and
+// release what it holds
+void Kernel::detachThread(Thread* thread) {
+    Cpu& cpu = *cpus[thread->getCpu()];
+    for (auto& other : cpus) {
+        other->scheduler.cancelPosted(thread);
+    }
+    if (!cpu.scheduler.removeThread(thread) && !cpu.timers.remove(thread)) {
+        Mutex::cancelWait(thread, cpu.scheduler);
+    }
+    reclaimThread(cpu.scheduler, thread);
+}
+
+void Kernel::reclaimThread(Scheduler& scheduler, Thread* thread) {
+    Mutex::releaseAll(thread, scheduler);
+    std::vector<size_t>& allocations = thread->getAllocations();
+    if (!allocations.empty()) {
+        std::lock_guard<std::mutex> guard(vmLock);
+        while (!allocations.empty()) {
+            memoryManager.deallocate(memoryManager.at(allocations.back()));
+            allocations.pop_back();
         }
     }
-    return nullptr;
+}
+
+void Kernel::setQuantum(int ticks) {
+    for (auto& cpu : cpus) {
+        cpu->scheduler.setQuantum(ticks);
+    }
+}
+
+uint64_t Kernel::getIdleTicks() const {
+    uint64_t idle = 0;
+    for (const auto& cpu : cpus) {
+        idle += cpu->idleTicks;
+    }
+    return idle;
+}
+
+uint64_t Kernel::getInstructions() const {
+    uint64_t executed = 0;
+    for (const auto& cpu : cpus) {
+        executed += cpu->instructions;
+    }
+    return executed;
+}
+
+void Kernel::showCpus() {
+    std::cout << "--- CPUs ---" << std::endl;
+    for (const auto& cpu : cpus) {
+        Thread* current = cpu->scheduler.getCurrentThread();
+        std::cout << "CPU" << cpu->id << " | Tick: " << cpu->tick
+                  << " | Running: " << (current ? std::to_string(current->getId()) : "-")
+                  << " | Ready: " << cpu->scheduler.getReadyCount()
+                  << " | Sleeping: " << cpu->timers.size()
+                  << " | Busy: " << cpu->busyTicks
+                  << " | Idle: " << cpu->idleTicks
+                  << " | Instructions: " << cpu->instructions
+                  << " | Switches: " << cpu->scheduler.getContextSwitches()
+                  << " | Steals: " << cpu->steals
+                  << " | TLB: " << cpu->tlb.hits << " hits, " << cpu->tlb.misses << " misses"
+                  << std::endl;
+    }
+    std::cout << "------------" << std::endl;
+}
+
+void Kernel::setSchedPolicy(SchedPolicy policy) {
+    for (auto& cpu : cpus) {
+        cpu->scheduler.setPolicy(policy);
+    }
+}
+
+static const char* stateName(ThreadState state) {
+    switch (state) {
+        case ThreadState::READY: return "READY";
+        case ThreadState::RUNNING: return "RUNNING";
+        case ThreadState::BLOCKED: return "BLOCKED";
+        case ThreadState::SLEEPING: return "SLEEPING";
+        default: return "DONE";
+    }
+}
+
+void Kernel::showSched() {
+    std::cout << "--- Scheduler ---" << std::endl;
+    std::cout << "Class: " << Scheduler::policyName(getSchedPolicy())
+              << " | Quantum: " << getQuantum() << " ticks"
+              << " | Priority levels: " << getPriorityLevels() << std::endl;
+
+    WaitHistogram all;
+    char line[160];
+    for (const auto& cpu : cpus) {
+        const WaitHistogram& waits = cpu->scheduler.getWaits();
+        all.merge(waits);
+        std::snprintf(line, sizeof(line), "CPU%-2d | Waits: %-8llu | p50: %llu | p90: %llu | p99: %llu | max: %llu ticks",
+                      cpu->id, (unsigned long long)waits.count(), (unsigned long long)waits.percentile(50),
+                      (unsigned long long)waits.percentile(90), (unsigned long long)waits.percentile(99),
+                      (unsigned long long)waits.max());
+        std::cout << line << std::endl;
+    }
+    if (cpus.size() > 1) {
+        std::snprintf(line, sizeof(line), "All   | Waits: %-8llu | p50: %llu | p90: %llu | p99: %llu | max: %llu ticks",
+                      (unsigned long long)all.count(), (unsigned long long)all.percentile(50),
+                      (unsigned long long)all.percentile(90), (unsigned long long)all.percentile(99),
+                      (unsigned long long)all.max());
+        std::cout << line << std::endl;
+    }
+
+    std::vector<const Thread*> threads;
+    for (const auto& entry : threadIndex) {
+        threads.push_back(entry.second);
+    }
+    std::sort(threads.begin(), threads.end(),
+              [](const Thread* a, const Thread* b) { return a->getId() < b->getId(); });
+
+    // Threads competing for a CPU now, against the others on the same CPU:
+    // the share of their run ticks each got, and the share its weight is due
+    auto competing = [](const Thread* t) {
+        return t->getState() == ThreadState::READY || t->getState() == ThreadState::RUNNING;
+    };
+    struct Competition {
+        uint64_t run;
+        double weight;
+    };
+    std::vector<Competition> perCpu;
+    perCpu.assign(cpus.size(), Competition{0, 0});
+    for (const Thread* t : threads) {
+        if (competing(t)) {
+            perCpu[t->getCpu()].run += t->getRunTicks();
+            perCpu[t->getCpu()].weight += Scheduler::niceWeight(t->getNice());
+        }
+    }
+
+    std::cout << "TID   CPU  Nice  Weight  State     Run         Share   Expected  Vruntime      Avg wait" << std::endl;
+    double sum = 0, sumSquares = 0;
+    int n = 0;
+    for (const Thread* t : threads) {
+        int weight = Scheduler::niceWeight(t->getNice());
+        char share[16] = "-", expected[16] = "-";
+        const Competition& cpu = perCpu[t->getCpu()];
+        if (competing(t) && cpu.run > 0) {
+            double got = static_cast<double>(t->getRunTicks()) / cpu.run;
+            double due = weight / cpu.weight;
+            std::snprintf(share, sizeof(share), "%.1f%%", 100.0 * got);
+            std::snprintf(expected, sizeof(expected), "%.1f%%", 100.0 * due);
+            sum += got / due;
+            sumSquares += (got / due) * (got / due);
+            n++;
+        }
+        std::snprintf(line, sizeof(line), "%-5d %-4d %-5d %-7d %-9s %-11llu %-7s %-9s %-13.1f %.1f",
+                      t->getId(), t->getCpu(), t->getNice(), weight, stateName(t->getState()),
+                      (unsigned long long)t->getRunTicks(), share, expected,
+                      static_cast<double>(t->getVruntime()) / Scheduler::VRUNTIME_TICK,
+                      t->getSlices() ? static_cast<double>(t->getWaitTicks()) / t->getSlices() : 0.0);
+        std::cout << line << std::endl;
+    }
+    if (n > 0 && sumSquares > 0) {
+        // Jain's index of share got over share due: 1.0 when every competing
+        // thread got exactly its due, 1/n when one got it all
+        std::snprintf(line, sizeof(line), "Fairness (Jain, %d competing threads): %.3f", n,
+                      sum * sum / (n * sumSquares));
+        std::cout << line << std::endl;
+    }
+    std::cout << "------------" << std::endl;
+}
+
+void Kernel::showSlabs() {
+    std::cout << "--- Slab Caches ---" << std::endl;
+    for (const SlabCache* cache : SlabCache::all()) {
+        SlabStats s = cache->stats();
+        std::cout << s.name << " | Object: " << s.objectSize << " B"
+                  << " | Slabs: " << s.slabs
+                  << " | In use: " << s.inUse << "/" << s.capacity
+                  << " | Depot free: " << s.depotFree
+                  << " | Allocs: " << s.allocs
+                  << " | Depot trips: " << s.depotTrips << std::endl;
+    }
+    std::cout << "-------------------" << std::endl;
 }
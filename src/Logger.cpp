@@ -0,0 +1,176 @@
+#include "../include/Logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+int Logger::level = static_cast<int>(LogLevel::Debug);
+
+namespace {
+
+const size_t RECORD_TEXT = 254;
+const size_t RING_CAPACITY = 1024;  // Records per ring, power of two
+// A longer line takes several consecutive records; all but the last have
+// this bit set in their length. Past a quarter of the ring it is cut.
+const uint16_t CONTINUED = 0x8000;
+const size_t MAX_PIECES = RING_CAPACITY / 4;
+const char TRUNCATED[] = " [truncated]";
+
+struct LogRecord {
+    uint16_t length;
+    char text[RECORD_TEXT];
+};
+
+// Single-producer single-consumer ring; the consumer holds drainLock
+struct LogRing {
+    alignas(64) std::atomic<size_t> head{0};  // Next slot to write
+    alignas(64) std::atomic<size_t> tail{0};  // Next slot to drain
+    LogRecord records[RING_CAPACITY];
+};
+
+// rings[0..n-1] belong to CPUs, the last one is shared by every other host thread
+std::vector<std::unique_ptr<LogRing>> rings;
+std::mutex sharedRingLock;
+std::mutex drainLock;
+std::atomic<bool> async(false);
+std::atomic<bool> stopping(false);
+std::thread drainThread;
+thread_local int ringIndex = -1;
+
+bool drainAll() {
+    bool any = false;
+    for (auto& ring : rings) {
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const LogRecord& rec = ring->records[tail & (RING_CAPACITY - 1)];
+            std::cout.write(rec.text, rec.length & ~CONTINUED);
+            if (!(rec.length & CONTINUED)) {
+                std::cout.put('\n');
+            }
+            any = true;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    if (any) {
+        std::cout.flush();
+    }
+    return any;
+}
+
+void drainLoop() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        bool any;
+        {
+            std::lock_guard<std::mutex> guard(drainLock);
+            any = drainAll();
+        }
+        if (!any) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
+// Every piece of a line is published at once, so the drain never prints
+// half of it with another ring's records in between
+void push(LogRing& ring, const std::string& line) {
+    size_t pieces = std::max<size_t>(1, (line.size() + RECORD_TEXT - 1) / RECORD_TEXT);
+    std::string cut;
+    const std::string* text = &line;
+    if (pieces > MAX_PIECES) {
+        pieces = MAX_PIECES;
+        cut = line.substr(0, pieces * RECORD_TEXT - (sizeof(TRUNCATED) - 1)) + TRUNCATED;
+        text = &cut;
+    }
+
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    while (head + pieces - ring.tail.load(std::memory_order_acquire) > RING_CAPACITY) {
+        if (async.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+        } else {
+            std::lock_guard<std::mutex> guard(drainLock);
+            drainAll();
+        }
+    }
+    for (size_t i = 0; i < pieces; ++i) {
+        LogRecord& rec = ring.records[(head + i) & (RING_CAPACITY - 1)];
+        size_t offset = i * RECORD_TEXT;
+        size_t length = std::min(text->size() - offset, RECORD_TEXT);
+        std::memcpy(rec.text, text->data() + offset, length);
+        rec.length = static_cast<uint16_t>(length) | (i + 1 < pieces ? CONTINUED : 0);
+    }
+    ring.head.store(head + pieces, std::memory_order_release);
+}
+
+}  // namespace
+
+void Logger::configure(int numCpus) {
+    std::lock_guard<std::mutex> guard(drainLock);
+    size_t wanted = static_cast<size_t>(std::max(numCpus, 1)) + 1;
+    drainAll();
+    while (rings.size() < wanted) {
+        rings.emplace_back(new LogRing());
+    }
+}
+
+void Logger::setCpu(int cpu) {
+    ringIndex = cpu;
+}
+
+void Logger::write(LogLevel, const std::string& line) {
+    if (rings.empty()) {
+        configure(1);
+    }
+    if (ringIndex >= 0 && ringIndex < static_cast<int>(rings.size()) - 1) {
+        push(*rings[ringIndex], line);
+    } else {
+        std::lock_guard<std::mutex> guard(sharedRingLock);
+        push(*rings.back(), line);
+    }
+
+    if (!async.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(drainLock);
+        drainAll();
+    }
+}
+
+void Logger::startAsync() {
+    if (async.exchange(true)) {
+        return;
+    }
+    stopping.store(false, std::memory_order_release);
+    drainThread = std::thread(drainLoop);
+}
+
+void Logger::stopAsync() {
+    if (!async.load()) {
+        return;
+    }
+    stopping.store(true, std::memory_order_release);
+    drainThread.join();
+    async.store(false);
+    std::lock_guard<std::mutex> guard(drainLock);
+    drainAll();
+}
+
+const char* Logger::levelName(int l) {
+    static const char* names[] = {"off", "error", "warn", "info", "debug", "trace"};
+    return names[std::max(0, std::min(l, 5))];
+}
+
+int Logger::parseLevel(const std::string& name) {
+    if (name == "quiet") {
+        return static_cast<int>(LogLevel::Warn);
+    }
+    for (int l = 0; l <= 5; ++l) {
+        if (name == levelName(l)) {
+            return l;
+        }
+    }
+    return -1;
+}
@@ -1,101 +1,113 @@
 #include "../include/MemoryManager.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Tracer.hpp"
+#include <algorithm>
 #include <iostream>
 
-MemoryManager::MemoryManager() {
-    // Initialize RAM with 0
-    ram.resize(MAX_MEMORY, 0);
-
-    // Initially, one large free block covering simulated RAM
-    memoryList.push_back({0, MAX_MEMORY, true});
-    std::cout << "[MemoryManager] Initialized with " << MAX_MEMORY << " bytes." << std::endl;
+MemoryManager::MemoryManager(AllocPolicy policy, size_t capacity) : ram(capacity), policy(policy) {
+    switch (policy) {
+        case AllocPolicy::Segregated:
+            allocator.reset(new SegregatedAllocator(ram.data(), capacity));
+            break;
+        case AllocPolicy::Buddy:
+            allocator.reset(new BuddyAllocator(ram.data(), capacity));
+            break;
+        default:
+            allocator.reset(new FirstFitAllocator(ram.data(), capacity));
+            break;
+    }
+    LOG_INFO("[MemoryManager] Initialized with " << capacity << " bytes.");
 }
 
 void* MemoryManager::allocate(size_t size) {
-    if (size == 0) return nullptr;
-
-    // First-Fit Algorithm
-    for (auto it = memoryList.begin(); it != memoryList.end(); ++it) {
-        if (it->isFree && it->size >= size) {
-            // Found a suitable block
-            
-            // Check if we need to split it (if it's bigger than needed)
-            if (it->size > size) {
-                // Create a new block for the remaining free space
-                MemoryBlock newBlock;
-                newBlock.offset = it->offset + size;
-                newBlock.size = it->size - size;
-                newBlock.isFree = true;
-                
-                // Insert new block after current
-                memoryList.insert(std::next(it), newBlock);
-            }
+    void* ptr = tryAllocate(size);
+    if (ptr == nullptr && size != 0) {
+        LOG_WARN("[MemoryManager] Allocation failed: Not enough contiguous memory for " << size << " bytes.");
+    }
+    return ptr;
+}
 
-            // Update current block to be allocated
-            it->size = size;
-            it->isFree = false;
+void* MemoryManager::tryAllocate(size_t size) {
+    if (size == 0) return nullptr;
 
-            std::cout << "[MemoryManager] Allocated " << size << " bytes at offset " << it->offset << "." << std::endl;
-            
-            // Return pointer to the start of this block in RAM
-            return &ram[it->offset];
-        }
+    size_t offset = allocator->allocate(size);
+    if (offset == Allocator::NONE) {
+        TRACE_EVENT(TraceEvent::Alloc, 'i', 0, size, UINT64_MAX);
+        return nullptr;
     }
 
-    std::cout << "[MemoryManager] Allocation failed: Not enough contiguous memory for " << size << " bytes." << std::endl;
-    return nullptr;
+    TRACE_EVENT(TraceEvent::Alloc, 'i', 0, size, offset);
+    LOG_INFO("[MemoryManager] Allocated " << size << " bytes at offset " << offset << ".");
+
+    // Return pointer to the start of this block in RAM
+    return ram.data() + offset;
 }
 
 void MemoryManager::deallocate(void* ptr) {
     if (ptr == nullptr) return;
 
-    // Calculate offset
-    // Note: This assumes ptr is within &ram[0] and &ram[MAX]
-    // In a real OS, verify this.
-    char* ramStart = &ram[0];
+    char* ramStart = ram.data();
     char* ptrChar = static_cast<char*>(ptr);
-    
-    if (ptrChar < ramStart || ptrChar >= ramStart + MAX_MEMORY) {
-        std::cout << "[MemoryManager] Error: Invalid pointer free request." << std::endl;
+
+    if (ptrChar < ramStart || ptrChar >= ramStart + ram.size()) {
+        LOG_ERROR("[MemoryManager] Error: Invalid pointer free request.");
         return;
     }
 
     size_t offset = ptrChar - ramStart;
+    size_t size = allocator->release(offset);
+    if (size == 0) {
+        LOG_ERROR("[MemoryManager] Error: No allocated block at offset " << offset << " (double free?).");
+        return;
+    }
+    TRACE_EVENT(TraceEvent::Free, 'i', 0, offset, size);
+    LOG_INFO("[MemoryManager] Freed block at offset " << offset << " (" << size << " bytes).");
+}
 
-    // Find the block in the list
-    for (auto it = memoryList.begin(); it != memoryList.end(); ++it) {
-        if (it->offset == offset) {
-            if (it->isFree) {
-                std::cout << "[MemoryManager] Error: Double free at offset " << offset << "." << std::endl;
-                return;
-            }
-
-            it->isFree = true;
-            std::cout << "[MemoryManager] Freed block at offset " << offset << " (" << it->size << " bytes)." << std::endl;
+MemoryStats MemoryManager::getStats() const {
+    std::vector<MemoryBlock> blocks;
+    allocator->blocks(blocks);
+    MemoryStats stats = {ram.size(), 0, 0, 0, 0, 0};
+    for (const auto& block : blocks) {
+        if (block.isFree) {
+            stats.freeBytes += block.size;
+            stats.largestFree = std::max(stats.largestFree, block.size);
+            stats.freeBlocks++;
+        } else {
+            stats.usedBytes += block.size;
+            stats.usedBlocks++;
+        }
+    }
+    return stats;
+}
 
-            // Coalesce (Merge) with next block if free
-            auto nextIt = std::next(it);
-            if (nextIt != memoryList.end() && nextIt->isFree) {
-                 it->size += nextIt->size;
-                 memoryList.erase(nextIt);
-            }
+const char* MemoryManager::policyName(AllocPolicy policy) {
+    switch (policy) {
+        case AllocPolicy::Segregated: return "segregated";
+        case AllocPolicy::Buddy: return "buddy";
+        default: return "first-fit";
+    }
+}
 
-            // Coalesce with previous block if free
-            if (it != memoryList.begin()) {
-                auto prevIt = std::prev(it);
-                if (prevIt->isFree) {
-                    prevIt->size += it->size;
-                    memoryList.erase(it);
-                }
-            }
-            return;
-        }
+bool MemoryManager::parsePolicy(const std::string& name, AllocPolicy& policy) {
+    if (name == "first" || name == "first-fit") {
+        policy = AllocPolicy::FirstFit;
+    } else if (name == "seg" || name == "segregated") {
+        policy = AllocPolicy::Segregated;
+    } else if (name == "buddy") {
+        policy = AllocPolicy::Buddy;
+    } else {
+        return false;
     }
-     std::cout << "[MemoryManager] Error: Block not found for pointer." << std::endl;
+    return true;
 }
 
 void MemoryManager::printMemoryMap() {
+    std::vector<MemoryBlock> blocks;
+    allocator->blocks(blocks);
     std::cout << "--- Memory Map ---" << std::endl;
-    for (const auto& block : memoryList) {
+    std::cout << "Policy: " << allocator->name() << std::endl;
+    for (const auto& block : blocks) {
         std::cout << "[" << (block.isFree ? "FREE" : "USED") 
                   << "] Offset: " << block.offset 
                   << ", Size: " << block.size << std::endl;
@@ -1,50 +1,195 @@
-#include <iostream>
 #include "../include/Mutex.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Tracer.hpp"
 
-Mutex::Mutex() : locked(false), owner(nullptr) {}
+std::mutex Mutex::hostLock;
 
-bool Mutex::lock(Scheduler& scheduler) {
+Mutex::Mutex(bool priorityInheritance, bool adaptiveSpin) :
+  owner(nullptr),
+  waiters(this),
+  nextHeld(nullptr),
+  inherit(priorityInheritance),
+  spin(adaptiveSpin),
+  spinAverage(0),
+  stats() {}
+
+LockResult Mutex::lock(Scheduler& scheduler) {
     Thread* current = scheduler.getCurrentThread();
-    if (current == nullptr) return false;
+    if (current == nullptr) return LockResult::Blocked;
 
-    if (locked && owner == current) {
-        return true; // recursive lock or handoff
+    std::lock_guard<std::mutex> guard(hostLock);
+    if (owner == current) {
+        return LockResult::Acquired; // recursive lock or handoff
     }
 
-    if (!locked) {
-        locked = true;
-        owner = current;
-        std::cout << "[Mutex] Thread " << current->getId() << " acquired lock." << std::endl;
-        return true; // Acquired
-    } else {
-        std::cout << "[Mutex] Thread " << current->getId() << " blocked waiting for lock (held by " << (owner ? std::to_string(owner->getId()) : "Unknown") << ")." << std::endl;
-        waitingQueue.push(current);
-        scheduler.blockCurrentThread();
-        return false; // Blocked
+    if (owner == nullptr) {
+        if (current->spinTicks > 0) {
+            stats.spinAcquires++;
+            adapt(current->spinTicks);
+            current->spinTicks = 0;
+        }
+        take(current);
+        TRACE_EVENT(TraceEvent::MutexAcquire, 'i', current->getId());
+        LOG_INFO("[Mutex] Thread " << current->getId() << " acquired lock.");
+        return LockResult::Acquired;
+    }
+
+    if (current->spinTicks == 0) {
+        stats.contentions++;
+        TRACE_EVENT(TraceEvent::MutexContend, 'i', current->getId(), owner->getId());
+    }
+    // A running owner (on another CPU) may well release before a block and
+    // wakeup would have got this thread back on its CPU
+    if (spin && owner->getState() == ThreadState::RUNNING && current->spinTicks < spinLimit()) {
+        current->spinTicks++;
+        return LockResult::Spinning;
     }
+    if (current->spinTicks > 0) {
+        adapt(current->spinTicks);
+        current->spinTicks = 0;
+    }
+
+    LOG_INFO("[Mutex] Thread " << current->getId() << " blocked waiting for lock (held by " << owner->getId() << ").");
+    waiters.insertByPriority(current);
+    current->waitingFor = this;
+    scheduler.blockCurrentThread();
+    stats.blocks++;
+    if (inherit) {
+        boost(scheduler, current->getPriority());
+    }
+    return LockResult::Blocked;
 }
 
 void Mutex::unlock(Scheduler& scheduler) {
     Thread* current = scheduler.getCurrentThread();
+    std::lock_guard<std::mutex> guard(hostLock);
     if (owner != current) {
         // Technically should be an error if non-owner tries to unlock
-        std::cout << "[Mutex] Error: Thread " << (current ? std::to_string(current->getId()) : "null") << " tried to unlock mutex owned by " << (owner ? std::to_string(owner->getId()) : "null") << std::endl;
+        LOG_ERROR("[Mutex] Error: Thread " << (current ? std::to_string(current->getId()) : "null") << " tried to unlock mutex owned by " << (owner ? std::to_string(owner->getId()) : "null"));
         return;
     }
 
-    std::cout << "[Mutex] Thread " << current->getId() << " releasing lock." << std::endl;
-    
-    if (!waitingQueue.empty()) {
-        Thread* next = waitingQueue.front();
-        waitingQueue.pop();
-        
+    LOG_INFO("[Mutex] Thread " << current->getId() << " releasing lock.");
+    release(current, scheduler);
+}
+
+void Mutex::releaseAll(Thread* thread, Scheduler& scheduler) {
+    std::lock_guard<std::mutex> guard(hostLock);
+    while (thread->heldMutexes != nullptr) {
+        thread->heldMutexes->release(thread, scheduler);
+    }
+}
+
+bool Mutex::cancelWait(Thread* thread, Scheduler& scheduler) {
+    std::lock_guard<std::mutex> guard(hostLock);
+    Mutex* mutex = thread->waitingFor;
+    if (mutex == nullptr) {
+        return false;
+    }
+    mutex->waiters.remove(thread);
+    thread->waitingFor = nullptr;
+    if (!mutex->inherit) {
+        return true;
+    }
+    // Each owner down the chain falls back to what its remaining waiters
+    // are owed, and its place in the queue it waits in moves with it
+    while (mutex != nullptr && mutex->owner != nullptr) {
+        Thread* holder = mutex->owner;
+        int owed = owedPriority(holder);
+        if (owed == holder->getPriority()) {
+            break;
+        }
+        LOG_INFO("[Mutex] Thread " << holder->getId() << " drops to priority "
+                 << priorityLabel(owed) << " after a waiter was killed.");
+        scheduler.setPriority(holder, owed);
+        mutex = holder->waitingFor;
+        if (mutex != nullptr) {
+            mutex->waiters.remove(holder);
+            mutex->waiters.insertByPriority(holder);
+        }
+    }
+    return true;
+}
+
+void Mutex::take(Thread* thread) {
+    owner = thread;
+    nextHeld = thread->heldMutexes;
+    thread->heldMutexes = this;
+    stats.acquisitions++;
+}
+
+void Mutex::release(Thread* holder, Scheduler& scheduler) {
+    Mutex** link = &holder->heldMutexes;
+    while (*link != this) {
+        link = &(*link)->nextHeld;
+    }
+    *link = nextHeld;
+    nextHeld = nullptr;
+    owner = nullptr;
+
+    Thread* next = waiters.popFront();
+    if (next != nullptr) {
         // Handover ownership directly to the next thread
-        owner = next;
-        scheduler.wakeup(next);
-        std::cout << "[Mutex] Ownership transferred to Thread " << next->getId() << "." << std::endl;
-        // locked remains true
+        next->waitingFor = nullptr;
+        take(next);
+    }
+    if (inherit) {
+        // The holder keeps what its other mutexes' waiters are owed; the new
+        // owner takes on the waiters still queued here
+        if (owedPriority(holder) != holder->getPriority()) {
+            scheduler.setPriority(holder, owedPriority(holder));
+        }
+        if (next != nullptr && owedPriority(next) < next->getPriority()) {
+            scheduler.setPriority(next, owedPriority(next));
+        }
+    }
+
+    if (next != nullptr) {
+        TRACE_EVENT(TraceEvent::MutexRelease, 'i', holder->getId(), next->getId());
+        TRACE_EVENT(TraceEvent::MutexAcquire, 'i', next->getId());
+        scheduler.wakeupAnywhere(next);
+        LOG_INFO("[Mutex] Ownership transferred to Thread " << next->getId() << ".");
     } else {
-        locked = false;
-        owner = nullptr;
+        TRACE_EVENT(TraceEvent::MutexRelease, 'i', holder->getId());
     }
 }
+
+// Raise the owner to 'priority', then the owner of whatever mutex it is
+// itself waiting for, and so on
+void Mutex::boost(Scheduler& scheduler, int priority) {
+    Mutex* mutex = this;
+    while (mutex != nullptr && mutex->owner != nullptr && priority < mutex->owner->getPriority()) {
+        Thread* holder = mutex->owner;
+        LOG_INFO("[Mutex] Thread " << holder->getId() << " inherits priority "
+                 << priorityLabel(priority) << " from a waiter.");
+        scheduler.setPriority(holder, priority);
+        mutex->stats.boosts++;
+        mutex = holder->waitingFor;
+        if (mutex != nullptr) {
+            // Its place in that wait queue moves up with it
+            mutex->waiters.remove(holder);
+            mutex->waiters.insertByPriority(holder);
+        }
+    }
+}
+
+// Base priority, raised to that of the first waiter on each mutex it holds
+int Mutex::owedPriority(const Thread* thread) {
+    int priority = thread->getBasePriority();
+    for (const Mutex* m = thread->heldMutexes; m != nullptr; m = m->nextHeld) {
+        if (!m->waiters.empty()) {
+            priority = std::min(priority, m->waiters.front()->getPriority());
+        }
+    }
+    return priority;
+}
+
+// Twice the recent average wait, so a spinner usually outlasts the hold
+// time it expects, within fixed bounds
+int Mutex::spinLimit() const {
+    return std::min(MAX_SPIN_TICKS, MIN_SPIN_TICKS + 2 * spinAverage / 8);
+}
+
+void Mutex::adapt(int ticks) {
+    spinAverage += ticks - spinAverage / 8;
+}
@@ -0,0 +1,273 @@
+#include "../include/Pager.hpp"
+#include "../include/AddressSpace.hpp"
+#include "../include/FileSystem.hpp"
+#include "../include/MemoryManager.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Tlb.hpp"
+#include "../include/Tracer.hpp"
+#include <algorithm>
+#include <fstream>
+
+Pager::Pager(MemoryManager& memory, FileSystem& disk, PagerPolicy policy, size_t swapBytes) :
+  memory(memory),
+  disk(disk),
+  policyId(policy),
+  policy(makeReplacementPolicy(policy)),
+  frameTable((memory.getCapacity() / 16 + 1) * sizeof(FrameInfo)),
+  slotRefs(swapBytes / PAGE_SIZE, 0),
+  swapSlots(swapBytes / PAGE_SIZE),
+  counters(),
+  shootdown(nullptr),
+  recording(false) {
+    // Hand out low slots first
+    for (size_t slot = swapSlots; slot > 0; --slot) {
+        freeSlots.push_back(static_cast<uint32_t>(slot - 1));
+    }
+    counters.swapSlots = swapSlots;
+    LOG_INFO("[Pager] " << swapSlots << " swap slots at disk offset " << disk.swapOffset()
+             << ", " << this->policy->name() << " replacement.");
+}
+
+void Pager::attach(AddressSpace* space) {
+    spaces[space->getAsid()] = space;
+    families[space->getFamily()].push_back(space);
+}
+
+void Pager::detach(AddressSpace* space) {
+    spaces.erase(space->getAsid());
+    std::vector<AddressSpace*>& family = families[space->getFamily()];
+    family.erase(std::find(family.begin(), family.end(), space));
+    if (family.empty()) {
+        families.erase(space->getFamily());
+    }
+}
+
+void Pager::mappers(int family, uint64_t vpn, size_t frame, std::vector<AddressSpace*>& out) const {
+    out.clear();
+    for (AddressSpace* space : families.at(family)) {
+        const PageTableEntry* pte = space->entry(vpn);
+        if (pte != nullptr && (pte->flags & PTE_PRESENT) && pte->frame == frame) {
+            out.push_back(space);
+        }
+    }
+}
+
+size_t Pager::allocateFrame(int asid, uint64_t vpn) {
+    for (;;) {
+        void* frame = memory.tryAllocate(PAGE_SIZE);
+        if (frame != nullptr) {
+            return memory.offsetOf(frame);
+        }
+        if (!evictOne(pageKey(asid, vpn))) {
+            return NONE;
+        }
+    }
+}
+
+bool Pager::evictOne(uint64_t incoming) {
+    // Dirty victims that do not fit in swap go back to the policy; give up
+    // once every resident page has been tried
+    for (size_t attempts = policy->size(); attempts > 0; --attempts) {
+        uint64_t page = policy->victim(*this, incoming);
+        auto it = spaces.find(pageAsid(page));
+        if (it != spaces.end() && evict(*it->second, pageVpn(page))) {
+            counters.evictions++;
+            return true;
+        }
+        policy->inserted(page);
+    }
+    return false;
+}
+
+// Unmap the page from every address space sharing its frame, writing it to
+// swap first if it is dirty. Sharers are never dirty (writes break the
+// sharing), so they agree on whether the frame needs writing.
+bool Pager::evict(AddressSpace& space, uint64_t vpn) {
+    size_t frame = space.entry(vpn)->frame;
+    std::vector<AddressSpace*> holders;
+    mappers(space.getFamily(), vpn, frame, holders);
+
+    bool dirty = (space.entry(vpn)->flags & PTE_DIRTY) != 0;
+    if (dirty && freeSlots.empty()) {
+        return false;
+    }
+
+    // Other CPUs may still be copying through translations they cached:
+    // drop those and wait for the copies to finish, so the contents written
+    // to swap are final and nobody touches the frame once it is reused. New
+    // translations need vmLock, which the caller holds.
+    for (AddressSpace* holder : holders) {
+        holder->invalidate();
+    }
+    if (shootdown != nullptr) {
+        shootdown->wait();
+    }
+
+    uint32_t slot = 0;
+    if (dirty) {
+        slot = freeSlots.back();
+        if (!disk.writeBlock(disk.swapOffset() + slot * PAGE_SIZE, memory.at(frame), PAGE_SIZE)) {
+            return false;
+        }
+        freeSlots.pop_back();
+        slotRefs[slot] = static_cast<uint32_t>(holders.size());
+        counters.pageOuts++;
+        TRACE_EVENT(TraceEvent::PageOut, 'i', space.getAsid(), vpn, slot);
+        LOG_DEBUG("[Pager] Paged out PID " << space.getAsid() << " page " << vpn << " to slot " << slot);
+    }
+    // A clean page either has a current swap copy or was never written, in
+    // which case the next touch demand-zeroes it again
+    for (AddressSpace* holder : holders) {
+        holder->unmapPage(vpn, dirty, slot);
+    }
+    release(frame);
+    return true;
+}
+
+void Pager::release(size_t frame) {
+    info(frame) = {0, 0};
+    counters.frames--;
+    memory.deallocate(memory.at(frame));
+}
+
+void Pager::discardFrame(size_t frame) {
+    memory.deallocate(memory.at(frame));
+}
+
+void Pager::mapped(int asid, uint64_t vpn, size_t frame, bool copied) {
+    info(frame) = {1, asid};
+    counters.frames++;
+    counters.faults++;
+    counters.cowFaults += copied;
+    policy->inserted(pageKey(asid, vpn));
+}
+
+void Pager::referenced(uint64_t vpn, size_t frame) {
+    policy->referenced(pageKey(info(frame).owner, vpn));
+}
+
+void Pager::unmap(int asid, uint64_t vpn, size_t frame) {
+    FrameInfo& fi = info(frame);
+    if (--fi.refs == 0) {
+        policy->removed(pageKey(asid, vpn));
+        release(frame);
+        return;
+    }
+    if (fi.owner == asid) {
+        // Hand the frame's policy entry to another sharer
+        std::vector<AddressSpace*> holders;
+        mappers(spaces.at(asid)->getFamily(), vpn, frame, holders);
+        for (AddressSpace* holder : holders) {
+            if (holder->getAsid() != asid) {
+                policy->removed(pageKey(asid, vpn));
+                policy->inserted(pageKey(holder->getAsid(), vpn));
+                fi.owner = holder->getAsid();
+                break;
+            }
+        }
+    }
+}
+
+char* Pager::frameData(size_t frame) const {
+    return memory.at(frame);
+}
+
+bool Pager::swapIn(int asid, uint64_t vpn, uint32_t slot, size_t frame) {
+    if (!disk.readBlock(disk.swapOffset() + slot * PAGE_SIZE, memory.at(frame), PAGE_SIZE)) {
+        LOG_ERROR("[Pager] Error: Cannot read swap slot " << slot);
+        return false;
+    }
+    counters.majorFaults++;
+    TRACE_EVENT(TraceEvent::PageIn, 'i', asid, vpn, slot);
+    return true;
+}
+
+void Pager::freeSlot(uint32_t slot) {
+    if (--slotRefs[slot] == 0) {
+        freeSlots.push_back(slot);
+    }
+}
+
+void Pager::setPolicy(PagerPolicy id) {
+    std::unique_ptr<ReplacementPolicy> next = makeReplacementPolicy(id);
+    for (const auto& entry : spaces) {
+        const AddressSpace* space = entry.second;
+        for (uint64_t vpn = 0; vpn < space->getPageCount(); ++vpn) {
+            const PageTableEntry* pte = space->entry(vpn);
+            if ((pte->flags & PTE_PRESENT) && info(pte->frame).owner == space->getAsid()) {
+                next->inserted(pageKey(space->getAsid(), vpn));
+            }
+        }
+    }
+    policy = std::move(next);
+    policyId = id;
+}
+
+PagerStats Pager::getStats() const {
+    PagerStats stats = counters;
+    for (const auto& entry : spaces) {
+        stats.residentPages += entry.second->getResidentPages();
+        stats.swappedPages += entry.second->getSwappedPages();
+    }
+    stats.swapUsed = swapSlots - freeSlots.size();
+    return stats;
+}
+
+// As on x86 Linux, clearing ACCESSED does not shoot down TLB entries: a page
+// that only hits in some CPU's TLB looks idle until that entry is refilled
+bool Pager::testAndClear(uint64_t page) {
+    auto it = spaces.find(pageAsid(page));
+    if (it == spaces.end()) {
+        return false;
+    }
+    AddressSpace* space = it->second;
+    uint64_t vpn = pageVpn(page);
+    size_t frame = space->entry(vpn)->frame;
+    if (!isShared(frame)) {
+        return space->testAndClearAccessed(vpn);
+    }
+    // A shared frame was referenced if any sharer touched it
+    std::vector<AddressSpace*> holders;
+    mappers(space->getFamily(), vpn, frame, holders);
+    bool accessed = false;
+    for (AddressSpace* holder : holders) {
+        accessed |= holder->testAndClearAccessed(vpn);
+    }
+    return accessed;
+}
+
+void Pager::startRecording() {
+    std::lock_guard<std::mutex> guard(traceLock);
+    trace.clear();
+    recording.store(true, std::memory_order_relaxed);
+}
+
+void Pager::append(int asid, uint64_t vpn, bool write) {
+    std::lock_guard<std::mutex> guard(traceLock);
+    if (trace.size() < TRACE_LIMIT) {
+        trace.push_back({pageKey(asid, vpn), write});
+    }
+}
+
+bool Pager::saveTrace(const std::string& path) const {
+    std::ofstream out(path);
+    for (const PageRef& ref : trace) {
+        out << pageAsid(ref.page) << ' ' << pageVpn(ref.page) << ' ' << (ref.write ? 'w' : 'r') << '\n';
+    }
+    return out.good();
+}
+
+bool Pager::loadTrace(const std::string& path, std::vector<PageRef>& out) {
+    std::ifstream in(path);
+    if (!in.good()) {
+        return false;
+    }
+    out.clear();
+    int asid;
+    uint64_t vpn;
+    char mode;
+    while (in >> asid >> vpn >> mode) {
+        out.push_back({pageKey(asid, vpn), mode == 'w'});
+    }
+    return true;
+}
@@ -1,9 +1,12 @@
 #include "../include/Process.hpp"
 #include "../include/Thread.hpp"
+#include "../include/SlabCache.hpp"
+#include "../include/AddressSpace.hpp"
+#include "../include/IoRing.hpp"
 #include <algorithm>
 
 Process::Process(int pid, const std::string& name)
-    : pid(pid), name(name), memoryStart(0), memorySize(0) {
+    : pid(pid), name(name), ioRing(std::make_shared<IoRing>()) {
 }
 
 Process::~Process() {
@@ -13,6 +16,23 @@ Process::~Process() {
     threads.clear();
 }
 
+SlabCache& Process::cache() {
+    static SlabCache processes("process", sizeof(Process));
+    return processes;
+}
+
+void* Process::operator new(size_t size) {
+    return size == sizeof(Process) ? cache().allocate() : ::operator new(size);
+}
+
+void Process::operator delete(void* ptr, size_t size) {
+    if (size == sizeof(Process)) {
+        cache().release(ptr);
+    } else {
+        ::operator delete(ptr);
+    }
+}
+
 void Process::addThread(Thread* thread) {
     threads.push_back(thread);
 }
@@ -29,6 +49,16 @@ bool Process::removeThread(int threadId) {
     return false;
 }
 
+bool Process::removeThread(Thread* thread) {
+    auto it = std::find(threads.begin(), threads.end(), thread);
+    if (it != threads.end()) {
+        delete *it;
+        threads.erase(it);
+        return true;
+    }
+    return false;
+}
+
 int Process::getPid() const {
     return pid;
 }
@@ -45,15 +75,10 @@ int Process::getThreadCount() const {
     return static_cast<int>(threads.size());
 }
 
-int Process::getMemoryStart() const {
-    return memoryStart;
-}
-
-int Process::getMemorySize() const {
-    return memorySize;
+AddressSpace* Process::getAddressSpace() const {
+    return addressSpace.get();
 }
 
-void Process::setMemory(int start, int size) {
-    memoryStart = start;
-    memorySize = size;
+void Process::setAddressSpace(AddressSpace* space) {
+    addressSpace.reset(space);
 }
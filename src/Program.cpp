@@ -0,0 +1,106 @@
+#include "../include/Program.hpp"
+#include "../include/Logger.hpp"
+#include <fstream>
+#include <sstream>
+
+static const struct {
+    const char* name;
+    OpCode op;
+} OPCODES[] = {
+    {"compute", OpCode::Compute}, {"lock", OpCode::Lock},   {"unlock", OpCode::Unlock},
+    {"sleep", OpCode::Sleep},     {"alloc", OpCode::Alloc}, {"free", OpCode::Free},
+    {"read", OpCode::Read},       {"write", OpCode::Write}, {"exit", OpCode::Exit},
+};
+
+const char* Program::mnemonic(OpCode op) {
+    for (const auto& entry : OPCODES) {
+        if (entry.op == op) {
+            return entry.name;
+        }
+    }
+    return "?";
+}
+
+std::shared_ptr<const Program> Program::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.good()) {
+        LOG_ERROR("[Program] Cannot read " << path);
+        return nullptr;
+    }
+    return parse(path, in);
+}
+
+static bool parseNumber(const std::string& word, uint64_t& value) {
+    try {
+        size_t used;
+        value = std::stoull(word, &used, 0);
+        return used == word.size() && word[0] != '-';
+    } catch (...) {
+        return false;
+    }
+}
+
+std::shared_ptr<const Program> Program::parse(const std::string& name, std::istream& in) {
+    std::shared_ptr<Program> program(new Program());
+    program->name = name;
+
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::vector<std::string> args;
+        for (std::string word; words >> word;) {
+            args.push_back(word);
+        }
+        if (args.empty()) {
+            continue;
+        }
+
+        Instruction instruction = {OpCode::Exit, 0, 0, 0, 0};
+        bool known = false;
+        for (const auto& entry : OPCODES) {
+            if (args[0] == entry.name) {
+                instruction.op = entry.op;
+                known = true;
+            }
+        }
+        if (!known) {
+            LOG_ERROR("[Program] " << name << ":" << lineNo << ": unknown instruction '" << args[0] << "'");
+            return nullptr;
+        }
+
+        bool ok = true;
+        switch (instruction.op) {
+            case OpCode::Compute:
+            case OpCode::Sleep:
+            case OpCode::Alloc:
+                ok = args.size() == 2 && parseNumber(args[1], instruction.arg) && instruction.arg > 0;
+                break;
+            case OpCode::Read:
+            case OpCode::Write: {
+                uint64_t offset = 0;
+                ok = (args.size() == 4 || args.size() == 5) && parseNumber(args[2], instruction.arg) &&
+                     parseNumber(args[3], instruction.len) && instruction.len > 0 &&
+                     (args.size() == 4 || parseNumber(args[4], offset));
+                // Like the aio command: reads start at 0, writes append
+                instruction.offset = args.size() == 5 ? static_cast<int64_t>(offset)
+                                                      : (instruction.op == OpCode::Read ? 0 : -1);
+                instruction.path = static_cast<uint32_t>(program->paths.size());
+                program->paths.push_back(args.size() >= 2 ? args[1] : "");
+                break;
+            }
+            default:
+                ok = args.size() == 1;
+                break;
+        }
+        if (!ok) {
+            LOG_ERROR("[Program] " << name << ":" << lineNo << ": bad operands for '" << args[0] << "'");
+            return nullptr;
+        }
+        program->code.push_back(instruction);
+    }
+
+    if (program->code.empty() || program->code.back().op != OpCode::Exit) {
+        program->code.push_back({OpCode::Exit, 0, 0, 0, 0});
+    }
+    return program;
+}
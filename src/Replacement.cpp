@@ -0,0 +1,288 @@
+#include "../include/Replacement.hpp"
+#include <algorithm>
+
+// --- FIFO ---
+
+void FifoPolicy::inserted(uint64_t page) {
+    where[page] = queue.insert(queue.end(), page);
+}
+
+void FifoPolicy::removed(uint64_t page) {
+    auto it = where.find(page);
+    if (it != where.end()) {
+        queue.erase(it->second);
+        where.erase(it);
+    }
+}
+
+uint64_t FifoPolicy::victim(ReferenceBits&, uint64_t) {
+    uint64_t page = queue.front();
+    queue.pop_front();
+    where.erase(page);
+    return page;
+}
+
+// --- CLOCK ---
+
+void ClockPolicy::inserted(uint64_t page) {
+    // Just behind the hand, so a new page gets a full revolution
+    where[page] = ring.insert(hand, page);
+}
+
+void ClockPolicy::removed(uint64_t page) {
+    auto it = where.find(page);
+    if (it == where.end()) {
+        return;
+    }
+    if (it->second == hand) {
+        ++hand;
+    }
+    ring.erase(it->second);
+    where.erase(it);
+}
+
+uint64_t ClockPolicy::victim(ReferenceBits& bits, uint64_t) {
+    // Terminates within two revolutions: the first clears every bit
+    for (;;) {
+        if (hand == ring.end()) {
+            hand = ring.begin();
+        }
+        if (bits.testAndClear(*hand)) {
+            ++hand;
+            continue;
+        }
+        uint64_t page = *hand;
+        hand = ring.erase(hand);
+        where.erase(page);
+        return page;
+    }
+}
+
+// --- LRU approximation (aging) ---
+
+void AgingPolicy::erase(size_t index) {
+    where.erase(pages[index].page);
+    if (index + 1 != pages.size()) {
+        pages[index] = pages.back();
+        where[pages[index].page] = index;
+    }
+    pages.pop_back();
+}
+
+void AgingPolicy::inserted(uint64_t page) {
+    where[page] = pages.size();
+    pages.push_back({page, loads++, 0});
+}
+
+void AgingPolicy::removed(uint64_t page) {
+    auto it = where.find(page);
+    if (it != where.end()) {
+        erase(it->second);
+    }
+}
+
+void AgingPolicy::sweep(ReferenceBits& bits) {
+    // (age, fault-in order) packed into one key
+    std::vector<std::pair<uint64_t, uint64_t>> order;
+    order.reserve(pages.size());
+    for (Entry& e : pages) {
+        e.age = static_cast<uint8_t>((e.age >> 1) | (bits.testAndClear(e.page) ? 0x80 : 0));
+        order.push_back({(static_cast<uint64_t>(e.age) << 56) | e.loaded, e.page});
+    }
+    size_t batch = std::max<size_t>(order.size() / 16, 1);
+    std::nth_element(order.begin(), order.begin() + (batch - 1), order.end());
+    std::sort(order.begin(), order.begin() + batch);
+    candidates.clear();
+    for (size_t i = 0; i < batch; ++i) {
+        candidates.push_back(order[i].second);
+    }
+    nextCandidate = 0;
+}
+
+uint64_t AgingPolicy::victim(ReferenceBits& bits, uint64_t) {
+    // Ends by the second sweep at the latest: the first clears every bit
+    for (;;) {
+        if (nextCandidate == candidates.size()) {
+            sweep(bits);
+        }
+        uint64_t page = candidates[nextCandidate++];
+        auto it = where.find(page);
+        if (it == where.end()) {
+            continue;  // Freed since the sweep
+        }
+        if (bits.testAndClear(page)) {
+            // Referenced since the sweep: credit it and move on
+            pages[it->second].age |= 0x80;
+            continue;
+        }
+        erase(it->second);
+        return page;
+    }
+}
+
+// --- ARC ---
+
+void ArcPolicy::moveTo(uint64_t page, ListId list) {
+    auto it = where.find(page);
+    if (it != where.end()) {
+        lists[it->second.list].erase(it->second.it);
+    }
+    lists[list].push_front(page);
+    where[page] = {list, lists[list].begin()};
+}
+
+void ArcPolicy::dropLru(ListId list) {
+    where.erase(lists[list].back());
+    lists[list].pop_back();
+}
+
+void ArcPolicy::inserted(uint64_t page) {
+    c = std::max(c, size() + 1);
+    auto it = where.find(page);
+    if (it != where.end() && it->second.list == B1) {
+        // Recency ghost hit: T1 was too small
+        p = std::min(c, p + std::max<size_t>(lists[B2].size() / lists[B1].size(), 1));
+        moveTo(page, T2);
+    } else if (it != where.end() && it->second.list == B2) {
+        // Frequency ghost hit: T2 was too small
+        size_t delta = std::max<size_t>(lists[B1].size() / lists[B2].size(), 1);
+        p = p > delta ? p - delta : 0;
+        moveTo(page, T2);
+    } else {
+        moveTo(page, T1);
+    }
+
+    // The directory tracks at most c pages of recency and 2c in total
+    while (lists[T1].size() + lists[B1].size() > c && !lists[B1].empty()) {
+        dropLru(B1);
+    }
+    while (where.size() > 2 * c && !lists[B2].empty()) {
+        dropLru(B2);
+    }
+}
+
+void ArcPolicy::referenced(uint64_t page) {
+    auto it = where.find(page);
+    if (it != where.end() && (it->second.list == T1 || it->second.list == T2)) {
+        moveTo(page, T2);
+    }
+}
+
+void ArcPolicy::removed(uint64_t page) {
+    auto it = where.find(page);
+    if (it != where.end() && (it->second.list == T1 || it->second.list == T2)) {
+        lists[it->second.list].erase(it->second.it);
+        where.erase(it);
+    }
+}
+
+uint64_t ArcPolicy::victim(ReferenceBits&, uint64_t incoming) {
+    auto in = where.find(incoming);
+    bool inB2 = in != where.end() && in->second.list == B2;
+    size_t t1 = lists[T1].size();
+    ListId from = (t1 > 0 && (t1 > p || (inB2 && t1 == p) || lists[T2].empty())) ? T1 : T2;
+    uint64_t page = lists[from].back();
+    moveTo(page, from == T1 ? B1 : B2);
+    return page;
+}
+
+// --- Factory ---
+
+std::unique_ptr<ReplacementPolicy> makeReplacementPolicy(PagerPolicy policy) {
+    switch (policy) {
+        case PagerPolicy::Fifo: return std::unique_ptr<ReplacementPolicy>(new FifoPolicy());
+        case PagerPolicy::Lru: return std::unique_ptr<ReplacementPolicy>(new AgingPolicy());
+        case PagerPolicy::Arc: return std::unique_ptr<ReplacementPolicy>(new ArcPolicy());
+        default: return std::unique_ptr<ReplacementPolicy>(new ClockPolicy());
+    }
+}
+
+const char* pagerPolicyName(PagerPolicy policy) {
+    switch (policy) {
+        case PagerPolicy::Fifo: return "fifo";
+        case PagerPolicy::Lru: return "lru";
+        case PagerPolicy::Arc: return "arc";
+        default: return "clock";
+    }
+}
+
+bool parsePagerPolicy(const std::string& name, PagerPolicy& policy) {
+    if (name == "fifo") {
+        policy = PagerPolicy::Fifo;
+    } else if (name == "clock") {
+        policy = PagerPolicy::Clock;
+    } else if (name == "lru") {
+        policy = PagerPolicy::Lru;
+    } else if (name == "arc") {
+        policy = PagerPolicy::Arc;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// --- Trace replay ---
+
+namespace {
+
+struct SimPage {
+    bool resident;
+    bool referenced;
+    bool dirty;
+    bool swapped;  // A valid copy sits in swap
+};
+
+class SimBits : public ReferenceBits {
+  public:
+    std::unordered_map<uint64_t, SimPage>& pages;
+    explicit SimBits(std::unordered_map<uint64_t, SimPage>& pages) : pages(pages) {}
+    bool testAndClear(uint64_t page) override {
+        SimPage& p = pages[page];
+        bool was = p.referenced;
+        p.referenced = false;
+        return was;
+    }
+};
+
+}  // namespace
+
+ReplayStats replayTrace(PagerPolicy policy, const std::vector<PageRef>& trace, size_t frames) {
+    ReplayStats stats = {trace.size(), 0, 0, 0};
+    std::unique_ptr<ReplacementPolicy> repl = makeReplacementPolicy(policy);
+    std::unordered_map<uint64_t, SimPage> pages;
+    SimBits bits(pages);
+    size_t resident = 0;
+    frames = std::max<size_t>(frames, 1);
+
+    for (const PageRef& ref : trace) {
+        SimPage& page = pages[ref.page];
+        if (page.resident) {
+            repl->referenced(ref.page);
+        } else {
+            stats.faults++;
+            if (resident == frames) {
+                SimPage& out = pages[repl->victim(bits, ref.page)];
+                if (out.dirty) {
+                    stats.pageOuts++;
+                    out.swapped = true;
+                    out.dirty = false;
+                }
+                out.resident = false;
+                resident--;
+            }
+            if (page.swapped) {
+                stats.pageIns++;
+            }
+            page.resident = true;
+            resident++;
+            repl->inserted(ref.page);
+        }
+        page.referenced = true;
+        if (ref.write) {
+            // The swap copy is stale from the first store on
+            page.dirty = true;
+            page.swapped = false;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,247 @@
+#include "../include/RunTree.hpp"
+
+void RunTree::insert(Thread* thread) {
+    Thread* parent = nullptr;
+    Thread* at = root;
+    bool isLeftmost = true;
+    while (at != nullptr) {
+        parent = at;
+        if (before(thread, at)) {
+            at = at->rbLeft;
+        } else {
+            at = at->rbRight;
+            isLeftmost = false;
+        }
+    }
+
+    thread->rbParent = parent;
+    thread->rbLeft = nullptr;
+    thread->rbRight = nullptr;
+    thread->rbRed = true;
+    thread->runTree = this;
+    if (parent == nullptr) {
+        root = thread;
+    } else if (before(thread, parent)) {
+        parent->rbLeft = thread;
+    } else {
+        parent->rbRight = thread;
+    }
+    if (isLeftmost) {
+        leftmost = thread;
+    }
+    count++;
+    insertFixup(thread);
+}
+
+void RunTree::remove(Thread* thread) {
+    if (leftmost == thread) {
+        leftmost = next(thread);
+    }
+
+    // 'child' takes the place of whichever node leaves the tree; a black
+    // node leaving unbalances it there
+    Thread* child;
+    Thread* parent;
+    bool removedRed = thread->rbRed;
+    if (thread->rbLeft == nullptr) {
+        child = thread->rbRight;
+        parent = thread->rbParent;
+        replace(thread, child);
+    } else if (thread->rbRight == nullptr) {
+        child = thread->rbLeft;
+        parent = thread->rbParent;
+        replace(thread, child);
+    } else {
+        // Two children: the successor moves into its place
+        Thread* successor = thread->rbRight;
+        while (successor->rbLeft != nullptr) {
+            successor = successor->rbLeft;
+        }
+        removedRed = successor->rbRed;
+        child = successor->rbRight;
+        if (successor->rbParent == thread) {
+            parent = successor;
+        } else {
+            parent = successor->rbParent;
+            replace(successor, child);
+            successor->rbRight = thread->rbRight;
+            successor->rbRight->rbParent = successor;
+        }
+        replace(thread, successor);
+        successor->rbLeft = thread->rbLeft;
+        successor->rbLeft->rbParent = successor;
+        successor->rbRed = thread->rbRed;
+    }
+    if (!removedRed) {
+        removeFixup(child, parent);
+    }
+
+    thread->runTree = nullptr;
+    thread->rbParent = nullptr;
+    thread->rbLeft = nullptr;
+    thread->rbRight = nullptr;
+    count--;
+}
+
+Thread* RunTree::last() const {
+    Thread* t = root;
+    while (t != nullptr && t->rbRight != nullptr) {
+        t = t->rbRight;
+    }
+    return t;
+}
+
+Thread* RunTree::next(const Thread* thread) {
+    if (thread->rbRight != nullptr) {
+        Thread* t = thread->rbRight;
+        while (t->rbLeft != nullptr) {
+            t = t->rbLeft;
+        }
+        return t;
+    }
+    const Thread* t = thread;
+    while (t->rbParent != nullptr && t == t->rbParent->rbRight) {
+        t = t->rbParent;
+    }
+    return t->rbParent;
+}
+
+void RunTree::replace(Thread* old, Thread* with) {
+    Thread* parent = old->rbParent;
+    if (parent == nullptr) {
+        root = with;
+    } else if (old == parent->rbLeft) {
+        parent->rbLeft = with;
+    } else {
+        parent->rbRight = with;
+    }
+    if (with != nullptr) {
+        with->rbParent = parent;
+    }
+}
+
+void RunTree::rotateLeft(Thread* x) {
+    Thread* y = x->rbRight;
+    x->rbRight = y->rbLeft;
+    if (y->rbLeft != nullptr) {
+        y->rbLeft->rbParent = x;
+    }
+    replace(x, y);
+    y->rbLeft = x;
+    x->rbParent = y;
+}
+
+void RunTree::rotateRight(Thread* x) {
+    Thread* y = x->rbLeft;
+    x->rbLeft = y->rbRight;
+    if (y->rbRight != nullptr) {
+        y->rbRight->rbParent = x;
+    }
+    replace(x, y);
+    y->rbRight = x;
+    x->rbParent = y;
+}
+
+// A red node's parent is red: recolour up the tree while the uncle is red,
+// then at most two rotations
+void RunTree::insertFixup(Thread* z) {
+    while (isRed(z->rbParent)) {
+        Thread* parent = z->rbParent;
+        Thread* grandparent = parent->rbParent;  // A red node is never the root
+        if (parent == grandparent->rbLeft) {
+            Thread* uncle = grandparent->rbRight;
+            if (isRed(uncle)) {
+                parent->rbRed = false;
+                uncle->rbRed = false;
+                grandparent->rbRed = true;
+                z = grandparent;
+                continue;
+            }
+            if (z == parent->rbRight) {
+                z = parent;
+                rotateLeft(z);
+                parent = z->rbParent;
+            }
+            parent->rbRed = false;
+            grandparent->rbRed = true;
+            rotateRight(grandparent);
+        } else {
+            Thread* uncle = grandparent->rbLeft;
+            if (isRed(uncle)) {
+                parent->rbRed = false;
+                uncle->rbRed = false;
+                grandparent->rbRed = true;
+                z = grandparent;
+                continue;
+            }
+            if (z == parent->rbLeft) {
+                z = parent;
+                rotateRight(z);
+                parent = z->rbParent;
+            }
+            parent->rbRed = false;
+            grandparent->rbRed = true;
+            rotateLeft(grandparent);
+        }
+    }
+    root->rbRed = false;
+}
+
+// 'x' (possibly null, under 'parent') is one black short of its sibling
+void RunTree::removeFixup(Thread* x, Thread* parent) {
+    while (x != root && !isRed(x)) {
+        if (x == parent->rbLeft) {
+            Thread* sibling = parent->rbRight;
+            if (isRed(sibling)) {
+                sibling->rbRed = false;
+                parent->rbRed = true;
+                rotateLeft(parent);
+                sibling = parent->rbRight;
+            }
+            if (!isRed(sibling->rbLeft) && !isRed(sibling->rbRight)) {
+                sibling->rbRed = true;
+                x = parent;
+                parent = x->rbParent;
+                continue;
+            }
+            if (!isRed(sibling->rbRight)) {
+                sibling->rbLeft->rbRed = false;
+                sibling->rbRed = true;
+                rotateRight(sibling);
+                sibling = parent->rbRight;
+            }
+            sibling->rbRed = parent->rbRed;
+            parent->rbRed = false;
+            sibling->rbRight->rbRed = false;
+            rotateLeft(parent);
+        } else {
+            Thread* sibling = parent->rbLeft;
+            if (isRed(sibling)) {
+                sibling->rbRed = false;
+                parent->rbRed = true;
+                rotateRight(parent);
+                sibling = parent->rbLeft;
+            }
+            if (!isRed(sibling->rbLeft) && !isRed(sibling->rbRight)) {
+                sibling->rbRed = true;
+                x = parent;
+                parent = x->rbParent;
+                continue;
+            }
+            if (!isRed(sibling->rbLeft)) {
+                sibling->rbRight->rbRed = false;
+                sibling->rbRed = true;
+                rotateLeft(sibling);
+                sibling = parent->rbLeft;
+            }
+            sibling->rbRed = parent->rbRed;
+            parent->rbRed = false;
+            sibling->rbLeft->rbRed = false;
+            rotateRight(parent);
+        }
+        x = root;
+    }
+    if (x != nullptr) {
+        x->rbRed = false;
+    }
+}
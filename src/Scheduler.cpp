@@ -1,67 +1,306 @@
 #include "../include/Scheduler.hpp"
-#include <iostream>
+#include "../include/Logger.hpp"
+#include "../include/Tracer.hpp"
 
-Scheduler::Scheduler() :
-  currentThread(nullptr) {
+// Weight per nice value, -20..19 (kernel/sched/core.c)
+static const int NICE_WEIGHTS[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+    9548,  7620,  6100,  4904,  3906,  3121,  2501,  1991,  1586,  1277,
+    1024,  820,   655,   526,   423,   335,   272,   215,   172,   137,
+    110,   87,    70,    56,    45,    36,    29,    23,    18,    15,
+};
+
+Scheduler::Scheduler(int levels, int cpuId) :
+  policy(SchedPolicy::Priority),
+  numLevels(std::max(1, std::min(levels, MAX_PRIORITY_LEVELS))),
+  readyQueues(new ThreadQueue[numLevels]),
+  readyCount(0),
+  readySummary(0),
+  minVruntime(0),
+  resched(false),
+  currentThread(nullptr),
+  cpuId(cpuId),
+  idle(false),
+  quantum(DEFAULT_QUANTUM),
+  sliceLeft(0),
+  contextSwitches(0),
+  clock(0),
+  inbox(nullptr) {
+  for (int level = 0; level < numLevels; ++level) {
+      readyQueues[level].setOwner(this);
+  }
+  readyBitmap.assign((numLevels + 63) / 64, 0);
 }
 
-void Scheduler::addThread(Thread* thread) {
-  if (thread->getPriority() == 0) {
-      readyQueueHigh.push(thread);
+int Scheduler::niceWeight(int nice) {
+  return NICE_WEIGHTS[std::max(-20, std::min(nice, 19)) + 20];
+}
+
+const char* Scheduler::policyName(SchedPolicy policy) {
+  return policy == SchedPolicy::Fair ? "cfs" : "priority";
+}
+
+bool Scheduler::parsePolicy(const std::string& name, SchedPolicy& policy) {
+  if (name == "priority" || name == "prio") {
+      policy = SchedPolicy::Priority;
+  } else if (name == "cfs" || name == "fair") {
+      policy = SchedPolicy::Fair;
   } else {
-      readyQueueLow.push(thread);
+      return false;
+  }
+  return true;
+}
+
+void Scheduler::setPolicy(SchedPolicy p) {
+  if (p == policy) {
+      return;
+  }
+  std::vector<Thread*> ready;
+  while (Thread* thread = pickNext()) {
+      ready.push_back(thread);
+  }
+  policy = p;
+  // Runtime from an earlier spell under the fair class no longer counts:
+  // everyone starts level with the running thread
+  if (currentThread != nullptr) {
+      currentThread->setVruntime(minVruntime.load(std::memory_order_relaxed));
+  }
+  for (Thread* thread : ready) {
+      uint64_t since = thread->getReadySince();
+      thread->setVruntime(0);
+      addThread(thread);
+      thread->setReadySince(since);
   }
 }
 
+void Scheduler::markReady(int level) {
+  readyBitmap[level >> 6] |= uint64_t(1) << (level & 63);
+  readySummary |= uint64_t(1) << (level >> 6);
+}
+
+void Scheduler::markEmpty(int level) {
+  readyBitmap[level >> 6] &= ~(uint64_t(1) << (level & 63));
+  if (readyBitmap[level >> 6] == 0) {
+      readySummary &= ~(uint64_t(1) << (level >> 6));
+  }
+}
+
+void Scheduler::addThread(Thread* thread) {
+  thread->setReadySince(clock);
+  if (policy == SchedPolicy::Fair) {
+      // A thread back from sleep (or new) has not run for a while: it goes
+      // half a slice ahead of the others, not ahead by all the time it slept
+      uint64_t credit = VRUNTIME_TICK * quantum / 2;
+      uint64_t least = minVruntime.load(std::memory_order_relaxed);
+      uint64_t floor = least > credit ? least - credit : 0;
+      if (thread->getVruntime() < floor) {
+          thread->setVruntime(floor);
+      }
+  }
+  enqueue(thread);
+}
+
+void Scheduler::adopt(Thread* thread, const Scheduler& from) {
+  if (policy == SchedPolicy::Fair && &from != this) {
+      // Keep its lag behind (or lead over) the CPU it came from
+      uint64_t base = from.minVruntime.load(std::memory_order_relaxed);
+      uint64_t here = minVruntime.load(std::memory_order_relaxed);
+      uint64_t v = thread->getVruntime();
+      thread->setVruntime(v >= base ? here + (v - base) : here - std::min(here, base - v));
+  }
+  if (&from != this) {
+      thread->setReadySince(clock);  // Each CPU keeps its own clock
+  }
+  enqueue(thread);
+}
+
+void Scheduler::enqueue(Thread* thread) {
+  readyCount++;
+  thread->setCpu(cpuId);
+
+  if (policy == SchedPolicy::Fair) {
+      runTree.insert(thread);
+      // Wakeup preemption: it takes the CPU once the current thread has
+      // run more by over a tick
+      if (currentThread != nullptr && thread != currentThread &&
+          thread->getVruntime() + VRUNTIME_TICK < currentThread->getVruntime()) {
+          resched = true;
+      }
+      return;
+  }
+
+  // Out-of-range priorities fall into the lowest level
+  int level = std::max(0, std::min(thread->getPriority(), numLevels - 1));
+  readyQueues[level].pushBack(thread);
+  markReady(level);
+}
+
+// Find-first-set over the two-level bitmap: independent of level and thread count
+int Scheduler::topReadyLevel() const {
+  if (readySummary == 0) {
+      return numLevels;
+  }
+  int word = __builtin_ctzll(readySummary);
+  return (word << 6) + __builtin_ctzll(readyBitmap[word]);
+}
+
+Thread* Scheduler::pickNext() {
+  if (policy == SchedPolicy::Fair) {
+      Thread* next = runTree.first();
+      if (next != nullptr) {
+          runTree.remove(next);
+          readyCount--;
+      }
+      return next;
+  }
+  if (readySummary == 0) {
+      return nullptr;
+  }
+  int level = topReadyLevel();
+
+  ThreadQueue& queue = readyQueues[level];
+  Thread* next = queue.popFront();
+  readyCount--;
+  if (queue.empty()) {
+      markEmpty(level);
+  }
+  return next;
+}
+
+Thread* Scheduler::takeLowest() {
+  if (policy == SchedPolicy::Fair) {
+      Thread* victim = runTree.last();
+      if (victim != nullptr) {
+          runTree.remove(victim);
+          readyCount--;
+      }
+      return victim;
+  }
+  if (readySummary == 0) {
+      return nullptr;
+  }
+  int word = 63 - __builtin_clzll(readySummary);
+  int level = (word << 6) + 63 - __builtin_clzll(readyBitmap[word]);
+
+  ThreadQueue& queue = readyQueues[level];
+  Thread* victim = queue.back();
+  queue.remove(victim);
+  readyCount--;
+  if (queue.empty()) {
+      markEmpty(level);
+  }
+  return victim;
+}
+
 // yield() performs scheduling based on Priority
 void Scheduler::yield() {
-  
+  Thread* previous = currentThread;
+
+  // 0. Apply what other CPUs posted. A thread woken while still current
+  // here is READY now, so step 1 leaves it queued just once.
+  if (inbox.load(std::memory_order_relaxed) != nullptr) {
+      drainInbox();
+  }
+
   // 1. Save current thread context
   if (currentThread != nullptr) {
       if (currentThread->getState() == ThreadState::RUNNING) {
         currentThread->setState(ThreadState::READY);
         // Re-queue based on priority
-        if (currentThread->getPriority() == 0) {
-            readyQueueHigh.push(currentThread);
-        } else {
-            readyQueueLow.push(currentThread);
-        }
-      } 
-      // If BLOCKED or TERMINATED, do nothing (context already saved/irrelevant)
+        addThread(currentThread);
+      }
+      // If BLOCKED, SLEEPING or TERMINATED, do nothing (context already saved/irrelevant)
   }
-  
+
   // 2. Pick next thread (Strict Priority)
-  if (!readyQueueHigh.empty()) {
-      currentThread = readyQueueHigh.front();
-      readyQueueHigh.pop();
-  } else if (!readyQueueLow.empty()) {
-      currentThread = readyQueueLow.front();
-      readyQueueLow.pop();
-  } else {
-      currentThread = nullptr; 
-      std::cout << "Scheduler: No ready threads." << std::endl;
+  currentThread = pickNext();
+  if (currentThread == nullptr) {
+      resched = false;
+      // Report going idle once, not on every idle tick
+      if (!idle) {
+          TRACE_EVENT(TraceEvent::ContextSwitch, 'i', 0, previous ? previous->getId() : 0);
+          LOG_DEBUG("Scheduler: No ready threads.");
+          idle = true;
+      }
       return;
   }
+  idle = false;
+  sliceLeft = quantum - 1;
+  resched = false;
 
   if (currentThread) {
       currentThread->setState(ThreadState::RUNNING);
-      std::cout << "Context Switch: Running Thread " << currentThread->getId() 
+      updateMinVruntime();
+      currentThread->addSlice();
+      if (currentThread != previous) {
+          uint64_t waited = clock - currentThread->getReadySince();
+          currentThread->addWaitTicks(waited);
+          waits.record(waited);
+          contextSwitches++;
+          TRACE_EVENT(TraceEvent::ContextSwitch, 'i', currentThread->getId(),
+                      previous ? previous->getId() : 0);
+      }
+      LOG_DEBUG("Context Switch: Running Thread " << currentThread->getId()
                 << " (PID " << currentThread->getParentPid() << ")"
-                << " [" << (currentThread->getPriority() == 0 ? "HIGH" : "LOW") << "] " 
-                << "(" << currentThread->getName() << ")" << std::endl;
+                << " [" << priorityLabel(currentThread->getPriority()) << "] "
+                << "(" << currentThread->getName() << ")");
+  }
+}
+
+void Scheduler::schedule() {
+  if (inbox.load(std::memory_order_relaxed) != nullptr) {
+      drainInbox();
+  }
+  if (policy == SchedPolicy::Fair && currentThread != nullptr) {
+      // Charge the tick it just ran, scaled by its weight
+      currentThread->setVruntime(currentThread->getVruntime() +
+                                 VRUNTIME_TICK * NICE_0_WEIGHT / niceWeight(currentThread->getNice()));
+  }
+  if (!yieldsNext()) {
+      sliceLeft--;
+      updateMinVruntime();
+  } else {
+      yield();
+  }
+  clock++;
+}
+
+bool Scheduler::yieldsNext() const {
+  return currentThread == nullptr || sliceLeft == 0 || currentThread->getState() != ThreadState::RUNNING ||
+         preempts();
+}
+
+bool Scheduler::preempts() const {
+  if (policy == SchedPolicy::Fair) {
+      return resched;
+  }
+  return topReadyLevel() < std::min(currentThread->getPriority(), numLevels - 1);
+}
+
+void Scheduler::updateMinVruntime() {
+  if (policy != SchedPolicy::Fair) {
+      return;
+  }
+  uint64_t least = UINT64_MAX;
+  if (currentThread != nullptr && currentThread->getState() == ThreadState::RUNNING) {
+      least = currentThread->getVruntime();
+  }
+  if (!runTree.empty()) {
+      least = std::min(least, runTree.first()->getVruntime());
+  }
+  if (least != UINT64_MAX && least > minVruntime.load(std::memory_order_relaxed)) {
+      minVruntime.store(least, std::memory_order_relaxed);
   }
 }
 
 void Scheduler::wakeup(Thread* thread) {
-    if (thread && thread->getState() == ThreadState::BLOCKED) {
+    if (thread && (thread->getState() == ThreadState::BLOCKED ||
+                   thread->getState() == ThreadState::SLEEPING)) {
         thread->setState(ThreadState::READY);
-        if (thread->getPriority() == 0) {
-            readyQueueHigh.push(thread);
-            std::cout << "Scheduler: Waking up HIGH Priority Thread " << thread->getId() << std::endl;
-        } else {
-            readyQueueLow.push(thread);
-            std::cout << "Scheduler: Waking up LOW Priority Thread " << thread->getId() << std::endl;
-        }
+        addThread(thread);
+        TRACE_EVENT(TraceEvent::Wake, 'i', thread->getId());
+        LOG_INFO("Scheduler: Waking up " << priorityLabel(thread->getPriority())
+                 << " Priority Thread " << thread->getId());
     }
 }
 
@@ -75,57 +314,157 @@ Thread* Scheduler::getCurrentThread() {
   return currentThread;
 }
 
-std::vector<Thread*> Scheduler::getAllThreads() {
-    std::vector<Thread*> allThreads;
-    
-    // Add current thread if exists
-    if (currentThread) {
-        allThreads.push_back(currentThread);
+bool Scheduler::removeThread(Thread* thread) {
+    // Check current thread
+    if (currentThread == thread) {
+        currentThread = nullptr;
+        return true;
     }
-    
-    // Copy from high priority queue
-    std::queue<Thread*> tempHigh = readyQueueHigh;
-    while (!tempHigh.empty()) {
-        allThreads.push_back(tempHigh.front());
-        tempHigh.pop();
+    if (runTree.contains(thread)) {
+        runTree.remove(thread);
+        readyCount--;
+        return true;
     }
-    
-    // Copy from low priority queue
-    std::queue<Thread*> tempLow = readyQueueLow;
-    while (!tempLow.empty()) {
-        allThreads.push_back(tempLow.front());
-        tempLow.pop();
+
+    ThreadQueue* queue = thread->getQueue();
+    if (queue == nullptr || queue->getOwner() != this) {
+        return false;
     }
-    
-    return allThreads;
+    unqueue(thread);
+    return true;
 }
 
-bool Scheduler::removeThread(int id) {
-    // Check current thread
-    if (currentThread && currentThread->getId() == id) {
-        currentThread = nullptr;
-        return true;
+void Scheduler::unqueue(Thread* thread) {
+    ThreadQueue* queue = thread->getQueue();
+    queue->remove(thread);
+    readyCount--;
+    if (queue->empty()) {
+        markEmpty(static_cast<int>(queue - readyQueues.get()));
+    }
+}
+
+void Scheduler::refile(Thread* thread) {
+    ThreadQueue* queue = thread->getQueue();
+    if (queue != nullptr && queue->getOwner() == this) {
+        unqueue(thread);
+        addThread(thread);
+    }
+}
+
+// The thread's last CPU; it stays put while the thread is blocked
+void Scheduler::wakeupAnywhere(Thread* thread) {
+    Scheduler* home = peers.empty() ? this : peers[thread->getCpu()];
+    if (home == this) {
+        wakeup(thread);
+    } else {
+        home->post(thread, POST_WAKE);
     }
-    
-    // Helper to remove from queue
-    auto removeFromQueue = [id](std::queue<Thread*>& q) -> bool {
-        std::queue<Thread*> temp;
-        bool found = false;
-        while (!q.empty()) {
-            Thread* t = q.front();
-            q.pop();
-            if (t->getId() == id) {
-                found = true;
+}
+
+void Scheduler::setPriority(Thread* thread, int priority) {
+    thread->setPriority(priority);
+    Scheduler* home = peers.empty() ? this : peers[thread->getCpu()];
+    if (home == this) {
+        refile(thread);
+    } else {
+        // Not requeued elsewhere yet: it lands at the new level either way
+        home->post(thread, POST_REFILE);
+    }
+}
+
+// The release publishes whatever the poster wrote to the thread (its new
+// priority, an I/O result) along with the entry. Only the post that finds no
+// bits pending links the thread in, so it is in one inbox at most, and its
+// link is free again once the owner has cleared the bits.
+void Scheduler::post(Thread* thread, unsigned what) {
+    if (thread->posted.fetch_or(what, std::memory_order_acq_rel) != 0) {
+        return;
+    }
+    Thread* head = inbox.load(std::memory_order_relaxed);
+    do {
+        thread->inboxNext = head;
+    } while (!inbox.compare_exchange_weak(head, thread, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void Scheduler::drainInbox() {
+    Thread* batch = nullptr;
+    for (Thread* t = inbox.exchange(nullptr, std::memory_order_acquire); t != nullptr;) {
+        Thread* next = t->inboxNext;
+        t->inboxNext = batch;
+        batch = t;
+        t = next;
+    }
+    while (batch != nullptr) {
+        Thread* thread = batch;
+        batch = thread->inboxNext;  // Before the bits clear and it can be posted again
+        unsigned what = thread->posted.exchange(0, std::memory_order_acq_rel);
+        // A priority change posted here may find the thread moved to another
+        // CPU by now: it follows the thread there rather than being dropped
+        if (what & POST_REFILE) {
+            int home = thread->getCpu();
+            if (!peers.empty() && home != cpuId) {
+                peers[home]->post(thread, POST_REFILE);
             } else {
-                temp.push(t);
+                refile(thread);
             }
         }
-        q = temp;
-        return found;
-    };
-    
-    if (removeFromQueue(readyQueueHigh)) return true;
-    if (removeFromQueue(readyQueueLow)) return true;
-    
-    return false;
+        if (what & POST_WAKE) {
+            wakeup(thread);
+        }
+    }
+}
+
+// Between runs no one else posts, so the stack can be edited in place
+void Scheduler::cancelPosted(Thread* thread) {
+    Thread* head = inbox.exchange(nullptr, std::memory_order_acquire);
+    for (Thread** link = &head; *link != nullptr; link = &(*link)->inboxNext) {
+        if (*link == thread) {
+            *link = thread->inboxNext;
+            thread->inboxNext = nullptr;
+            thread->posted.store(0, std::memory_order_relaxed);
+            break;
+        }
+    }
+    inbox.store(head, std::memory_order_release);
+}
+
+static int waitBucket(uint64_t ticks) {
+    if (ticks < 16) {
+        return static_cast<int>(ticks);
+    }
+    int log = 63 - __builtin_clzll(ticks);
+    return 16 + (log - 4) * 8 + static_cast<int>((ticks >> (log - 3)) & 7);
+}
+
+void WaitHistogram::record(uint64_t ticks) {
+    counts[waitBucket(ticks)]++;
+    total++;
+    largest = std::max(largest, ticks);
+}
+
+void WaitHistogram::merge(const WaitHistogram& other) {
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    largest = std::max(largest, other.largest);
+}
+
+uint64_t WaitHistogram::percentile(double p) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * total + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            if (i < 16) {
+                return i;
+            }
+            int log = (i - 16) / 8 + 4;
+            return std::min(largest, uint64_t(8 + (i - 16) % 8) << (log - 3));
+        }
+    }
+    return largest;
 }
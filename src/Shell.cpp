@@ -1,7 +1,10 @@
 #include "../include/Shell.hpp"
 #include "../include/Kernel.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Tracer.hpp"
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
 
 Shell::Shell(Kernel* k) : kernel(k), running(true) {
 }
@@ -55,10 +58,54 @@ void Shell::executeCommand(const std::vector<std::string>& tokens) {
         cmdProcs();
     } else if (cmd == "kill") {
         cmdKill(tokens);
+    } else if (cmd == "killp") {
+        cmdKillProcess(tokens);
+    } else if (cmd == "sleep") {
+        cmdSleep(tokens);
+    } else if (cmd == "nice") {
+        cmdNice(tokens);
+    } else if (cmd == "aio") {
+        cmdAio(tokens);
+    } else if (cmd == "load") {
+        cmdLoad(tokens);
     } else if (cmd == "mem") {
-        cmdMem();
+        cmdMem(tokens);
+    } else if (cmd == "touch") {
+        cmdTouch(tokens);
+    } else if (cmd == "swap") {
+        cmdSwap(tokens);
     } else if (cmd == "files") {
         cmdFiles();
+    } else if (cmd == "sync") {
+        cmdSync();
+    } else if (cmd == "fsck") {
+        cmdFsck();
+    } else if (cmd == "write") {
+        cmdWrite(tokens);
+    } else if (cmd == "cat") {
+        cmdCat(tokens);
+    } else if (cmd == "rm") {
+        cmdRm(tokens);
+    } else if (cmd == "truncate") {
+        cmdTruncate(tokens);
+    } else if (cmd == "mkdir") {
+        cmdMkdir(tokens);
+    } else if (cmd == "rmdir") {
+        cmdRmdir(tokens);
+    } else if (cmd == "ls") {
+        cmdLs(tokens);
+    } else if (cmd == "cpus") {
+        cmdCpus();
+    } else if (cmd == "quantum") {
+        cmdQuantum(tokens);
+    } else if (cmd == "sched") {
+        cmdSched(tokens);
+    } else if (cmd == "slabs") {
+        cmdSlabs();
+    } else if (cmd == "log") {
+        cmdLog(tokens);
+    } else if (cmd == "trace") {
+        cmdTrace(tokens);
     } else if (cmd == "run") {
         cmdRun(tokens);
     } else if (cmd == "help") {
@@ -72,10 +119,24 @@ void Shell::executeCommand(const std::vector<std::string>& tokens) {
     }
 }
 
+int Shell::parsePriority(const std::string& arg) {
+    int levels = kernel->getPriorityLevels();
+    try {
+        int priority = std::stoi(arg);
+        if (priority >= 0 && priority < levels) {
+            return priority;
+        }
+    } catch (...) {
+    }
+    std::cout << "[Shell] Invalid priority (0-" << levels - 1 << "). Using LOW (1)." << std::endl;
+    return 1;
+}
+
 void Shell::cmdSpawn(const std::vector<std::string>& args) {
     if (args.size() < 2) {
         std::cout << "Usage: spawn <task_name> [priority]" << std::endl;
-        std::cout << "       priority: 0 = HIGH, 1 = LOW (default)" << std::endl;
+        std::cout << "       priority: 0 = HIGH .. " << kernel->getPriorityLevels() - 1
+                  << " = lowest, 1 = LOW (default)" << std::endl;
         return;
     }
     
@@ -83,38 +144,53 @@ void Shell::cmdSpawn(const std::vector<std::string>& args) {
     int priority = 1; // Default LOW
     
     if (args.size() >= 3) {
-        try {
-            priority = std::stoi(args[2]);
-            if (priority != 0 && priority != 1) {
-                std::cout << "[Shell] Invalid priority. Using LOW (1)." << std::endl;
-                priority = 1;
-            }
-        } catch (...) {
-            std::cout << "[Shell] Invalid priority. Using LOW (1)." << std::endl;
-        }
+        priority = parsePriority(args[2]);
     }
     
     int id = kernel->spawnTask(name, priority);
     std::cout << "[Shell] Spawned task '" << name << "' with ID " << id 
-              << " [" << (priority == 0 ? "HIGH" : "LOW") << "]" << std::endl;
+              << " [" << priorityLabel(priority) << "]" << std::endl;
 }
 
 void Shell::cmdFork(const std::vector<std::string>& args) {
     if (args.size() < 2) {
-        std::cout << "Usage: fork <process_name>" << std::endl;
-        std::cout << "       Creates a new process with a main thread" << std::endl;
+        std::cout << "Usage: fork <process_name> [pages] | fork <pid>" << std::endl;
+        std::cout << "       Creates a new process with a main thread and "
+                  << DEFAULT_PROCESS_PAGES << " virtual pages (default)," << std::endl;
+        std::cout << "       or clones process <pid> copy-on-write" << std::endl;
+        return;
+    }
+
+    if (std::all_of(args[1].begin(), args[1].end(), ::isdigit)) {
+        int parent = std::stoi(args[1]);
+        int child = kernel->forkProcess(parent);
+        if (child < 0) {
+            std::cout << "[Shell] Process " << parent << " not found." << std::endl;
+        } else {
+            std::cout << "[Shell] Forked process " << parent << " -> PID " << child
+                      << " (copy-on-write)" << std::endl;
+        }
         return;
     }
     
     std::string name = args[1];
-    int pid = kernel->createProcess(name);
+    size_t pages = DEFAULT_PROCESS_PAGES;
+    if (args.size() >= 3) {
+        try {
+            pages = std::max(1, std::stoi(args[2]));
+        } catch (...) {
+            std::cout << "[Shell] Invalid page count. Using " << pages << "." << std::endl;
+        }
+    }
+    int pid = kernel->createProcess(name, pages);
     std::cout << "[Shell] Created process '" << name << "' (PID " << pid << ") with main thread" << std::endl;
 }
 
 void Shell::cmdThread(const std::vector<std::string>& args) {
     if (args.size() < 3) {
         std::cout << "Usage: thread <pid> <thread_name> [priority]" << std::endl;
-        std::cout << "       priority: 0 = HIGH, 1 = LOW (default)" << std::endl;
+        std::cout << "       priority: 0 = HIGH .. " << kernel->getPriorityLevels() - 1
+                  << " = lowest, 1 = LOW (default)" << std::endl;
         return;
     }
     
@@ -130,15 +206,7 @@ void Shell::cmdThread(const std::vector<std::string>& args) {
     int priority = 1; // Default LOW
     
     if (args.size() >= 4) {
-        try {
-            priority = std::stoi(args[3]);
-            if (priority != 0 && priority != 1) {
-                std::cout << "[Shell] Invalid priority. Using LOW (1)." << std::endl;
-                priority = 1;
-            }
-        } catch (...) {
-            std::cout << "[Shell] Invalid priority. Using LOW (1)." << std::endl;
-        }
+        priority = parsePriority(args[3]);
     }
     
     int tid = kernel->spawnThread(pid, name, priority);
@@ -146,7 +214,7 @@ void Shell::cmdThread(const std::vector<std::string>& args) {
         std::cout << "[Shell] Error: Process " << pid << " not found." << std::endl;
     } else {
         std::cout << "[Shell] Created thread '" << name << "' (TID " << tid 
-                  << ") in process " << pid << " [" << (priority == 0 ? "HIGH" : "LOW") << "]" << std::endl;
+                  << ") in process " << pid << " [" << priorityLabel(priority) << "]" << std::endl;
     }
 }
 
@@ -177,14 +245,447 @@ void Shell::cmdKill(const std::vector<std::string>& args) {
     }
 }
 
-void Shell::cmdMem() {
-    kernel->showMemory();
+void Shell::cmdKillProcess(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cout << "Usage: killp <process_id>" << std::endl;
+        return;
+    }
+
+    try {
+        int pid = std::stoi(args[1]);
+        if (kernel->killProcess(pid)) {
+            std::cout << "[Shell] Terminated process " << pid << " and freed its memory" << std::endl;
+        } else {
+            std::cout << "[Shell] Process " << pid << " not found." << std::endl;
+        }
+    } catch (...) {
+        std::cout << "[Shell] Invalid process ID." << std::endl;
+    }
+}
+
+void Shell::cmdSleep(const std::vector<std::string>& args) {
+    if (args.size() < 3) {
+        std::cout << "Usage: sleep <thread_id> <ticks>" << std::endl;
+        return;
+    }
+
+    try {
+        int id = std::stoi(args[1]);
+        int ticks = std::stoi(args[2]);
+        if (kernel->sleepThread(id, ticks)) {
+            std::cout << "[Shell] Thread " << id << " sleeping for " << ticks << " ticks" << std::endl;
+        } else {
+            std::cout << "[Shell] Thread " << id << " cannot sleep (not found, not runnable or bad ticks)." << std::endl;
+        }
+    } catch (...) {
+        std::cout << "[Shell] Invalid arguments." << std::endl;
+    }
+}
+
+void Shell::cmdNice(const std::vector<std::string>& args) {
+    if (args.size() < 3) {
+        std::cout << "Usage: nice <tid> <-20..19>" << std::endl;
+        return;
+    }
+    int tid = 0, nice = 0;
+    try {
+        tid = std::stoi(args[1]);
+        nice = std::stoi(args[2]);
+    } catch (...) {
+        std::cout << "[Shell] Invalid TID or nice value." << std::endl;
+        return;
+    }
+    if (nice < -20 || nice > 19) {
+        std::cout << "[Shell] Nice values run from -20 (most CPU) to 19." << std::endl;
+        return;
+    }
+    if (kernel->setNice(tid, nice)) {
+        std::cout << "[Shell] Thread " << tid << " nice " << nice << " (weight "
+                  << Scheduler::niceWeight(nice) << ")" << std::endl;
+    } else {
+        std::cout << "[Shell] Thread " << tid << " not found." << std::endl;
+    }
+}
+
+void Shell::cmdMem(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        kernel->showMemory();
+        return;
+    }
+    try {
+        int pid = std::stoi(args[1]);
+        if (!kernel->showPageTable(pid)) {
+            std::cout << "[Shell] Process " << pid << " not found." << std::endl;
+        }
+    } catch (...) {
+        std::cout << "[Shell] Invalid process ID." << std::endl;
+    }
+}
+
+void Shell::cmdTouch(const std::vector<std::string>& args) {
+    if (args.size() < 3) {
+        std::cout << "Usage: touch <pid> <address> [r|w [byte]]" << std::endl;
+        std::cout << "       Reads (default) or writes a virtual address, faulting the page in" << std::endl;
+        return;
+    }
+
+    try {
+        int pid = std::stoi(args[1]);
+        uint64_t address = std::stoull(args[2], nullptr, 0);
+        bool write = args.size() >= 4 && args[3] == "w";
+        FaultResult result = FaultResult::Mapped;
+        size_t frame = 0;
+        if (kernel->touchMemory(pid, address, write, result, frame)) {
+            char* byte = kernel->getMemoryManager().at(frame) + (address & (PAGE_SIZE - 1));
+            if (write && args.size() >= 5) {
+                *byte = static_cast<char>(std::stoi(args[4], nullptr, 0));
+            }
+            std::cout << "[Shell] " << (write ? "Wrote" : "Read") << " 0x" << std::hex << address
+                      << " in PID " << std::dec << pid << ": frame " << frame << ", value "
+                      << static_cast<int>(static_cast<unsigned char>(*byte))
+                      << (result == FaultResult::DemandZero ? " (page fault)" : "")
+                      << (result == FaultResult::SwapIn ? " (page fault, from swap)" : "")
+                      << (result == FaultResult::CopyOnWrite ? " (copy-on-write)" : "") << std::endl;
+        } else if (result == FaultResult::Segfault) {
+            std::cout << "[Shell] Segmentation fault at 0x" << std::hex << address << std::dec << std::endl;
+        } else if (result == FaultResult::OutOfMemory) {
+            std::cout << "[Shell] Out of memory." << std::endl;
+        } else {
+            std::cout << "[Shell] Process " << pid << " not found." << std::endl;
+        }
+    } catch (...) {
+        std::cout << "[Shell] Invalid arguments." << std::endl;
+    }
+}
+
+void Shell::cmdAio(const std::vector<std::string>& args) {
+    if (args.size() < 6 || (args[2] != "r" && args[2] != "w")) {
+        std::cout << "Usage: aio <tid> r|w <file> <address> <bytes> [offset]" << std::endl;
+        std::cout << "       Reads the file into the thread's memory, or writes memory to it (appending"
+                  << std::endl;
+        std::cout << "       unless an offset is given); the thread blocks until an I/O worker is done" << std::endl;
+        return;
+    }
+
+    try {
+        int tid = std::stoi(args[1]);
+        IoOp op = args[2] == "r" ? IoOp::Read : IoOp::Write;
+        uint64_t address = std::stoull(args[4], nullptr, 0);
+        size_t bytes = std::stoull(args[5], nullptr, 0);
+        int64_t offset = args.size() >= 7 ? std::stoll(args[6], nullptr, 0) : (op == IoOp::Read ? 0 : -1);
+        if (kernel->submitIo(tid, op, args[3], offset, address, bytes)) {
+            std::cout << "[Shell] Thread " << tid << " blocked on "
+                      << (op == IoOp::Read ? "a read of '" : "a write to '") << args[3] << "'" << std::endl;
+        } else {
+            std::cout << "[Shell] Thread " << tid
+                      << " cannot start I/O (not found, not runnable, ring full or bad address)." << std::endl;
+        }
+    } catch (...) {
+        std::cout << "[Shell] Invalid arguments." << std::endl;
+    }
+}
+
+void Shell::cmdLoad(const std::vector<std::string>& args) {
+    if (args.size() < 3) {
+        std::cout << "Usage: load <pid> <program file>" << std::endl;
+        std::cout << "       Restarts every thread of the process at the top of the program" << std::endl;
+        return;
+    }
+
+    int pid;
+    try {
+        pid = std::stoi(args[1]);
+    } catch (...) {
+        std::cout << "[Shell] Invalid process ID." << std::endl;
+        return;
+    }
+    std::shared_ptr<const Program> program = Program::load(args[2]);
+    if (!program) {
+        std::cout << "[Shell] Cannot load " << args[2] << std::endl;
+        return;
+    }
+    int loaded = kernel->loadProgram(pid, program);
+    if (loaded == -1) {
+        std::cout << "[Shell] Process " << pid << " not found." << std::endl;
+    } else if (loaded < 0) {
+        std::cout << "[Shell] " << args[2] << " (" << program->size() << " instructions) does not fit in PID "
+                  << pid << "'s address space." << std::endl;
+    } else {
+        std::cout << "[Shell] Loaded " << args[2] << " (" << program->size() << " instructions) into "
+                  << loaded << " thread(s) of PID " << pid << std::endl;
+    }
+}
+
+void Shell::cmdSwap(const std::vector<std::string>& args) {
+    Pager& pager = kernel->getPager();
+    const std::string sub = args.size() >= 2 ? args[1] : "";
+    if (sub.empty()) {
+        kernel->showSwap();
+    } else if (sub == "policy" && args.size() >= 3) {
+        PagerPolicy policy;
+        if (!parsePagerPolicy(args[2], policy)) {
+            std::cout << "[Shell] Unknown policy '" << args[2] << "' (fifo, clock, lru, arc)" << std::endl;
+            return;
+        }
+        kernel->setPagerPolicy(policy);
+        std::cout << "[Shell] Page replacement: " << pagerPolicyName(policy) << std::endl;
+    } else if (sub == "record" && args.size() >= 3 && args[2] == "start") {
+        pager.startRecording();
+        std::cout << "[Shell] Recording page references" << std::endl;
+    } else if (sub == "record" && args.size() >= 3 && args[2] == "stop") {
+        pager.stopRecording();
+        std::cout << "[Shell] Recorded " << pager.getTrace().size() << " references" << std::endl;
+    } else if (sub == "save" && args.size() >= 3) {
+        if (pager.saveTrace(args[2])) {
+            std::cout << "[Shell] Wrote " << pager.getTrace().size() << " references to " << args[2] << std::endl;
+        } else {
+            std::cout << "[Shell] Cannot write " << args[2] << std::endl;
+        }
+    } else if (sub == "replay" && args.size() >= 3) {
+        size_t frames;
+        try {
+            frames = std::max(1, std::stoi(args[2]));
+        } catch (...) {
+            std::cout << "[Shell] Invalid frame count." << std::endl;
+            return;
+        }
+        std::vector<PageRef> loaded;
+        if (args.size() >= 4 && !Pager::loadTrace(args[3], loaded)) {
+            std::cout << "[Shell] Cannot read " << args[3] << std::endl;
+            return;
+        }
+        kernel->compareReplacement(args.size() >= 4 ? loaded : pager.getTrace(), frames);
+    } else {
+        std::cout << "Usage: swap [policy fifo|clock|lru|arc | record start|stop | save <file>" << std::endl;
+        std::cout << "            | replay <frames> [file]]" << std::endl;
+    }
 }
 
 void Shell::cmdFiles() {
     kernel->showFiles();
 }
 
+void Shell::cmdWrite(const std::vector<std::string>& args) {
+    if (args.size() < 3) {
+        std::cout << "Usage: write <file> <text...>" << std::endl;
+        std::cout << "       Appends the text and a newline, creating the file if needed" << std::endl;
+        return;
+    }
+    std::string text;
+    for (size_t i = 2; i < args.size(); ++i) {
+        text += args[i] + (i + 1 < args.size() ? " " : "\n");
+    }
+    FileSystem& fs = kernel->getFileSystem();
+    int fd = fs.my_open(args[1]);
+    if (fd < 0) {
+        std::cout << "[Shell] Cannot open '" << args[1] << "'." << std::endl;
+        return;
+    }
+    int written = fs.my_seek(fd, 0, SEEK_END) < 0 ? -1 : fs.my_write(fd, text.data(), text.size());
+    fs.my_close(fd);
+    if (written < 0) {
+        std::cout << "[Shell] Write to '" << args[1] << "' failed." << std::endl;
+    } else {
+        std::cout << "[Shell] Wrote " << written << " bytes to '" << args[1] << "'" << std::endl;
+    }
+}
+
+void Shell::cmdCat(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cout << "Usage: cat <file>" << std::endl;
+        return;
+    }
+    FileSystem& fs = kernel->getFileSystem();
+    int fd = fs.exists(args[1]) ? fs.my_open(args[1]) : -1;
+    if (fd < 0) {
+        std::cout << "[Shell] Cannot open '" << args[1] << "'." << std::endl;
+        return;
+    }
+    char buffer[BLOCK_SIZE];
+    int n;
+    while ((n = fs.my_read(fd, buffer, sizeof(buffer))) > 0) {
+        std::cout.write(buffer, n);
+    }
+    fs.my_close(fd);
+}
+
+void Shell::cmdRm(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cout << "Usage: rm <file>" << std::endl;
+        return;
+    }
+    if (kernel->getFileSystem().my_unlink(args[1]) == 0) {
+        std::cout << "[Shell] Removed '" << args[1] << "'" << std::endl;
+    } else {
+        std::cout << "[Shell] Cannot remove '" << args[1] << "'." << std::endl;
+    }
+}
+
+void Shell::cmdTruncate(const std::vector<std::string>& args) {
+    if (args.size() < 3) {
+        std::cout << "Usage: truncate <file> <bytes>" << std::endl;
+        std::cout << "       Shrinks the file, freeing blocks past the new end" << std::endl;
+        return;
+    }
+    try {
+        size_t size = std::stoull(args[2]);
+        if (kernel->getFileSystem().my_truncate(args[1], size) == 0) {
+            std::cout << "[Shell] Truncated '" << args[1] << "' to " << size << " bytes" << std::endl;
+        } else {
+            std::cout << "[Shell] Cannot truncate '" << args[1] << "'." << std::endl;
+        }
+    } catch (...) {
+        std::cout << "[Shell] Invalid size." << std::endl;
+    }
+}
+
+void Shell::cmdMkdir(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cout << "Usage: mkdir <dir>" << std::endl;
+        return;
+    }
+    if (kernel->getFileSystem().my_mkdir(args[1]) == 0) {
+        std::cout << "[Shell] Created directory '" << args[1] << "'" << std::endl;
+    } else {
+        std::cout << "[Shell] Cannot create '" << args[1] << "'." << std::endl;
+    }
+}
+
+void Shell::cmdRmdir(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cout << "Usage: rmdir <dir>" << std::endl;
+        return;
+    }
+    if (kernel->getFileSystem().my_rmdir(args[1]) == 0) {
+        std::cout << "[Shell] Removed directory '" << args[1] << "'" << std::endl;
+    } else {
+        std::cout << "[Shell] Cannot remove '" << args[1] << "' (missing or not empty)." << std::endl;
+    }
+}
+
+void Shell::cmdLs(const std::vector<std::string>& args) {
+    std::string path = args.size() > 1 ? args[1] : "/";
+    std::vector<DirListing> entries;
+    if (kernel->getFileSystem().my_listdir(path, entries) < 0) {
+        std::cout << "[Shell] Cannot list '" << path << "'." << std::endl;
+        return;
+    }
+    for (const DirListing& e : entries) {
+        if (e.isDir) {
+            std::cout << "  " << e.name << "/" << std::endl;
+        } else {
+            std::cout << "  " << e.name << "  " << e.size << " bytes" << std::endl;
+        }
+    }
+    std::cout << "[Shell] " << entries.size() << " entries in '" << path << "'" << std::endl;
+}
+
+void Shell::cmdSync() {
+    int written = kernel->syncDisk();
+    if (written < 0) {
+        std::cout << "[Shell] Sync failed." << std::endl;
+    } else {
+        std::cout << "[Shell] Synced " << written << " dirty block(s) to disk." << std::endl;
+    }
+}
+
+void Shell::cmdFsck() {
+    if (kernel->checkDisk()) {
+        std::cout << "[Shell] File system is consistent." << std::endl;
+    } else {
+        std::cout << "[Shell] File system has errors." << std::endl;
+    }
+}
+
+void Shell::cmdCpus() {
+    kernel->showCpus();
+}
+
+void Shell::cmdSlabs() {
+    kernel->showSlabs();
+}
+
+void Shell::cmdLog(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cout << "[Shell] Log level: " << Logger::levelName(Logger::level) << std::endl;
+        std::cout << "Usage: log <off|error|warn|quiet|info|debug|trace>" << std::endl;
+        return;
+    }
+
+    int level = Logger::parseLevel(args[1]);
+    if (level < 0) {
+        std::cout << "[Shell] Unknown log level: " << args[1] << std::endl;
+        return;
+    }
+    if (level > MYOS_LOG_LEVEL) {
+        std::cout << "[Shell] Note: levels above '" << Logger::levelName(MYOS_LOG_LEVEL)
+                  << "' were compiled out." << std::endl;
+    }
+    Logger::level = level;
+    std::cout << "[Shell] Log level set to " << Logger::levelName(level) << std::endl;
+}
+
+void Shell::cmdTrace(const std::vector<std::string>& args) {
+    const std::string sub = args.size() >= 2 ? args[1] : "";
+    if (sub == "start") {
+        size_t records = 1 << 20;
+        if (args.size() >= 3) {
+            try {
+                records = std::max(1, std::stoi(args[2]));
+            } catch (...) {
+                std::cout << "[Shell] Invalid record count." << std::endl;
+                return;
+            }
+        }
+        Tracer::start(kernel->getCpuCount(), records, kernel->getIoWorkerCount());
+        std::cout << "[Shell] Tracing started (" << records << " records per CPU)" << std::endl;
+    } else if (sub == "stop") {
+        Tracer::stop();
+        std::cout << "[Shell] Tracing stopped: " << Tracer::recorded() << " events, "
+                  << Tracer::dropped() << " dropped" << std::endl;
+    } else if (sub == "dump" && args.size() >= 3) {
+        Tracer::stop();
+        if (Tracer::dump(args[2])) {
+            std::cout << "[Shell] Wrote " << Tracer::recorded() << " events to " << args[2]
+                      << " (open in ui.perfetto.dev or chrome://tracing)" << std::endl;
+        } else {
+            std::cout << "[Shell] Cannot write " << args[2] << std::endl;
+        }
+    } else {
+        std::cout << "Usage: trace start [records_per_cpu] | stop | dump <file>" << std::endl;
+    }
+}
+
+void Shell::cmdQuantum(const std::vector<std::string>& args) {
+    if (args.size() >= 2) {
+        int ticks = 0;
+        try {
+            ticks = std::stoi(args[1]);
+        } catch (...) {
+        }
+        if (ticks <= 0) {
+            std::cout << "[Shell] Invalid quantum (ticks > 0)." << std::endl;
+            return;
+        }
+        kernel->setQuantum(ticks);
+    }
+    std::cout << "[Shell] Quantum: " << kernel->getQuantum() << " ticks" << std::endl;
+}
+
+void Shell::cmdSched(const std::vector<std::string>& args) {
+    if (args.size() >= 2) {
+        SchedPolicy policy;
+        if (!Scheduler::parsePolicy(args[1], policy)) {
+            std::cout << "Usage: sched [priority|cfs]" << std::endl;
+            return;
+        }
+        kernel->setSchedPolicy(policy);
+        std::cout << "[Shell] Scheduling class: " << Scheduler::policyName(policy) << std::endl;
+        return;
+    }
+    kernel->showSched();
+}
+
 void Shell::cmdRun(const std::vector<std::string>& args) {
     int cycles = 10;
     if (args.size() >= 2) {
@@ -194,7 +695,11 @@ void Shell::cmdRun(const std::vector<std::string>& args) {
             cycles = 10;
         }
     }
-    std::cout << "[Shell] Running " << cycles << " CPU cycles..." << std::endl;
+    std::cout << "[Shell] Running " << cycles << " CPU cycles";
+    if (kernel->getCpuCount() > 1) {
+        std::cout << " on each of " << kernel->getCpuCount() << " CPUs";
+    }
+    std::cout << "..." << std::endl;
     kernel->runCycles(cycles);
 }
 
@@ -203,19 +708,43 @@ void Shell::cmdHelp() {
     std::cout << "│               MyOS Shell Commands                         │" << std::endl;
     std::cout << "├───────────────────────────────────────────────────────────┤" << std::endl;
     std::cout << "│  PROCESS/THREAD MANAGEMENT                                │" << std::endl;
-    std::cout << "│  fork <name>              Create a new process            │" << std::endl;
+    std::cout << "│  fork <name> [pages]      Create a new process            │" << std::endl;
+    std::cout << "│  fork <pid>               Clone a process (COW)           │" << std::endl;
     std::cout << "│  thread <pid> <name> [p]  Create thread in process        │" << std::endl;
     std::cout << "│  spawn <name> [priority]  Quick spawn (process+thread)    │" << std::endl;
     std::cout << "│  procs                    Show process tree               │" << std::endl;
     std::cout << "│  ps                       List all threads                │" << std::endl;
     std::cout << "│  kill <tid>               Terminate a thread              │" << std::endl;
+    std::cout << "│  killp <pid>              Terminate a process             │" << std::endl;
+    std::cout << "│  sleep <tid> <ticks>      Put a thread to sleep           │" << std::endl;
+    std::cout << "│  nice <tid> <n>           Weight for the fair class       │" << std::endl;
+    std::cout << "│  aio <tid> r|w <file> ..  Thread file I/O, async          │" << std::endl;
+    std::cout << "│  load <pid> <prog>        Run a program file's code       │" << std::endl;
     std::cout << "├───────────────────────────────────────────────────────────┤" << std::endl;
     std::cout << "│  SYSTEM                                                   │" << std::endl;
-    std::cout << "│  run [cycles]             Execute CPU cycles              │" << std::endl;
-    std::cout << "│  mem                      Show memory map                 │" << std::endl;
+    std::cout << "│  run [cycles]             Execute CPU cycles (per CPU)    │" << std::endl;
+    std::cout << "│  cpus                     Show per-CPU run queues         │" << std::endl;
+    std::cout << "│  quantum [ticks]          Show or set the time slice      │" << std::endl;
+    std::cout << "│  sched [priority|cfs]     Class, waits and fairness       │" << std::endl;
+    std::cout << "│  log [level]              Set log level (quiet = warn)    │" << std::endl;
+    std::cout << "│  trace <start|stop|dump>  Record a Perfetto trace         │" << std::endl;
+    std::cout << "│  slabs                    Show Thread/Process slab caches │" << std::endl;
+    std::cout << "│  mem [pid]                Memory map / page table         │" << std::endl;
+    std::cout << "│  touch <pid> <addr> [w]   Access virtual memory           │" << std::endl;
+    std::cout << "│  swap [policy|record|..]  Swap stats, policy replay       │" << std::endl;
     std::cout << "│  files                    Show inode table                │" << std::endl;
+    std::cout << "│  write <file> <text>      Append a line to a file         │" << std::endl;
+    std::cout << "│  cat <file>               Print a file                    │" << std::endl;
+    std::cout << "│  rm <file>                Delete a file                   │" << std::endl;
+    std::cout << "│  truncate <file> <bytes>  Shrink a file                   │" << std::endl;
+    std::cout << "│  mkdir <dir>              Create a directory              │" << std::endl;
+    std::cout << "│  rmdir <dir>              Remove an empty directory       │" << std::endl;
+    std::cout << "│  ls [dir]                 List a directory                │" << std::endl;
+    std::cout << "│  sync                     Flush dirty disk blocks         │" << std::endl;
+    std::cout << "│  fsck                     Check file system consistency   │" << std::endl;
     std::cout << "│  help                     Show this help                  │" << std::endl;
     std::cout << "│  exit                     Shutdown MyOS                   │" << std::endl;
     std::cout << "└───────────────────────────────────────────────────────────┘" << std::endl;
-    std::cout << "\n  Priority: 0 = HIGH, 1 = LOW (default)" << std::endl;
+    std::cout << "\n  Priority: 0 = HIGH .. " << kernel->getPriorityLevels() - 1
+              << " = lowest, 1 = LOW (default)" << std::endl;
 }
@@ -0,0 +1,157 @@
+#include "../include/SlabCache.hpp"
+#include <algorithm>
+#include <new>
+
+// One magazine per cache for the current host thread. When the thread
+// exits (a CPU's host thread after 'run'), its slots go back to the depots.
+struct MagazineSet {
+    SlabCache::Magazine magazines[SlabCache::MAX_CACHES];
+
+    ~MagazineSet() {
+        std::vector<SlabCache*>& caches = SlabCache::all();
+        for (size_t i = 0; i < caches.size() && i < SlabCache::MAX_CACHES; ++i) {
+            caches[i]->flush(magazines[i], 0);
+        }
+    }
+};
+
+namespace {
+thread_local MagazineSet localMagazines;
+}
+
+SlabCache::SlabCache(const char* name, size_t objectSize, size_t objectsPerSlab) :
+  name(name),
+  slotSize((std::max(objectSize, sizeof(void*)) + CACHE_LINE - 1) & ~(CACHE_LINE - 1)),
+  perSlab(std::max<size_t>(objectsPerSlab, MAGAZINE_SIZE)),
+  depot(nullptr),
+  depotCount(0),
+  allocs(0),
+  frees(0),
+  depotTrips(0) {
+    std::vector<SlabCache*>& caches = all();
+    index = caches.size() < MAX_CACHES ? static_cast<int>(caches.size()) : -1;
+    caches.push_back(this);
+}
+
+SlabCache::~SlabCache() {
+    for (void* slab : slabs) {
+        ::operator delete(slab, std::align_val_t(CACHE_LINE));
+    }
+}
+
+std::vector<SlabCache*>& SlabCache::all() {
+    static std::vector<SlabCache*> caches;
+    return caches;
+}
+
+SlabCache::Magazine& SlabCache::magazine() {
+    return localMagazines.magazines[index];
+}
+
+void* SlabCache::allocate() {
+    if (index < 0) {
+        return allocateFromDepot();
+    }
+    Magazine& mag = magazine();
+    if (mag.count == 0) {
+        refill(mag);
+    }
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return mag.slots[--mag.count];
+}
+
+void SlabCache::release(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    if (index < 0) {
+        releaseToDepot(ptr);
+        return;
+    }
+    Magazine& mag = magazine();
+    if (mag.count == MAGAZINE_SIZE) {
+        flush(mag, MAGAZINE_SIZE / 2);
+    }
+    mag.slots[mag.count++] = ptr;
+    frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Without a magazine: one slot at a time under the depot lock
+void* SlabCache::allocateFromDepot() {
+    std::lock_guard<std::mutex> guard(depotLock);
+    depotTrips.fetch_add(1, std::memory_order_relaxed);
+    if (depotCount == 0) {
+        grow();
+    }
+    void* slot = depot;
+    depot = *static_cast<void**>(slot);
+    depotCount--;
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+void SlabCache::releaseToDepot(void* ptr) {
+    std::lock_guard<std::mutex> guard(depotLock);
+    depotTrips.fetch_add(1, std::memory_order_relaxed);
+    *static_cast<void**>(ptr) = depot;
+    depot = ptr;
+    depotCount++;
+    frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Take half a magazine from the depot, growing by a slab if it is empty
+void SlabCache::refill(Magazine& mag) {
+    std::lock_guard<std::mutex> guard(depotLock);
+    depotTrips.fetch_add(1, std::memory_order_relaxed);
+    if (depotCount == 0) {
+        grow();
+    }
+    while (mag.count < MAGAZINE_SIZE / 2 && depot != nullptr) {
+        void* slot = depot;
+        depot = *static_cast<void**>(slot);
+        depotCount--;
+        mag.slots[mag.count++] = slot;
+    }
+}
+
+// Give all but 'keep' slots back to the depot
+void SlabCache::flush(Magazine& mag, size_t keep) {
+    if (mag.count <= keep) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(depotLock);
+    depotTrips.fetch_add(1, std::memory_order_relaxed);
+    while (mag.count > keep) {
+        void* slot = mag.slots[--mag.count];
+        *static_cast<void**>(slot) = depot;
+        depot = slot;
+        depotCount++;
+    }
+}
+
+// Called with depotLock held
+void SlabCache::grow() {
+    char* slab = static_cast<char*>(::operator new(slotSize * perSlab, std::align_val_t(CACHE_LINE)));
+    slabs.push_back(slab);
+    // Push in reverse so slots are handed out in address order
+    for (size_t i = perSlab; i-- > 0;) {
+        void* slot = slab + i * slotSize;
+        *static_cast<void**>(slot) = depot;
+        depot = slot;
+    }
+    depotCount += perSlab;
+}
+
+SlabStats SlabCache::stats() const {
+    std::lock_guard<std::mutex> guard(depotLock);
+    SlabStats s;
+    s.name = name;
+    s.objectSize = slotSize;
+    s.slabs = slabs.size();
+    s.capacity = slabs.size() * perSlab;
+    s.allocs = allocs.load(std::memory_order_relaxed);
+    s.inUse = s.allocs - frees.load(std::memory_order_relaxed);
+    s.depotFree = depotCount;
+    s.depotTrips = depotTrips.load(std::memory_order_relaxed);
+    return s;
+}
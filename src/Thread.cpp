@@ -1,4 +1,5 @@
 #include "../include/Thread.hpp"
+#include "../include/SlabCache.hpp"
 
 // Constructor
 Thread::Thread(int id, int parentPid, const std::string& name, int priority)
@@ -7,9 +8,51 @@ Thread::Thread(int id, int parentPid, const std::string& name, int priority)
     name(name), 
     state(ThreadState::READY), 
     programCounter(0),
-    priority(priority)
+    opTicks(0),
+    priority(priority),
+    basePriority(priority),
+    cpu(0),
+    wakeTick(0),
+    ioResult(0),
+    runTicks(0),
+    slices(0),
+    nice(0),
+    readySince(0),
+    waitTicks(0),
+    addressSpace(nullptr),
+    heldMutexes(nullptr),
+    waitingFor(nullptr),
+    spinTicks(0),
+    queue(nullptr),
+    queuePrev(nullptr),
+    queueNext(nullptr),
+    runTree(nullptr),
+    rbParent(nullptr),
+    rbLeft(nullptr),
+    rbRight(nullptr),
+    rbRed(false),
+    vruntime(0),
+    inboxNext(nullptr),
+    posted(0)
 {}
 
+SlabCache& Thread::cache() {
+  static SlabCache threads("thread", sizeof(Thread));
+  return threads;
+}
+
+void* Thread::operator new(size_t size) {
+  return size == sizeof(Thread) ? cache().allocate() : ::operator new(size);
+}
+
+void Thread::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(Thread)) {
+    cache().release(ptr);
+  } else {
+    ::operator delete(ptr);
+  }
+}
+
 // Getters 
 int Thread::getId() const {
   return id;
@@ -20,7 +63,7 @@ int Thread::getParentPid() const {
 }
 
 int Thread::getPriority() const {
-    return priority;
+    return priority.load(std::memory_order_relaxed);
 }
 
 std::string Thread::getName() const {
@@ -28,7 +71,7 @@ std::string Thread::getName() const {
 }
 
 ThreadState Thread::getState() const {
-  return state;
+  return state.load(std::memory_order_relaxed);
 }
 
 int Thread::getProgramCounter() const {
@@ -37,7 +80,7 @@ int Thread::getProgramCounter() const {
 
 // Setters 
 void Thread::setState(ThreadState s) {
-  state = s;
+  state.store(s, std::memory_order_relaxed);
 }
 
 void Thread::setProgramCounter(int pc) {
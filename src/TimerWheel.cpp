@@ -0,0 +1,99 @@
+#include "../include/TimerWheel.hpp"
+#include <algorithm>
+
+TimerWheel::TimerWheel() : overflow(this), nextTick(0), count(0) {
+    for (int level = 0; level < LEVELS; ++level) {
+        occupied[level] = 0;
+        for (int slot = 0; slot < SLOTS; ++slot) {
+            slots[level][slot].setOwner(this);
+        }
+    }
+}
+
+// File at the lowest level where the deadline shares every higher slot index with the clock
+void TimerWheel::file(Thread* thread) {
+    uint64_t wakeAt = thread->getWakeTick();
+    for (int level = 0; level < LEVELS; ++level) {
+        int shift = SLOT_BITS * (level + 1);
+        if ((wakeAt >> shift) == (nextTick >> shift)) {
+            int slot = (wakeAt >> (SLOT_BITS * level)) & (SLOTS - 1);
+            slots[level][slot].pushBack(thread);
+            occupied[level] |= uint64_t(1) << slot;
+            return;
+        }
+    }
+    overflow.pushBack(thread);
+}
+
+void TimerWheel::unfile(Thread* thread) {
+    ThreadQueue* queue = thread->getQueue();
+    queue->remove(thread);
+    if (queue == &overflow || !queue->empty()) {
+        return;
+    }
+    for (int level = 0; level < LEVELS; ++level) {
+        if (queue >= slots[level] && queue < slots[level] + SLOTS) {
+            occupied[level] &= ~(uint64_t(1) << (queue - slots[level]));
+            return;
+        }
+    }
+}
+
+// The clock just entered a new slot at 'level' (LEVELS = overflow): refile its threads lower down
+void TimerWheel::cascade(int level) {
+    ThreadQueue* source = &overflow;
+    if (level < LEVELS) {
+        int slot = (nextTick >> (SLOT_BITS * level)) & (SLOTS - 1);
+        source = &slots[level][slot];
+        occupied[level] &= ~(uint64_t(1) << slot);
+    }
+    // Detach the whole list first: overflow entries may be filed back into overflow
+    ThreadQueue pending;
+    while (Thread* t = source->popFront()) {
+        pending.pushBack(t);
+    }
+    while (Thread* t = pending.popFront()) {
+        file(t);
+    }
+}
+
+void TimerWheel::insert(Thread* thread, uint64_t wakeAt) {
+    thread->setWakeTick(wakeAt < nextTick ? nextTick : wakeAt);
+    file(thread);
+    count++;
+}
+
+bool TimerWheel::remove(Thread* thread) {
+    if (!contains(thread)) {
+        return false;
+    }
+    unfile(thread);
+    count--;
+    return true;
+}
+
+uint64_t TimerWheel::nextEvent() const {
+    uint64_t best = NEVER;
+
+    uint64_t due = occupied[0] >> (nextTick & (SLOTS - 1));
+    if (due != 0) {
+        best = nextTick + __builtin_ctzll(due);
+    }
+
+    for (int level = 1; level < LEVELS && best > nextTick; ++level) {
+        int shift = SLOT_BITS * level;
+        int current = (nextTick >> shift) & (SLOTS - 1);
+        uint64_t pending = occupied[level] >> current;
+        if (pending != 0) {
+            uint64_t blockStart = (nextTick >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+            uint64_t at = blockStart + (uint64_t(current + __builtin_ctzll(pending)) << shift);
+            best = std::min(best, std::max(at, nextTick));
+        }
+    }
+
+    if (!overflow.empty()) {
+        uint64_t span = uint64_t(1) << (SLOT_BITS * LEVELS);
+        best = std::min(best, (nextTick + span - 1) & ~(span - 1));
+    }
+    return best;
+}
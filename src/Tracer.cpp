@@ -0,0 +1,260 @@
+#include "../include/Tracer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <vector>
+
+bool Tracer::active = false;
+
+namespace {
+
+struct TraceBuffer {
+    std::vector<TraceRecord> records;
+    std::atomic<size_t> used{0};  // May run past records.size(); the excess was dropped
+};
+
+// buffers[0..n-1] belong to CPUs, the next ones to I/O workers, the last
+// one is shared by every other host thread
+std::vector<std::unique_ptr<TraceBuffer>> buffers;
+size_t cpuBuffers = 0;
+std::chrono::steady_clock::time_point epoch;
+uint64_t stoppedAt = 0;  // Closes slices still running at 'trace stop'
+thread_local int traceCpu = -1;
+thread_local int traceWorker = -1;
+
+const char* eventNames[] = {
+    "switch", "wake", "sleep", "mutex acquire", "mutex contend", "mutex release",
+    "alloc", "free", "open", "read", "write", "close", "page in", "page out",
+    "io submit", "io complete",
+};
+
+const char* eventCategory(TraceEvent type) {
+    switch (type) {
+        case TraceEvent::ContextSwitch:
+        case TraceEvent::Wake:
+        case TraceEvent::Sleep: return "sched";
+        case TraceEvent::MutexAcquire:
+        case TraceEvent::MutexContend:
+        case TraceEvent::MutexRelease: return "mutex";
+        case TraceEvent::Alloc:
+        case TraceEvent::Free:
+        case TraceEvent::PageIn:
+        case TraceEvent::PageOut: return "mem";
+        default: return "fs";
+    }
+}
+
+// Chrome trace lane for a buffer: one per CPU, the shared one, then one
+// per I/O worker
+int laneOf(size_t buffer) {
+    if (buffer < cpuBuffers) {
+        return static_cast<int>(buffer);
+    }
+    return buffer + 1 == buffers.size() ? 999 : 1000 + static_cast<int>(buffer - cpuBuffers);
+}
+
+size_t usedIn(const TraceBuffer& buf) {
+    return std::min(buf.used.load(std::memory_order_relaxed), buf.records.size());
+}
+
+}  // namespace
+
+void Tracer::start(int numCpus, size_t recordsPerCpu, int ioWorkers) {
+    active = false;
+    buffers.clear();
+    cpuBuffers = static_cast<size_t>(numCpus);
+    for (int i = 0; i <= numCpus + ioWorkers; ++i) {
+        buffers.emplace_back(new TraceBuffer());
+        buffers.back()->records.resize(recordsPerCpu);
+    }
+    epoch = std::chrono::steady_clock::now();
+    active = true;
+}
+
+void Tracer::stop() {
+    if (active) {
+        stoppedAt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - epoch).count();
+    }
+    active = false;
+}
+
+void Tracer::setCpu(int cpu) {
+    traceCpu = cpu;
+}
+
+void Tracer::setIoWorker(int worker) {
+    traceWorker = worker;
+}
+
+void Tracer::record(TraceEvent type, char phase, int tid, uint64_t arg0, uint64_t arg1) {
+    size_t index = buffers.size() - 1;
+    if (traceCpu >= 0 && static_cast<size_t>(traceCpu) < cpuBuffers) {
+        index = static_cast<size_t>(traceCpu);
+    } else if (traceWorker >= 0 && cpuBuffers + traceWorker + 1 < buffers.size()) {
+        index = cpuBuffers + traceWorker;
+    }
+    TraceBuffer& buf = *buffers[index];
+    size_t slot = buf.used.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= buf.records.size()) {
+        return;  // Full: counted as dropped
+    }
+    TraceRecord& rec = buf.records[slot];
+    rec.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - epoch).count();
+    rec.arg0 = arg0;
+    rec.arg1 = arg1;
+    rec.tid = tid;
+    rec.cpu = static_cast<int16_t>(index < cpuBuffers ? traceCpu : -1);
+    rec.type = static_cast<uint8_t>(type);
+    rec.phase = phase;
+}
+
+size_t Tracer::recorded() {
+    size_t total = 0;
+    for (const auto& buf : buffers) {
+        total += usedIn(*buf);
+    }
+    return total;
+}
+
+size_t Tracer::dropped() {
+    size_t total = 0;
+    for (const auto& buf : buffers) {
+        total += buf->used.load(std::memory_order_relaxed) - usedIn(*buf);
+    }
+    return total;
+}
+
+// Chrome trace event format: context switches become per-CPU "X" slices,
+// file operations "B"/"E" pairs on the track of whichever CPU, worker or
+// shell made them (each one's operations nest properly), mutex waits and
+// sleeps async spans keyed by thread id, everything else instant events.
+bool Tracer::dump(const std::string& path) {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (out == nullptr) {
+        return false;
+    }
+
+    std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    std::fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"MyOS\"}}");
+    for (size_t b = 0; b < buffers.size(); ++b) {
+        if (b + 1 == buffers.size()) {
+            std::fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                              "\"args\":{\"name\":\"Kernel (shell)\"}}", laneOf(b));
+        } else if (b >= cpuBuffers) {
+            std::fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                              "\"args\":{\"name\":\"I/O worker %zu\"}}", laneOf(b), b - cpuBuffers);
+        } else {
+            std::fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                              "\"args\":{\"name\":\"CPU %zu\"}}", laneOf(b), b);
+        }
+    }
+
+    // Merge the buffers by timestamp so spans that begin on one lane and end
+    // on another (sleep from the shell, wakeup on a CPU) pair up
+    struct Ref {
+        const TraceRecord* rec;
+        int lane;
+        size_t buffer;
+    };
+    std::vector<Ref> merged;
+    for (size_t b = 0; b < buffers.size(); ++b) {
+        for (size_t i = 0; i < usedIn(*buffers[b]); ++i) {
+            merged.push_back({&buffers[b]->records[i], laneOf(b), b});
+        }
+    }
+    std::stable_sort(merged.begin(), merged.end(), [](const Ref& a, const Ref& b) {
+        return a.rec->timestamp < b.rec->timestamp;
+    });
+
+    std::set<int> sleeping, waiting;
+    std::vector<int> runningTid(buffers.size(), 0);
+    std::vector<uint64_t> runningSince(buffers.size(), 0);
+    for (const Ref& ref : merged) {
+        const TraceRecord& rec = *ref.rec;
+        int lane = ref.lane;
+        TraceEvent type = static_cast<TraceEvent>(rec.type);
+        double ts = rec.timestamp / 1000.0;
+        const char* name = eventNames[rec.type];
+        const char* cat = eventCategory(type);
+
+        switch (type) {
+            case TraceEvent::ContextSwitch:
+                if (runningTid[ref.buffer] != 0) {
+                    std::fprintf(out, ",\n{\"name\":\"Thread %d\",\"cat\":\"sched\",\"ph\":\"X\","
+                                      "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                                      "\"args\":{\"tid\":%d}}",
+                                 runningTid[ref.buffer], lane, runningSince[ref.buffer] / 1000.0,
+                                 (rec.timestamp - runningSince[ref.buffer]) / 1000.0,
+                                 runningTid[ref.buffer]);
+                }
+                runningTid[ref.buffer] = rec.tid;
+                runningSince[ref.buffer] = rec.timestamp;
+                break;
+            case TraceEvent::Sleep:
+                sleeping.insert(rec.tid);
+                std::fprintf(out, ",\n{\"name\":\"sleep\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%d,"
+                                  "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"ticks\":%llu}}",
+                             cat, rec.tid, lane, ts, (unsigned long long)rec.arg0);
+                break;
+            case TraceEvent::Wake:
+                if (sleeping.erase(rec.tid)) {
+                    std::fprintf(out, ",\n{\"name\":\"sleep\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%d,"
+                                      "\"pid\":1,\"tid\":%d,\"ts\":%.3f}", cat, rec.tid, lane, ts);
+                }
+                std::fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                                  "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"tid\":%d}}",
+                             name, cat, lane, ts, rec.tid);
+                break;
+            case TraceEvent::MutexContend:
+                waiting.insert(rec.tid);
+                std::fprintf(out, ",\n{\"name\":\"mutex wait\",\"cat\":\"%s\",\"ph\":\"b\",\"id\":%d,"
+                                  "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"owner\":%llu}}",
+                             cat, rec.tid, lane, ts, (unsigned long long)rec.arg0);
+                break;
+            case TraceEvent::MutexAcquire:
+                if (waiting.erase(rec.tid)) {
+                    std::fprintf(out, ",\n{\"name\":\"mutex wait\",\"cat\":\"%s\",\"ph\":\"e\",\"id\":%d,"
+                                      "\"pid\":1,\"tid\":%d,\"ts\":%.3f}", cat, rec.tid, lane, ts);
+                }
+                std::fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                                  "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"tid\":%d}}",
+                             name, cat, lane, ts, rec.tid);
+                break;
+            case TraceEvent::FileOpen:
+            case TraceEvent::FileRead:
+            case TraceEvent::FileWrite:
+            case TraceEvent::FileClose:
+                std::fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,"
+                                  "\"tid\":%d,\"ts\":%.3f,\"args\":{\"fd\":%lld,\"bytes\":%llu}}",
+                             name, cat, rec.phase, lane, ts, (long long)rec.arg0,
+                             (unsigned long long)rec.arg1);
+                break;
+            default:
+                std::fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                                  "\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+                                  "\"args\":{\"tid\":%d,\"arg0\":%llu,\"arg1\":%llu}}",
+                             name, cat, lane, ts, rec.tid, (unsigned long long)rec.arg0,
+                             (unsigned long long)rec.arg1);
+                break;
+        }
+    }
+
+    // Close the slices still running when tracing stopped
+    for (size_t b = 0; b < buffers.size(); ++b) {
+        if (runningTid[b] != 0) {
+            uint64_t end = std::max(stoppedAt, runningSince[b]);
+            std::fprintf(out, ",\n{\"name\":\"Thread %d\",\"cat\":\"sched\",\"ph\":\"X\",\"pid\":1,"
+                              "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"tid\":%d}}",
+                         runningTid[b], laneOf(b), runningSince[b] / 1000.0,
+                         (end - runningSince[b]) / 1000.0, runningTid[b]);
+        }
+    }
+
+    std::fprintf(out, "\n]}\n");
+    return std::fclose(out) == 0;
+}
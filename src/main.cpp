@@ -1,11 +1,113 @@
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
 #include "../include/Kernel.hpp"
+#include "../include/Logger.hpp"
 #include "../include/Shell.hpp"
 
-int main() {
-    Kernel kernel;
-    kernel.boot();
+// "4096", "64K", "512M", "4G"
+static bool parseSize(const char* text, size_t& bytes) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (end == text) {
+        return false;
+    }
+    switch (*end) {
+        case 'G': case 'g': value <<= 10;  // fall through
+        case 'M': case 'm': value <<= 10;  // fall through
+        case 'K': case 'k': value <<= 10; ++end; break;
+        default: break;
+    }
+    if (*end != '\0' || value == 0) {
+        return false;
+    }
+    bytes = static_cast<size_t>(value);
+    return true;
+}
+
+// A whole number in [min, max]
+static bool parseInt(const char* text, long min, long max, int& value) {
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int inodes = 0;
+    KernelConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--levels") == 0 && i + 1 < argc &&
+            parseInt(argv[i + 1], 1, MAX_PRIORITY_LEVELS, config.priorityLevels)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--quantum") == 0 && i + 1 < argc &&
+                   parseInt(argv[i + 1], 1, INT_MAX, config.quantum)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--sched") == 0 && i + 1 < argc &&
+                   Scheduler::parsePolicy(argv[i + 1], config.schedPolicy)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--cpus") == 0 && i + 1 < argc &&
+                   parseInt(argv[i + 1], 1, MAX_CPUS, config.numCpus)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--alloc") == 0 && i + 1 < argc &&
+                   MemoryManager::parsePolicy(argv[i + 1], config.allocPolicy)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--mem") == 0 && i + 1 < argc &&
+                   parseSize(argv[i + 1], config.memoryBytes)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--swap") == 0 && i + 1 < argc &&
+                   parseSize(argv[i + 1], config.swapBytes)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--disk") == 0 && i + 1 < argc &&
+                   parseSize(argv[i + 1], config.diskBytes)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--inodes") == 0 && i + 1 < argc &&
+                   parseInt(argv[i + 1], 1, INT_MAX, inodes)) {
+            config.inodeCount = static_cast<size_t>(inodes);
+            ++i;
+        } else if (std::strcmp(argv[i], "--io-workers") == 0 && i + 1 < argc &&
+                   parseInt(argv[i + 1], 1, IoWorkerPool::MAX_WORKERS, config.ioWorkers)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--io-latency") == 0 && i + 1 < argc &&
+                   parseInt(argv[i + 1], 0, INT_MAX, config.ioLatencyMicros)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--format") == 0) {
+            config.formatDisk = true;
+        } else if (std::strcmp(argv[i], "--pager") == 0 && i + 1 < argc &&
+                   parsePagerPolicy(argv[i + 1], config.pagerPolicy)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--log") == 0 && i + 1 < argc &&
+                   Logger::parseLevel(argv[i + 1]) >= 0) {
+            Logger::level = Logger::parseLevel(argv[++i]);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--levels N] [--quantum TICKS] [--sched priority|cfs] [--cpus N]"
+                      << " [--mem SIZE] [--alloc first|seg|buddy]"
+                      << " [--swap SIZE] [--pager fifo|clock|lru|arc]"
+                      << " [--disk SIZE] [--inodes N] [--format] [--io-workers N] [--io-latency US]"
+                      << " [--log LEVEL]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<Kernel> kernel;
+    try {
+        kernel.reset(new Kernel(config));
+    } catch (const std::bad_alloc&) {
+        std::cout << "Cannot reserve " << config.memoryBytes << " bytes of simulated RAM." << std::endl;
+        return 1;
+    }
+    kernel->boot();
     
-    Shell shell(&kernel);
+    Shell shell(kernel.get());
     shell.run();
     
     return 0;
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdio>
+
+// Minimal assertions for the regression tests: a failed CHECK prints where
+// and carries on, and the test's main returns checkFailures() != 0.
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+            checkFailures()++;                                                   \
+        }                                                                        \
+    } while (0)
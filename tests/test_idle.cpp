@@ -0,0 +1,59 @@
+// Idle fast-forward with several CPUs: while one thread sleeps and every CPU
+// is idle, a run must still cover every requested cycle on every CPU, all
+// of them idle. Each CPU used to wait for the others to stop counting as
+// busy, which none of them did. The wall-clock cost is in bench_idle.
+#include <cstdlib>
+#include <unistd.h>
+#include "Check.hpp"
+#include "../include/Kernel.hpp"
+#include "../include/Logger.hpp"
+
+static void runSleeper(int numCpus) {
+    KernelConfig config;
+    config.numCpus = numCpus;
+    config.formatDisk = true;
+    config.ioWorkers = 1;
+    Kernel kernel(config);
+    int pid = kernel.createProcess("sleeper");
+    int tid = kernel.spawnThread(pid, "a", 1);
+    CHECK(kernel.sleepThread(tid, 1000000));
+    kernel.runCycles(1000);  // The main thread runs to its exit
+
+    // Entirely inside the sleep: nothing runs
+    const uint64_t cycles = 500000;
+    uint64_t idleBefore = kernel.getIdleTicks();
+    uint64_t executed = kernel.getInstructions();
+    kernel.runCycles(cycles);
+    uint64_t idle = kernel.getIdleTicks() - idleBefore;
+    std::printf("  %d CPU(s): %llu idle ticks of %llu\n", numCpus, (unsigned long long)idle,
+                (unsigned long long)(numCpus * cycles));
+    CHECK(idle == numCpus * cycles);
+    CHECK(kernel.getInstructions() == executed);
+
+    // Across the deadline: the sleeper wakes and runs, the rest stays idle
+    idleBefore = kernel.getIdleTicks();
+    kernel.runCycles(cycles);
+    idle = kernel.getIdleTicks() - idleBefore;
+    CHECK(kernel.getInstructions() > executed);
+    CHECK(idle > numCpus * cycles - 1000 && idle < numCpus * cycles);
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+    // The kernel keeps its disk image in the working directory
+    char dir[] = "/tmp/myos_test_idle.XXXXXX";
+    if (mkdtemp(dir) == nullptr || chdir(dir) != 0) {
+        std::printf("  cannot create %s\n", dir);
+        return 1;
+    }
+
+    const int cpuCounts[] = {1, 2, 4};
+    for (int numCpus : cpuCounts) {
+        runSleeper(numCpus);
+    }
+
+    unlink("disk.bin");
+    rmdir(dir);
+    std::printf("test_idle: %s\n", checkFailures() ? "FAILED" : "OK");
+    return checkFailures() != 0;
+}
@@ -0,0 +1,85 @@
+// Log lines longer than one ring record: they used to be cut at 254 bytes
+// without a sign. They now span several records and come out whole, also
+// while the background drain interleaves several CPUs' rings; only a line
+// longer than a quarter of the ring is cut, and then says so.
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "../include/Logger.hpp"
+
+static std::string lineOf(char c, size_t length) {
+    return std::string(length, c);
+}
+
+static std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+int main() {
+    std::ostringstream captured;
+    std::streambuf* stdoutBuf = std::cout.rdbuf(captured.rdbuf());
+    Logger::level = static_cast<int>(LogLevel::Info);
+    Logger::configure(4);
+
+    // Synchronous: exactly one record, just over it, and many records
+    const size_t lengths[] = {0, 253, 254, 255, 508, 1000, 60000};
+    for (size_t length : lengths) {
+        LOG_INFO(lineOf('x', length));
+    }
+    std::vector<std::string> lines = splitLines(captured.str());
+    CHECK(lines.size() == sizeof(lengths) / sizeof(lengths[0]));
+    for (size_t i = 0; i < lines.size() && i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+        CHECK(lines[i] == lineOf('x', lengths[i]));
+    }
+
+    // Too long for the ring: cut, and marked
+    captured.str("");
+    LOG_INFO(lineOf('y', 1000000));
+    lines = splitLines(captured.str());
+    CHECK(lines.size() == 1);
+    if (lines.size() == 1) {
+        CHECK(lines[0].size() < 1000000);
+        CHECK(lines[0].compare(0, 1000, lineOf('y', 1000)) == 0);
+        CHECK(lines[0].size() > 12 && lines[0].substr(lines[0].size() - 12) == " [truncated]");
+    }
+
+    // Asynchronous: four CPUs' host threads logging long lines concurrently
+    captured.str("");
+    const int perThread = 2000;
+    Logger::startAsync();
+    std::vector<std::thread> cpus;
+    for (int cpu = 0; cpu < 4; ++cpu) {
+        cpus.emplace_back([cpu] {
+            Logger::setCpu(cpu);
+            for (int n = 0; n < perThread; ++n) {
+                LOG_INFO(lineOf(static_cast<char>('a' + cpu), 200 + (n * 37) % 900));
+            }
+        });
+    }
+    for (auto& t : cpus) {
+        t.join();
+    }
+    Logger::stopAsync();
+    lines = splitLines(captured.str());
+    CHECK(lines.size() == 4 * perThread);
+    int broken = 0;
+    for (const std::string& line : lines) {
+        if (line.empty() || line.find_first_not_of(line[0]) != std::string::npos) {
+            broken++;
+        }
+    }
+    CHECK(broken == 0);
+
+    std::cout.rdbuf(stdoutBuf);
+    std::printf("test_logger: %s\n", checkFailures() ? "FAILED" : "OK");
+    return checkFailures() != 0;
+}
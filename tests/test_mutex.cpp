@@ -0,0 +1,56 @@
+// Killing a thread that waits on a mutex: it leaves the wait queue under the
+// mutex's lock, and the owners it had boosted, down the whole chain, drop
+// back to what their remaining waiters are owed. They used to keep the dead
+// waiter's priority until they released.
+#include "Check.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Mutex.hpp"
+
+// Queue 'thread' and let it take the CPU from whoever is running
+static void run(Scheduler& scheduler, Thread& thread) {
+    if (thread.getState() != ThreadState::RUNNING) {
+        scheduler.addThread(&thread);
+    }
+    scheduler.schedule();
+    CHECK(scheduler.getCurrentThread() == &thread);
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+    Scheduler scheduler(3);
+    Mutex outer(true, false);
+    Mutex inner(true, false);
+    Thread low(1, 1, "low", 2);
+    Thread mid(2, 1, "mid", 1);
+    Thread high(3, 1, "high", 0);
+
+    // low holds outer; mid holds inner and waits for outer; high waits for inner
+    run(scheduler, low);
+    CHECK(outer.lock(scheduler) == LockResult::Acquired);
+    run(scheduler, mid);
+    CHECK(inner.lock(scheduler) == LockResult::Acquired);
+    CHECK(outer.lock(scheduler) == LockResult::Blocked);
+    CHECK(low.getPriority() == 1);
+    run(scheduler, high);
+    CHECK(inner.lock(scheduler) == LockResult::Blocked);
+    CHECK(mid.getPriority() == 0);
+    CHECK(low.getPriority() == 0);
+
+    CHECK(Mutex::cancelWait(&high, scheduler));
+    CHECK(high.getQueue() == nullptr);
+    CHECK(mid.getPriority() == 1);
+    CHECK(low.getPriority() == 1);
+    CHECK(!Mutex::cancelWait(&high, scheduler));
+
+    // mid too: low is back at its base priority, and outer hands over to no one
+    CHECK(Mutex::cancelWait(&mid, scheduler));
+    CHECK(low.getPriority() == 2);
+    scheduler.schedule();
+    CHECK(scheduler.getCurrentThread() == &low);
+    outer.unlock(scheduler);
+    CHECK(outer.getOwner() == nullptr);
+    CHECK(inner.getOwner() == &mid);
+
+    std::printf("test_mutex: %s\n", checkFailures() ? "FAILED" : "OK");
+    return checkFailures() != 0;
+}
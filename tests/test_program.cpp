@@ -0,0 +1,107 @@
+// Program size against the code region: the default address space holds
+// DEFAULT_PROCESS_PAGES * PAGE_SIZE / INSTRUCTION_SIZE instructions. One that
+// fills it exactly runs to its exit; a longer one used to be accepted and
+// fault on fetching the first instruction past the last page.
+//
+// Reloading a process restarts its threads, the one on the CPU included:
+// one that has just exited but is still current must not end up both on
+// the CPU and in a ready queue.
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+#include "Check.hpp"
+#include "../include/Kernel.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Program.hpp"
+
+static std::shared_ptr<const Program> computeProgram(size_t length) {
+    std::ostringstream text;
+    for (size_t i = 0; i + 1 < length; ++i) {
+        text << "compute 1\n";
+    }
+    text << "exit\n";
+    std::istringstream in(text.str());
+    return Program::parse("test", in);
+}
+
+// Instructions executed; a length of 0 leaves the main thread's own code
+static long long runProgram(size_t length, int& loaded) {
+    KernelConfig config;
+    config.numCpus = 1;
+    config.formatDisk = true;
+    config.ioWorkers = 1;
+    Kernel kernel(config);
+    int pid = kernel.createProcess("code");
+    if (length > 0) {
+        std::shared_ptr<const Program> program = computeProgram(length);
+        CHECK(program && program->size() == length);
+        loaded = kernel.loadProgram(pid, program);
+    }
+    kernel.runCycles(10 * DEFAULT_PROCESS_PAGES * PAGE_SIZE);
+    return static_cast<long long>(kernel.getInstructions());
+}
+
+// Reload mid-run and right after the exit, with the thread still current
+static void reloadRunning() {
+    KernelConfig config;
+    config.numCpus = 1;
+    config.formatDisk = true;
+    config.ioWorkers = 1;
+    Kernel kernel(config);
+    int pid = kernel.createProcess("code");
+    std::shared_ptr<const Program> program = computeProgram(3);
+
+    CHECK(kernel.loadProgram(pid, computeProgram(200)) == 1);
+    kernel.runCycles(10);
+    CHECK(kernel.loadProgram(pid, program) == 1);
+    kernel.runCycles(3);  // Exits on the last cycle
+    uint64_t executed = kernel.getInstructions();
+    CHECK(executed == 13);
+
+    CHECK(kernel.loadProgram(pid, program) == 1);
+    kernel.runCycles(100);
+    CHECK(kernel.getInstructions() == executed + 3);
+
+    // Exited on the last cycle again: a killed thread must not run on
+    kernel.loadProgram(pid, program);
+    kernel.runCycles(3);
+    executed = kernel.getInstructions();
+    CHECK(kernel.loadProgram(pid, program) == 1);
+    CHECK(kernel.killProcess(pid));
+    kernel.runCycles(100);
+    std::printf("  reloaded while running: %llu instructions\n", (unsigned long long)kernel.getInstructions());
+    CHECK(kernel.getInstructions() == executed);
+}
+
+int main() {
+    Logger::level = static_cast<int>(LogLevel::Off);
+    char dir[] = "/tmp/myos_test_program.XXXXXX";
+    if (mkdtemp(dir) == nullptr || chdir(dir) != 0) {
+        std::printf("  cannot create %s\n", dir);
+        return 1;
+    }
+
+    const size_t fits = DEFAULT_PROCESS_PAGES * PAGE_SIZE / INSTRUCTION_SIZE;
+    int loaded = 0;
+    const long long unloaded = runProgram(0, loaded);
+    long long executed = runProgram(fits, loaded);
+    std::printf("  %zu instructions: loaded %d, executed %lld\n", fits, loaded, executed);
+    CHECK(loaded == 1);
+    CHECK(executed == static_cast<long long>(fits));
+
+    const size_t oversized[] = {fits + 1, 301};
+    for (size_t length : oversized) {
+        executed = runProgram(length, loaded);
+        std::printf("  %zu instructions: loaded %d, executed %lld\n", length, loaded, executed);
+        // Rejected: the main thread keeps running its own code
+        CHECK(loaded == -2);
+        CHECK(executed == unloaded);
+    }
+
+    reloadRunning();
+
+    unlink("disk.bin");
+    rmdir(dir);
+    std::printf("test_program: %s\n", checkFailures() ? "FAILED" : "OK");
+    return checkFailures() != 0;
+}
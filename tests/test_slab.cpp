@@ -0,0 +1,131 @@
+// Slab caches from several host threads at once, as the simulated CPUs use
+// them: each thread allocates through its own magazines, checks that no
+// object it holds is handed to anyone else, and releases half of its
+// objects itself and passes the rest to another thread to release. More
+// caches are created than there are magazine slots per thread; the ones
+// past SlabCache::MAX_CACHES go straight to their depot.
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "../include/SlabCache.hpp"
+
+const int CACHES = SlabCache::MAX_CACHES + 4;
+const int THREADS = 4;
+const int ITERATIONS = 200000;
+const int LIVE = 64;  // Objects each thread holds at a time
+
+struct Object {
+    int cache;
+    int owner;
+    uint64_t serial;
+    char payload[40];
+};
+
+struct Handoff {
+    std::mutex lock;
+    std::vector<Object*> objects;
+};
+
+static std::vector<SlabCache*> caches;
+static Handoff handoffs[THREADS];
+
+static bool intact(const Object* o, int cache, int owner, uint64_t serial) {
+    if (o->cache != cache || o->owner != owner || o->serial != serial) {
+        return false;
+    }
+    for (char c : o->payload) {
+        if (c != static_cast<char>(serial)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void worker(int id, int& corrupted) {
+    std::mt19937 rng(id + 1);
+    std::vector<Object*> live;
+    uint64_t serial = 0;
+    for (int n = 0; n < ITERATIONS; ++n) {
+        if (live.size() < LIVE && (live.empty() || rng() % 2 == 0)) {
+            int cache = static_cast<int>(rng() % CACHES);
+            Object* o = static_cast<Object*>(caches[cache]->allocate());
+            o->cache = cache;
+            o->owner = id;
+            o->serial = ++serial;
+            std::memset(o->payload, static_cast<char>(o->serial), sizeof(o->payload));
+            live.push_back(o);
+            continue;
+        }
+        size_t pick = rng() % live.size();
+        Object* o = live[pick];
+        live[pick] = live.back();
+        live.pop_back();
+        if (!intact(o, o->cache, id, o->serial)) {
+            corrupted++;
+        }
+        if (rng() % 2 == 0) {
+            caches[o->cache]->release(o);
+        } else {
+            Handoff& next = handoffs[(id + 1) % THREADS];
+            std::lock_guard<std::mutex> guard(next.lock);
+            next.objects.push_back(o);
+        }
+
+        // Release what the previous thread handed over
+        std::vector<Object*> handed;
+        {
+            std::lock_guard<std::mutex> guard(handoffs[id].lock);
+            handed.swap(handoffs[id].objects);
+        }
+        for (Object* h : handed) {
+            caches[h->cache]->release(h);
+        }
+    }
+    for (Object* o : live) {
+        caches[o->cache]->release(o);
+    }
+}
+
+int main() {
+    // Never destroyed: every host thread's magazines flush into them at exit
+    for (int i = 0; i < CACHES; ++i) {
+        caches.push_back(new SlabCache("test", sizeof(Object)));
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<int> corrupted(THREADS, 0);
+    for (int id = 0; id < THREADS; ++id) {
+        threads.emplace_back(worker, id, std::ref(corrupted[id]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (Handoff& h : handoffs) {
+        for (Object* o : h.objects) {
+            caches[o->cache]->release(o);
+        }
+        h.objects.clear();
+    }
+
+    for (int id = 0; id < THREADS; ++id) {
+        CHECK(corrupted[id] == 0);
+    }
+    // Every object came back. The main thread's magazines got what it
+    // released; everything else is back in the depots, the exited threads'
+    // magazines included.
+    for (int i = 0; i < CACHES; ++i) {
+        SlabStats s = caches[i]->stats();
+        CHECK(s.allocs > 0);
+        CHECK(s.inUse == 0);
+        CHECK(s.depotFree + SlabCache::MAGAZINE_SIZE >= s.capacity);
+        if (i >= SlabCache::MAX_CACHES) {
+            CHECK(s.depotFree == s.capacity);
+        }
+    }
+
+    std::printf("test_slab: %s\n", checkFailures() ? "FAILED" : "OK");
+    return checkFailures() != 0;
+}
@@ -0,0 +1,183 @@
+// Crash consistency of the journaled file system. Each iteration a child
+// process mounts the image and runs random appends (plain and vectored),
+// in-place rewrites, truncates, unlinks, mkdirs, rmdirs and syncs until it
+// is killed: at a random moment, or (more telling) in place of
+// a random block write, often midway through a sync or commit. The parent
+// then mounts the image, which replays the journal, and requires the
+// consistency check to pass and every file to hold exactly the bytes it was
+// written with.
+//
+// Usage: crash_test [iterations] [seed]
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../include/FileSystem.hpp"
+#include "../include/Logger.hpp"
+
+static const char* diskPath = "/tmp/myos_crash_test.bin";
+static const size_t diskBytes = 512 * 1024;
+static const size_t inodes = 32;
+static const int fileCount = 24;
+static const int dirCount = 2;  // A dozen names each: their buckets split
+static const size_t maxFileBytes = 16 * 1024;
+
+// Byte 'pos' of file 'n' is always the same, whatever path wrote it
+static char pattern(int n, size_t pos) {
+    return static_cast<char>('a' + (pos * 7 + n) % 26);
+}
+
+static std::string dirName(int n) {
+    return "d" + std::to_string(n % dirCount);
+}
+
+static std::string fileName(int n) {
+    return dirName(n) + "/f" + std::to_string(n);
+}
+
+// Size of a file, reading it through; -1 if any byte is wrong
+static long verify(FileSystem& fs, int n) {
+    int fd = fs.my_open(fileName(n));
+    if (fd < 0) {
+        return -1;
+    }
+    char buffer[4096];
+    size_t pos = 0;
+    int got;
+    while ((got = fs.my_read(fd, buffer, sizeof(buffer))) > 0) {
+        for (int i = 0; i < got; ++i, ++pos) {
+            if (buffer[i] != pattern(n, pos)) {
+                std::printf("  %s: byte %zu is '%c', expected '%c'\n", fileName(n).c_str(), pos, buffer[i],
+                            pattern(n, pos));
+                fs.my_close(fd);
+                return -1;
+            }
+        }
+    }
+    fs.my_close(fd);
+    return got < 0 ? -1 : static_cast<long>(pos);
+}
+
+[[noreturn]] static void runWorkload(unsigned seed, uint64_t crashAfterWrites) {
+    FileSystem fs(diskPath, diskBytes, inodes);
+    BufferCache::crashAfterWrites = crashAfterWrites;
+    std::mt19937 rng(seed);
+    size_t sizes[fileCount];
+    for (int n = 0; n < fileCount; ++n) {
+        long size = fs.exists(fileName(n)) ? verify(fs, n) : 0;
+        sizes[n] = size > 0 ? static_cast<size_t>(size) : 0;
+    }
+    char data[3000];
+    for (;;) {
+        int n = static_cast<int>(rng() % fileCount);
+        unsigned op = rng() % 100;
+        if (op < 55) {
+            size_t len = 1 + rng() % sizeof(data);
+            if (sizes[n] + len > maxFileBytes) {
+                continue;
+            }
+            for (size_t i = 0; i < len; ++i) {
+                data[i] = pattern(n, sizes[n] + i);
+            }
+            if (!fs.exists(dirName(n))) {
+                fs.my_mkdir(dirName(n));
+            }
+            int fd = fs.my_open(fileName(n));
+            if (fd >= 0 && fs.my_seek(fd, 0, SEEK_END) == static_cast<int64_t>(sizes[n])) {
+                // Every other append in three pieces
+                size_t third = len / 3;
+                IoVec iov[3] = {{data, third}, {data + third, third}, {data + 2 * third, len - 2 * third}};
+                int written = op % 2 ? fs.my_writev(fd, iov, 3) : fs.my_write(fd, data, len);
+                if (written == static_cast<int>(len)) {
+                    sizes[n] += len;
+                }
+            }
+            fs.my_close(fd);
+        } else if (op < 65) {
+            // Same bytes in place: only a torn metadata update could show
+            if (sizes[n] > 0) {
+                size_t pos = rng() % sizes[n];
+                size_t len = std::min<size_t>(1 + rng() % sizeof(data), sizes[n] - pos);
+                for (size_t i = 0; i < len; ++i) {
+                    data[i] = pattern(n, pos + i);
+                }
+                int fd = fs.my_open(fileName(n));
+                fs.my_pwrite(fd, data, len, pos);
+                fs.my_close(fd);
+            }
+        } else if (op < 80) {
+            if (fs.exists(fileName(n))) {
+                size_t size = sizes[n] > 0 ? rng() % sizes[n] : 0;
+                if (fs.my_truncate(fileName(n), size) == 0) {
+                    sizes[n] = size;
+                }
+            }
+        } else if (op < 92) {
+            if (fs.exists(fileName(n)) && fs.my_unlink(fileName(n)) == 0) {
+                sizes[n] = 0;
+            }
+        } else if (op < 95) {
+            fs.my_rmdir(dirName(n));  // Fails unless empty
+        } else {
+            fs.sync();
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Logger::level = static_cast<int>(LogLevel::Off);
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : static_cast<unsigned>(time(nullptr));
+    std::mt19937 rng(seed);
+    std::remove(diskPath);
+    {
+        FileSystem fs(diskPath, diskBytes, inodes, true);
+    }
+    std::printf("crash-test: %d iterations, seed %u\n", iterations, seed);
+
+    int failures = 0, replays = 0;
+    for (int i = 0; i < iterations; ++i) {
+        unsigned workloadSeed = rng();
+        uint64_t crashAfterWrites = i % 2 == 0 ? 1 + rng() % 2000 : 0;
+        pid_t child = fork();
+        if (child < 0) {
+            std::perror("fork");
+            return 1;
+        }
+        if (child == 0) {
+            runWorkload(workloadSeed, crashAfterWrites);
+        }
+        usleep(1000 + rng() % 200000);
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+
+        FileSystem fs(diskPath, diskBytes, inodes);
+        std::vector<std::string> problems;
+        bool ok = fs.check(problems);
+        for (int n = 0; n < fileCount; ++n) {
+            if (fs.exists(fileName(n)) && verify(fs, n) < 0) {
+                ok = false;
+            }
+        }
+        if (fs.getJournalStats().replayed > 0) {
+            replays++;
+        }
+        if (!ok) {
+            failures++;
+            std::printf("iteration %d: inconsistent after replay\n", i);
+            for (const std::string& problem : problems) {
+                std::printf("  %s\n", problem.c_str());
+            }
+        }
+    }
+
+    std::printf("crash-test: %d/%d recoveries consistent, %d replayed the journal\n", iterations - failures,
+                iterations, replays);
+    std::remove(diskPath);
+    return failures == 0 ? 0 : 1;
+}